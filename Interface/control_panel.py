@@ -195,8 +195,10 @@ class ControlPanel(QtWidgets.QMainWindow):
         base_url = f"ws://{stream_cfg.host}:{stream_cfg.port}"
         self.audio_endpoint_label = QtWidgets.QLabel(f"{base_url}{stream_cfg.audio_endpoint}")
         self.emotion_endpoint_label = QtWidgets.QLabel(f"{base_url}{stream_cfg.emotion_endpoint}")
+        self.control_endpoint_label = QtWidgets.QLabel(f"{base_url}{stream_cfg.control_endpoint}")
         info_layout.addRow("Audio Stream:", self.audio_endpoint_label)
         info_layout.addRow("Emotion Stream:", self.emotion_endpoint_label)
+        info_layout.addRow("Control Stream:", self.control_endpoint_label)
         layout.addWidget(info_box)
 
         self.setCentralWidget(central)
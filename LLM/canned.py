@@ -0,0 +1,98 @@
+"""Fixed replies standing in for the LLM in deterministic runs."""
+from __future__ import annotations
+
+import json
+import logging
+import zlib
+from pathlib import Path
+from typing import Dict, List, Optional, Union
+
+logger = logging.getLogger(__name__)
+
+Reply = Dict[str, str]
+
+
+class CannedLLMEngine:
+    """Drop-in for :class:`LLM.engine.LLMEngine` that answers from a JSON file.
+
+    The file holds either a list of replies or an object keyed by user
+    message; a reply is ``{"emotion": ..., "text": ...}`` or just a string
+    (spoken as Neutral). Keyed files may add a ``"*"`` entry for unknown
+    messages. A message without a keyed reply picks one from the list (or
+    the ``"*"`` entry) by a stable hash of its text, so answers never depend
+    on turn order or on which session asked.
+    """
+
+    def __init__(self, path: Union[str, Path]):
+        self.path = Path(path)
+        self._by_message: Dict[str, Reply] = {}
+        self._fallback: List[Reply] = []
+        self._loaded = False
+
+    def load(self) -> None:
+        data = json.loads(self.path.read_text(encoding="utf-8"))
+        if isinstance(data, list):
+            self._fallback = [self._reply(entry) for entry in data]
+        elif isinstance(data, dict):
+            wildcard = data.get("*")
+            self._by_message = {key.strip(): self._reply(value) for key, value in data.items() if key != "*"}
+            if isinstance(wildcard, list):
+                self._fallback = [self._reply(entry) for entry in wildcard]
+            elif wildcard is not None:
+                self._fallback = [self._reply(wildcard)]
+        else:
+            raise ValueError(f"{self.path}: canned replies must be a JSON list or object")
+        self._loaded = True
+        logger.info(
+            "Loaded %s canned replies (%s fallback) from %s",
+            len(self._by_message),
+            len(self._fallback),
+            self.path,
+        )
+
+    @staticmethod
+    def _reply(entry: object) -> Reply:
+        if isinstance(entry, str):
+            return {"emotion": "Neutral", "text": entry}
+        if isinstance(entry, dict) and isinstance(entry.get("text"), str):
+            return {"emotion": str(entry.get("emotion") or "Neutral"), "text": entry["text"]}
+        raise ValueError(f"Invalid canned reply: {entry!r}")
+
+    @property
+    def is_ready(self) -> bool:
+        return self._loaded
+
+    @property
+    def is_speculative(self) -> bool:
+        return False
+
+    def count_tokens(self, text: str) -> int:
+        return len(text) // 4 + 1
+
+    def generate(
+        self,
+        user_message: str,
+        chat_history: Optional[List[Dict[str, str]]] = None,
+        summary: Optional[str] = None,
+    ) -> Reply:
+        if not self.is_ready:
+            raise RuntimeError("CannedLLMEngine.generate called before load().")
+        key = user_message.strip()
+        reply = self._by_message.get(key)
+        if reply is None and self._fallback:
+            reply = self._fallback[zlib.crc32(key.encode("utf-8")) % len(self._fallback)]
+        if reply is None:
+            reply = {"emotion": "Neutral", "text": user_message}
+        return dict(reply)
+
+    def summarize(
+        self,
+        previous_summary: str,
+        turns: List[Dict[str, str]],
+        *,
+        max_new_tokens: int = 160,
+    ) -> str:
+        """Concatenates the turns, truncated like a model summary would be."""
+        lines = [previous_summary] if previous_summary else []
+        lines.extend(f"User: {turn['user']} Assistant: {turn['assistant']}" for turn in turns)
+        return " ".join(lines)[: max_new_tokens * 4]
@@ -0,0 +1,180 @@
+"""Grammar-constrained decoding for the ``{"emotion": ..., "text": ...}`` reply.
+
+:class:`EmotionReplyGrammar` is a character-level automaton for exactly::
+
+    {"emotion": "<one of the emotions>", "text": "<string>"}
+
+It precomputes which vocabulary tokens are legal in each automaton state.
+:class:`EmotionReplyLogitsProcessor` then masks every other token during
+``model.generate``, so the model can neither emit a preamble nor produce
+JSON that fails to parse. The text string may not contain backslashes
+or control characters, which keeps the grammar free of escape handling.
+Token strings come from decoding each id on its own, which assumes a
+byte-level BPE tokenizer such as Qwen's.
+"""
+from __future__ import annotations
+
+from typing import Dict, Iterable, List, Optional, Sequence, Tuple
+
+import torch
+from transformers import LogitsProcessor
+
+HEAD = "head"
+TEXT = "text"
+CLOSE = "close"
+DONE = "done"
+
+# (phase, characters of the head consumed so far)
+GrammarState = Tuple[str, str]
+INITIAL_STATE: GrammarState = (HEAD, "")
+
+
+class EmotionReplyGrammar:
+    """Token-level view of the emotion/text JSON reply grammar."""
+
+    def __init__(
+        self,
+        emotions: Sequence[str],
+        token_texts: Sequence[str],
+        eos_token_ids: Iterable[int],
+        excluded_token_ids: Iterable[int] = (),
+    ) -> None:
+        if not emotions:
+            raise ValueError("EmotionReplyGrammar requires at least one emotion")
+        self.emotions = tuple(emotions)
+        self.heads = tuple(f'{{"emotion": "{emotion}", "text": "' for emotion in self.emotions)
+        self._head_set = frozenset(self.heads)
+        self._head_prefixes = frozenset(head[:index] for head in self.heads for index in range(len(head) + 1))
+        self._eos_ids = sorted(set(eos_token_ids))
+
+        excluded = set(excluded_token_ids) | set(self._eos_ids)
+        self._token_texts = list(token_texts)
+        self._by_first_char: Dict[str, List[int]] = {}
+        text_ids: List[int] = []
+        close_ids: List[int] = []
+        for token_id, token_text in enumerate(self._token_texts):
+            if token_id in excluded or not token_text:
+                continue
+            self._by_first_char.setdefault(token_text[0], []).append(token_id)
+            if self.advance((TEXT, ""), token_text) is not None:
+                text_ids.append(token_id)
+            if self.advance((CLOSE, ""), token_text) is not None:
+                close_ids.append(token_id)
+        self._allowed_cache: Dict[GrammarState, List[int]] = {
+            (TEXT, ""): text_ids,
+            (CLOSE, ""): close_ids,
+            (DONE, ""): list(self._eos_ids),
+        }
+
+    def advance(self, state: GrammarState, text: str) -> Optional[GrammarState]:
+        """Feeds ``text`` to the automaton; returns ``None`` if it is illegal."""
+        phase, prefix = state
+        for char in text:
+            if phase == HEAD:
+                prefix += char
+                if prefix in self._head_set:
+                    phase, prefix = TEXT, ""
+                elif prefix not in self._head_prefixes:
+                    return None
+            elif phase == TEXT:
+                if char == '"':
+                    phase = CLOSE
+                elif char == "\\" or char < " ":
+                    return None
+            elif phase == CLOSE:
+                if char == "}":
+                    phase = DONE
+                elif not char.isspace():
+                    return None
+            else:
+                return None
+        return phase, prefix
+
+    def advance_tokens(self, state: GrammarState, token_ids: Iterable[int]) -> Optional[GrammarState]:
+        for token_id in token_ids:
+            if token_id in self._eos_ids:
+                return state if state[0] == DONE else None
+            if token_id >= len(self._token_texts):
+                return None
+            next_state = self.advance(state, self._token_texts[token_id])
+            if next_state is None:
+                return None
+            state = next_state
+        return state
+
+    def allowed_token_ids(self, state: GrammarState) -> List[int]:
+        cached = self._allowed_cache.get(state)
+        if cached is not None:
+            return cached
+        phase, prefix = state
+        allowed: List[int] = []
+        if phase == HEAD:
+            next_chars = {head[len(prefix)] for head in self.heads if head.startswith(prefix)}
+            for char in sorted(next_chars):
+                for token_id in self._by_first_char.get(char, ()):
+                    if self.advance(state, self._token_texts[token_id]) is not None:
+                        allowed.append(token_id)
+        self._allowed_cache[state] = allowed
+        return allowed
+
+    @classmethod
+    def from_tokenizer(cls, tokenizer, emotions: Sequence[str], eos_token_ids: Iterable[int]) -> "EmotionReplyGrammar":
+        token_texts = [
+            tokenizer.decode([token_id], skip_special_tokens=False, clean_up_tokenization_spaces=False)
+            for token_id in range(len(tokenizer))
+        ]
+        excluded = set(getattr(tokenizer, "all_special_ids", ()))
+        excluded.update(getattr(tokenizer, "added_tokens_decoder", {}).keys())
+        return cls(emotions, token_texts, eos_token_ids, excluded)
+
+
+class EmotionReplyLogitsProcessor(LogitsProcessor):
+    """Masks logits so generation follows :class:`EmotionReplyGrammar`."""
+
+    def __init__(
+        self,
+        grammar: EmotionReplyGrammar,
+        prompt_length: int,
+        mask_cache: Optional[Dict[Tuple[GrammarState, int, str], torch.Tensor]] = None,
+    ) -> None:
+        self.grammar = grammar
+        self.prompt_length = prompt_length
+        self._mask_cache = mask_cache if mask_cache is not None else {}
+        self._consumed: List[int] = []
+        self._states: List[GrammarState] = [INITIAL_STATE]
+
+    def _state_for(self, generated: List[int]) -> Optional[GrammarState]:
+        # Assisted generation can roll tokens back, so resync on the common prefix.
+        common = 0
+        limit = min(len(generated), len(self._consumed))
+        while common < limit and generated[common] == self._consumed[common]:
+            common += 1
+        del self._consumed[common:]
+        del self._states[common + 1:]
+        for token_id in generated[common:]:
+            state = self.grammar.advance_tokens(self._states[-1], (token_id,))
+            if state is None:
+                return None
+            self._consumed.append(token_id)
+            self._states.append(state)
+        return self._states[-1]
+
+    def _mask(self, state: GrammarState, scores: torch.Tensor) -> torch.Tensor:
+        key = (state, scores.shape[-1], str(scores.device))
+        mask = self._mask_cache.get(key)
+        if mask is None:
+            allowed = [token_id for token_id in self.grammar.allowed_token_ids(state) if token_id < scores.shape[-1]]
+            mask = torch.full((scores.shape[-1],), float("-inf"), device=scores.device)
+            if allowed:
+                mask[torch.tensor(allowed, device=scores.device)] = 0.0
+            self._mask_cache[key] = mask
+        return mask
+
+    def __call__(self, input_ids: torch.LongTensor, scores: torch.FloatTensor) -> torch.FloatTensor:
+        for row in range(input_ids.shape[0]):
+            state = self._state_for(input_ids[row, self.prompt_length:].tolist())
+            if state is None:
+                # Only reachable if tokens bypassed this processor; leave them be.
+                continue
+            scores[row] = scores[row] + self._mask(state, scores[row]).to(scores.dtype)
+        return scores
@@ -5,12 +5,16 @@ import json
 import logging
 from dataclasses import dataclass
 from pathlib import Path
-from typing import Dict, List, Optional
+from typing import Dict, List, Optional, Sequence
 
 from threading import Thread
 
 import torch
-from transformers import AutoModelForCausalLM, AutoTokenizer, TextIteratorStreamer
+from transformers import AutoModelForCausalLM, AutoTokenizer, LogitsProcessorList, TextIteratorStreamer
+
+from Utils.model_loading import quantize_dynamic_int8, safetensors_kwargs
+
+from .constrained import EmotionReplyGrammar, EmotionReplyLogitsProcessor
 
 logger = logging.getLogger(__name__)
 
@@ -26,12 +30,18 @@ class LLMConfig:
     temperature: float = 0.6
     top_p: float = 0.9
     repetition_penalty: float = 1.05
+    # ``False`` decodes greedily (temperature and top_p are then ignored).
+    do_sample: bool = True
     system_prompt: str = (
         "You are Nova, an empathetic companion living inside Unreal Engine. "
         "Always respond with a compact JSON object shaped as {\"emotion\": <emotion>, \"text\": <reply>}. "
         "Supported emotions: Neutral, Happy, Sad, Angry, Disgust, Fear, Surprise."
     )
     quantization: Optional[str] = None
+    draft_model_name_or_path: Optional[str] = None
+    num_assistant_tokens: int = 5
+    # Mask tokens that would break the {"emotion", "text"} reply grammar.
+    constrained_json: bool = True
 
 
 class LLMEngine:
@@ -40,14 +50,27 @@ class LLMEngine:
     The class is designed to work with models such as Qwen3 4B Instruct
     and its quantised derivatives. Only open-source, locally hosted models are
     supported; no remote endpoints are contacted.
+
+    When ``draft_model_name_or_path`` is set, a small draft model proposes
+    ``num_assistant_tokens`` tokens per step and the main model verifies them
+    in a single forward pass (speculative / assisted decoding). The draft must
+    share the main model's tokenizer, e.g. Qwen3-0.6B for Qwen3-4B.
+
+    When ``emotions`` is given and ``constrained_json`` is enabled, replies are
+    decoded under :class:`EmotionReplyGrammar`. This guarantees a parseable
+    reply whose emotion is one of ``emotions``.
     """
 
-    def __init__(self, config: LLMConfig):
+    def __init__(self, config: LLMConfig, emotions: Optional[Sequence[str]] = None):
         self.config = config
+        self.emotions = list(emotions) if emotions else None
         self._model = None
+        self._draft_model = None
         self._tokenizer = None
         self._streamer: Optional[TextIteratorStreamer] = None
         self._is_qwen3 = False
+        self._grammar: Optional[EmotionReplyGrammar] = None
+        self._grammar_masks: Dict = {}
 
     def load(self) -> None:
         """Loads the tokenizer and model into memory."""
@@ -63,41 +86,90 @@ class LLMEngine:
         if self._is_qwen3:
             logger.info("Detected Qwen3 tokenizer; using chat template prompting.")
 
-        model_kwargs: Dict[str, object] = {}
-        if self.config.quantization and self.config.quantization.lower() in {"awq", "int4"}:
-            model_kwargs.update({"torch_dtype": torch.float16})
-
         logger.info("Loading causal LM from %s", self.config.model_name_or_path)
-        self._model = AutoModelForCausalLM.from_pretrained(
-            self.config.model_name_or_path,
-            device_map="auto",
+        self._model = self._load_causal_lm(self.config.model_name_or_path)
+        logger.info("Model loaded to device map: %s", getattr(self._model, "hf_device_map", self.config.device))
+
+        if self.config.draft_model_name_or_path:
+            logger.info("Loading draft model from %s", self.config.draft_model_name_or_path)
+            self._draft_model = self._load_causal_lm(self.config.draft_model_name_or_path)
+            self._draft_model.generation_config.num_assistant_tokens = self.config.num_assistant_tokens
+            logger.info(
+                "Speculative decoding enabled with %s draft tokens per step",
+                self.config.num_assistant_tokens,
+            )
+
+        if self.config.constrained_json and self.emotions:
+            self._grammar = EmotionReplyGrammar.from_tokenizer(
+                self._tokenizer, self.emotions, self._eos_token_ids()
+            )
+            logger.info("Constrained JSON decoding enabled for emotions: %s", ", ".join(self.emotions))
+
+    def _eos_token_ids(self) -> List[int]:
+        eos = self._model.generation_config.eos_token_id
+        if eos is None:
+            eos = self._tokenizer.eos_token_id
+        if eos is None:
+            return []
+        return [eos] if isinstance(eos, int) else list(eos)
+
+    def _load_causal_lm(self, model_name_or_path: str):
+        """Loads one checkpoint for ``config.device`` and ``config.quantization``.
+
+        On ``device="cpu"`` weights stay in float32 (bfloat16 matmuls are slow
+        on most CPUs) and ``quantization="int8"`` swaps every ``nn.Linear`` for
+        a dynamically quantised int8 kernel, roughly halving decode latency.
+        """
+        quantization = (self.config.quantization or "").lower()
+        device = self.config.device or "auto"
+        on_cpu = device == "cpu"
+        # "cuda"/"auto" let accelerate spread layers over every GPU; any other device pins the whole model.
+        device_map: object = "auto" if device in {"auto", "cuda"} else {"": device}
+        model_kwargs: Dict[str, object] = {"device_map": device_map}
+        if on_cpu:
+            model_kwargs["torch_dtype"] = torch.float32
+            if quantization in {"awq", "int4"}:
+                logger.warning("%s quantisation needs a GPU; use \"int8\" on CPU", quantization.upper())
+        elif quantization in {"awq", "int4"}:
+            model_kwargs["torch_dtype"] = torch.float16
+        elif quantization == "int8":
+            logger.warning("int8 dynamic quantisation only applies to device \"cpu\"; ignoring")
+
+        model = AutoModelForCausalLM.from_pretrained(
+            model_name_or_path,
             low_cpu_mem_usage=True,
             trust_remote_code=True,
             **model_kwargs,
+            **safetensors_kwargs(model_name_or_path),
         )
-        self._model.eval()
-
-        logger.info("Model loaded to device map: %s", self._model.hf_device_map)
+        model.eval()
+        if on_cpu and quantization == "int8":
+            model = quantize_dynamic_int8(model)
+        return model
 
     @property
     def is_ready(self) -> bool:
         return self._model is not None and self._tokenizer is not None
 
-    def _build_prompt(self, user_message: str, chat_history: Optional[List[Dict[str, str]]] = None) -> str:
-        segments: List[str] = [f"<|system|>\n{self.config.system_prompt}"]
-        if chat_history:
-            for turn in chat_history:
-                segments.append(f"<|user|>\n{turn['user']}")
-                segments.append(f"<|assistant|>\n{turn['assistant']}")
-        segments.append(f"<|user|>\n{user_message}\n<|assistant|>")
-        return "\n".join(segments)
+    @property
+    def is_speculative(self) -> bool:
+        return self._draft_model is not None
+
+    def _system_prompt(self, summary: Optional[str] = None) -> str:
+        if not summary:
+            return self.config.system_prompt
+        return f"{self.config.system_prompt}\n\nSummary of the conversation so far: {summary}"
 
     def _build_chat_messages(
-        self, user_message: str, chat_history: Optional[List[Dict[str, str]]] = None
+        self,
+        user_message: str,
+        chat_history: Optional[List[Dict[str, str]]] = None,
+        summary: Optional[str] = None,
     ) -> List[Dict[str, str]]:
         messages: List[Dict[str, str]] = []
-        if self.config.system_prompt:
-            messages.append({"role": "system", "content": self.config.system_prompt})
+        system_prompt = self._system_prompt(summary)
+        if system_prompt:
+            messages.append({"role": "system", "content": system_prompt})
         if chat_history:
             for turn in chat_history:
                 messages.append({"role": "user", "content": turn["user"]})
@@ -105,32 +177,47 @@ class LLMEngine:
         messages.append({"role": "user", "content": user_message})
         return messages
 
-    def generate(self, user_message: str, chat_history: Optional[List[Dict[str, str]]] = None) -> Dict[str, str]:
-        if not self.is_ready:
-            raise RuntimeError("LLMEngine.generate called before load().")
-
+    def _encode(self, messages: List[Dict[str, str]]):
+        """Renders chat messages into model inputs (chat template for Qwen3)."""
         if self._is_qwen3:
-            messages = self._build_chat_messages(user_message, chat_history)
             prompt_text = self._tokenizer.apply_chat_template(
                 messages,
                 add_generation_prompt=True,
                 tokenize=False,
             )
-            inputs = self._tokenizer(prompt_text, return_tensors="pt").to(self._model.device)
         else:
-            prompt_text = self._build_prompt(user_message, chat_history)
-            inputs = self._tokenizer(prompt_text, return_tensors="pt").to(self._model.device)
+            segments = [f"<|{message['role']}|>\n{message['content']}" for message in messages]
+            prompt_text = "\n".join(segments) + "\n<|assistant|>"
+        return self._tokenizer(prompt_text, return_tensors="pt").to(self._model.device)
+
+    def count_tokens(self, text: str) -> int:
+        """Token count of ``text``; a rough estimate until the tokenizer loads."""
+        if self._tokenizer is None:
+            return len(text) // 4 + 1
+        return len(self._tokenizer.encode(text, add_special_tokens=False))
+
+    def generate(
+        self,
+        user_message: str,
+        chat_history: Optional[List[Dict[str, str]]] = None,
+        summary: Optional[str] = None,
+    ) -> Dict[str, str]:
+        if not self.is_ready:
+            raise RuntimeError("LLMEngine.generate called before load().")
+
+        messages = self._build_chat_messages(user_message, chat_history, summary)
+        inputs = self._encode(messages)
 
         streamer = TextIteratorStreamer(self._tokenizer, skip_prompt=True, skip_special_tokens=True)
-        generation_kwargs = dict(
-            **inputs,
-            streamer=streamer,
-            max_new_tokens=self.config.max_new_tokens,
-            temperature=self.config.temperature,
-            top_p=self.config.top_p,
-            repetition_penalty=self.config.repetition_penalty,
-            do_sample=True,
-        )
+        generation_kwargs = self._generation_kwargs(inputs, streamer=streamer)
+        if self._grammar is not None:
+            generation_kwargs["logits_processor"] = LogitsProcessorList(
+                [
+                    EmotionReplyLogitsProcessor(
+                        self._grammar, inputs["input_ids"].shape[-1], self._grammar_masks
+                    )
+                ]
+            )
 
         logger.debug("Starting LLM generation")
         collected_text = ""
@@ -149,6 +236,55 @@ class LLMEngine:
         logger.debug("LLM generation completed: %s", collected_text)
         return self._parse_json_output(collected_text)
 
+    def summarize(
+        self,
+        previous_summary: str,
+        turns: List[Dict[str, str]],
+        *,
+        max_new_tokens: int = 160,
+    ) -> str:
+        """Folds ``turns`` into ``previous_summary`` and returns the new summary."""
+        if not self.is_ready:
+            raise RuntimeError("LLMEngine.summarize called before load().")
+
+        transcript = "\n".join(f"User: {turn['user']}\nAssistant: {turn['assistant']}" for turn in turns)
+        request = (
+            f"Current summary:\n{previous_summary or '(none)'}\n\n"
+            f"New conversation turns:\n{transcript}\n\n"
+            "Rewrite the summary so it also covers the new turns. Keep names, facts, "
+            "promises and the user's preferences. Reply with the summary text only."
+        )
+        messages = [
+            {"role": "system", "content": "You maintain a concise running summary of a conversation."},
+            {"role": "user", "content": request},
+        ]
+        inputs = self._encode(messages)
+        generation_kwargs = self._generation_kwargs(inputs)
+        generation_kwargs.update(max_new_tokens=max_new_tokens, do_sample=False, temperature=None, top_p=None)
+
+        with torch.no_grad():
+            output = self._model.generate(**generation_kwargs)
+        new_tokens = output[0][inputs["input_ids"].shape[-1]:]
+        return self._tokenizer.decode(new_tokens, skip_special_tokens=True).strip()
+
+    def _generation_kwargs(self, inputs, *, streamer=None) -> Dict[str, object]:
+        """Builds the keyword arguments passed to ``model.generate``."""
+        generation_kwargs: Dict[str, object] = dict(
+            **inputs,
+            max_new_tokens=self.config.max_new_tokens,
+            temperature=self.config.temperature,
+            top_p=self.config.top_p,
+            repetition_penalty=self.config.repetition_penalty,
+            do_sample=True,
+        )
+        if not self.config.do_sample:
+            generation_kwargs.update(do_sample=False, temperature=None, top_p=None)
+        if streamer is not None:
+            generation_kwargs["streamer"] = streamer
+        if self._draft_model is not None:
+            generation_kwargs["assistant_model"] = self._draft_model
+        return generation_kwargs
+
     def _parse_json_output(self, raw_text: str) -> Dict[str, str]:
         """Attempts to coerce the model output into the expected JSON schema."""
         raw_text = raw_text.strip()
@@ -163,13 +299,24 @@ class LLMEngine:
         try:
             payload = json.loads(candidate)
         except json.JSONDecodeError:
-            logger.exception("Failed to parse JSON from model output: %s", candidate)
-            payload = {"emotion": "Neutral", "text": raw_text}
+            payload = self._parse_truncated_json(raw_text[json_start:])
+            if payload is None:
+                logger.exception("Failed to parse JSON from model output: %s", candidate)
+                payload = {"emotion": "Neutral", "text": raw_text}
 
         emotion = payload.get("emotion", "Neutral")
         text = payload.get("text", raw_text)
         return {"emotion": emotion, "text": text}
 
+    @staticmethod
+    def _parse_truncated_json(raw_json: str) -> Optional[Dict[str, str]]:
+        """Recovers a reply cut off by ``max_new_tokens`` inside the text string."""
+        try:
+            payload = json.loads(raw_json + '"}')
+        except json.JSONDecodeError:
+            return None
+        return payload if isinstance(payload, dict) else None
+
 
 def load_config(path: Path) -> LLMConfig:
     """Loads a configuration JSON file into :class:`LLMConfig`."""
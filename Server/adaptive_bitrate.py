@@ -0,0 +1,251 @@
+"""Per-client adaptive bitrate for the framed audio stream.
+
+Clients opt in with ``abr=1`` and the ``client_id`` of their control
+connection on the audio websocket::
+
+    /ws/audio?agent_id=guard&framing=nv1&abr=1&client_id=npc-host-1
+
+They then report link quality on the control channel every second or so::
+
+    {"type": "feedback", "receive_kbps": 310.5, "buffered_ms": 80,
+     "underruns": 2, "lost_frames": 0, "rtt_ms": 42}
+
+``underruns`` and ``lost_frames`` are running totals. ``rtt_ms`` comes from
+``ping``/``pong`` round trips on the same channel. One
+:class:`CongestionController` per client walks a ladder of
+:class:`BitrateRung`:
+
+* loss, underruns, queueing delay (RTT above its floor) or a starved
+  receive rate step down one rung immediately, at most once per
+  ``down_interval_s``;
+* after ``probe_interval_s`` without congestion it probes one rung up; a
+  probe that fails right away doubles the wait before the next one.
+
+All audio sockets of a client share one controller, since they share the
+link. Lower rungs trade sample rate and codec (PCM16, then 8-bit mu-law)
+for bandwidth and use longer frames to cut per-packet overhead.
+"""
+from __future__ import annotations
+
+import logging
+from dataclasses import dataclass
+from typing import Any, List, Mapping, Optional, Sequence, Union
+
+import numpy as np
+
+from .packetizer import CODEC_MULAW, CODEC_PCM16
+
+logger = logging.getLogger(__name__)
+
+
+@dataclass(frozen=True)
+class BitrateRung:
+    """One operating point: codec, sample rate and frame duration."""
+
+    name: str
+    codec: int
+    sample_rate: int
+    frame_ms: int
+
+    @property
+    def kbps(self) -> float:
+        bytes_per_sample = 2 if self.codec == CODEC_PCM16 else 1
+        return self.sample_rate * bytes_per_sample * 8 / 1000.0
+
+
+DEFAULT_LADDER = (
+    BitrateRung("pcm16-24k", CODEC_PCM16, 24000, 20),
+    BitrateRung("pcm16-16k", CODEC_PCM16, 16000, 20),
+    BitrateRung("mulaw-16k", CODEC_MULAW, 16000, 40),
+    BitrateRung("mulaw-8k", CODEC_MULAW, 8000, 60),
+)
+
+
+@dataclass
+class AdaptiveBitrateConfig:
+    """Congestion controller tuning shared by every client."""
+
+    enabled: bool = True
+    # Rung names from DEFAULT_LADDER, best first; ``None`` keeps them all.
+    ladder: Optional[List[str]] = None
+    down_interval_s: float = 1.0
+    probe_interval_s: float = 4.0
+    max_probe_interval_s: float = 30.0
+    # Smoothed RTT this far above the lowest RTT seen counts as queueing.
+    rtt_slack_ms: float = 80.0
+    # Receive rate below this fraction of the rung while the client's buffer
+    # is under ``min_buffer_ms`` means the link cannot carry the rung.
+    starved_ratio: float = 0.8
+    min_buffer_ms: float = 20.0
+
+    def build_ladder(self) -> Sequence[BitrateRung]:
+        if not self.ladder:
+            return DEFAULT_LADDER
+        by_name = {rung.name: rung for rung in DEFAULT_LADDER}
+        unknown = [name for name in self.ladder if name not in by_name]
+        if unknown:
+            raise ValueError(f"Unknown bitrate rungs {unknown}; choose from {sorted(by_name)}")
+        return tuple(by_name[name] for name in self.ladder)
+
+
+@dataclass
+class ClientFeedback:
+    receive_kbps: float = 0.0
+    buffered_ms: float = 0.0
+    underruns: int = 0
+    lost_frames: int = 0
+    rtt_ms: Optional[float] = None
+
+    @classmethod
+    def from_message(cls, message: Mapping[str, Any]) -> "ClientFeedback":
+        def _number(key: str, default: float) -> float:
+            try:
+                return float(message.get(key, default))
+            except (TypeError, ValueError):
+                return default
+
+        rtt = message.get("rtt_ms")
+        return cls(
+            receive_kbps=_number("receive_kbps", 0.0),
+            buffered_ms=_number("buffered_ms", 0.0),
+            underruns=int(_number("underruns", 0)),
+            lost_frames=int(_number("lost_frames", 0)),
+            rtt_ms=_number("rtt_ms", 0.0) if rtt is not None else None,
+        )
+
+
+class CongestionController:
+    """Chooses the rung for one client from its feedback reports."""
+
+    RTT_SMOOTHING = 0.25
+
+    def __init__(self, config: AdaptiveBitrateConfig, now: float, ladder: Optional[Sequence[BitrateRung]] = None) -> None:
+        self.config = config
+        self.ladder = tuple(ladder or config.build_ladder())
+        self.index = 0
+        self._last_change = now
+        self._last_congestion = now
+        self._probe_interval = config.probe_interval_s
+        self._probing = False
+        self._underruns: Optional[int] = None
+        self._lost_frames: Optional[int] = None
+        self._rtt_floor: Optional[float] = None
+        self._rtt: Optional[float] = None
+
+    @property
+    def rung(self) -> BitrateRung:
+        return self.ladder[self.index]
+
+    def on_feedback(self, feedback: ClientFeedback, now: float) -> bool:
+        """Updates the rung; returns True if it changed."""
+        congested = self._is_congested(feedback)
+        if congested:
+            self._last_congestion = now
+            if self._probing and now - self._last_change < self.config.down_interval_s * 2:
+                # The last probe up failed straight away; back off before the next one.
+                self._probe_interval = min(self._probe_interval * 2, self.config.max_probe_interval_s)
+            self._probing = False
+            if self.index < len(self.ladder) - 1 and now - self._last_change >= self.config.down_interval_s:
+                return self._move(self.index + 1, now, "congestion")
+            return False
+
+        quiet = now - max(self._last_congestion, self._last_change)
+        if self.index > 0 and quiet >= self._probe_interval:
+            self._probing = True
+            return self._move(self.index - 1, now, "probe")
+        if quiet >= self.config.max_probe_interval_s:
+            self._probe_interval = self.config.probe_interval_s
+        return False
+
+    def _is_congested(self, feedback: ClientFeedback) -> bool:
+        new_underruns = feedback.underruns - self._underruns if self._underruns is not None else 0
+        new_losses = feedback.lost_frames - self._lost_frames if self._lost_frames is not None else 0
+        self._underruns = feedback.underruns
+        self._lost_frames = feedback.lost_frames
+
+        queueing = False
+        if feedback.rtt_ms is not None and feedback.rtt_ms > 0:
+            self._rtt_floor = feedback.rtt_ms if self._rtt_floor is None else min(self._rtt_floor, feedback.rtt_ms)
+            self._rtt = (
+                feedback.rtt_ms
+                if self._rtt is None
+                else self._rtt + self.RTT_SMOOTHING * (feedback.rtt_ms - self._rtt)
+            )
+            queueing = self._rtt > self._rtt_floor + self.config.rtt_slack_ms
+
+        # Between utterances nothing is sent, so only judge throughput while audio flows.
+        starved = (
+            0.0 < feedback.receive_kbps < self.rung.kbps * self.config.starved_ratio
+            and feedback.buffered_ms < self.config.min_buffer_ms
+        )
+        return new_underruns > 0 or new_losses > 0 or queueing or starved
+
+    def _move(self, index: int, now: float, reason: str) -> bool:
+        logger.info("Audio bitrate %s -> %s (%s)", self.rung.name, self.ladder[index].name, reason)
+        self.index = index
+        self._last_change = now
+        return True
+
+
+def mulaw_encode(samples: np.ndarray) -> bytes:
+    """G.711 mu-law encodes int16 samples."""
+    bias = 0x84
+    clip = 32635
+    pcm = samples.astype(np.int32)
+    sign = (pcm < 0).astype(np.int32) << 7
+    magnitude = np.minimum(np.abs(pcm), clip) + bias
+    exponent = np.floor(np.log2(magnitude)).astype(np.int32) - 7
+    mantissa = (magnitude >> (exponent + 3)) & 0x0F
+    return (~(sign | (exponent << 4) | mantissa) & 0xFF).astype(np.uint8).tobytes()
+
+
+class AudioEncoder:
+    """Converts source PCM16 to one rung's sample rate and codec.
+
+    Linear resampling keeps its phase across chunks, so switching rungs
+    mid-utterance only costs one discontinuity. At the source rate with
+    PCM16 the input passes through untouched.
+    """
+
+    def __init__(self, source_rate: int) -> None:
+        self.source_rate = source_rate
+        self.rung: Optional[BitrateRung] = None
+        self._position = 0.0
+        self._previous: Optional[float] = None
+
+    def configure(self, rung: BitrateRung) -> None:
+        if rung != self.rung:
+            self.rung = rung
+            self._position = 0.0
+            self._previous = None
+
+    def encode(self, chunk: Any) -> Union[bytes, memoryview]:
+        assert self.rung is not None, "configure() before encode()"
+        view = memoryview(chunk).cast("B")
+        if self.rung.sample_rate == self.source_rate and self.rung.codec == CODEC_PCM16:
+            return view
+        samples = np.frombuffer(view, dtype="<i2")
+        if self.rung.sample_rate != self.source_rate:
+            samples = self._resample(samples)
+        if self.rung.codec == CODEC_MULAW:
+            return mulaw_encode(samples)
+        return samples.astype("<i2").tobytes()
+
+    def _resample(self, samples: np.ndarray) -> np.ndarray:
+        if samples.size == 0:
+            return samples
+        # Prepend the last sample of the previous chunk so interpolation spans the seam.
+        source = samples.astype(np.float32)
+        offset = 0.0
+        if self._previous is not None:
+            source = np.concatenate(([self._previous], source))
+            offset = 1.0
+        step = self.source_rate / self.rung.sample_rate
+        positions = np.arange(self._position + offset, source.size - 1 + 1e-9, step)
+        out = np.interp(positions, np.arange(source.size), source)
+        # Carry the next output position over into the following chunk's coordinates.
+        following = positions[-1] + step if positions.size else self._position + offset
+        self._position = following - source.size
+        self._previous = float(source[-1])
+        return np.round(out).astype(np.int16)
+
@@ -0,0 +1,218 @@
+"""Re-chunks PCM16 audio into fixed-duration websocket frames.
+
+The TTS emits chunks whose size depends on ``chunk_size`` and the decode
+cadence. :class:`AudioPacketizer` coalesces small chunks and splits large
+ones into frames of ``frame_ms``. A partial frame is never held longer than
+``max_latency_ms``. Clients opt in per connection through query parameters
+on the audio websocket::
+
+    /ws/audio?agent_id=guard&frame_ms=20&max_latency_ms=30&framing=nv1
+
+With ``framing=nv1`` every frame starts with a 16-byte little-endian
+header (:data:`FRAME_HEADER`)::
+
+    magic "NV" | version u8 | codec u8 | sequence u32 | sample_rate u32 | sample_count u32
+
+``codec`` is :data:`CODEC_PCM16` unless adaptive bitrate (see
+:mod:`Server.adaptive_bitrate`) switched the client to 8-bit mu-law.
+
+Clients that add ``dtx=1`` (which implies ``nv1`` framing) get
+discontinuous transmission: a frame whose peak level stays at or below the
+silence threshold goes out as a header-only :data:`CODEC_SILENCE` frame
+whose ``sample_count`` says how much silence to play. Consecutive silent
+frames built from the same chunk share one marker. The client expands the
+markers locally, so pauses cost 16 bytes per frame instead of the audio.
+
+Clients that pass none of these parameters receive the raw PCM chunks
+unchanged, as before.
+"""
+from __future__ import annotations
+
+import struct
+from dataclasses import dataclass
+from typing import Any, List, Mapping, Optional, Union
+
+import numpy as np
+
+FRAME_MAGIC = b"NV"
+FRAME_VERSION = 1
+CODEC_PCM16 = 0
+CODEC_MULAW = 1
+CODEC_SILENCE = 2
+BYTES_PER_SAMPLE = {CODEC_PCM16: 2, CODEC_MULAW: 1}
+FRAME_HEADER = struct.Struct("<2sBBIII")
+
+MIN_FRAME_MS = 5
+MAX_FRAME_MS = 500
+
+Frame = Union[bytes, memoryview]
+
+
+def _mulaw_magnitudes() -> np.ndarray:
+    codes = ~np.arange(256, dtype=np.int32) & 0xFF
+    return ((((codes & 0x0F) << 3) + 0x84) << ((codes >> 4) & 0x07)) - 0x84
+
+
+# Linear magnitude of every mu-law byte, for measuring the level of encoded frames.
+MULAW_MAGNITUDE = _mulaw_magnitudes()
+
+
+def frame_peak(payload: Frame, codec: int) -> int:
+    """Largest absolute int16 sample of a PCM16 or mu-law payload."""
+    if codec == CODEC_MULAW:
+        return int(MULAW_MAGNITUDE[np.frombuffer(payload, dtype=np.uint8)].max())
+    samples = np.frombuffer(payload, dtype="<i2")
+    return max(int(samples.max()), -int(samples.min()))
+
+
+@dataclass(frozen=True)
+class PacketizerSettings:
+    """Framing negotiated by one audio client."""
+
+    frame_ms: int
+    max_latency_ms: int
+    framed: bool
+    # Peak level at or below which frames are sent as silence markers; None disables DTX.
+    silence_threshold: Optional[int] = None
+
+    @classmethod
+    def from_query(
+        cls,
+        params: Mapping[str, str],
+        *,
+        default_frame_ms: int = 40,
+        default_max_latency_ms: Optional[int] = None,
+        silence_threshold: Optional[int] = None,
+    ) -> Optional["PacketizerSettings"]:
+        """Parses ``frame_ms``/``max_latency_ms``/``framing``/``dtx``; ``None`` for legacy clients.
+
+        ``silence_threshold`` is the server's DTX threshold; ``None`` refuses ``dtx=1``.
+        """
+        framing = (params.get("framing") or "").lower()
+        dtx = (params.get("dtx") or "").lower() in {"1", "true"}
+        if "frame_ms" not in params and "max_latency_ms" not in params and not framing and not dtx:
+            return None
+        frame_ms = _parse_ms(params.get("frame_ms"), default_frame_ms)
+        frame_ms = min(MAX_FRAME_MS, max(MIN_FRAME_MS, frame_ms))
+        fallback_latency = default_max_latency_ms if default_max_latency_ms is not None else frame_ms
+        max_latency_ms = max(0, _parse_ms(params.get("max_latency_ms"), fallback_latency))
+        # Silence markers are announced in frame headers, so DTX implies framing.
+        dtx = dtx and silence_threshold is not None
+        return cls(
+            frame_ms=frame_ms,
+            max_latency_ms=max_latency_ms,
+            framed=framing in {"nv1", "1", "true"} or dtx,
+            silence_threshold=silence_threshold if dtx else None,
+        )
+
+
+def _parse_ms(value: Optional[str], default: int) -> int:
+    try:
+        return int(value) if value else default
+    except ValueError:
+        return default
+
+
+class AudioPacketizer:
+    """Per-client frame builder; not thread-safe (one per websocket).
+
+    Frames returned by :meth:`push` may be memoryview slices of the chunk
+    passed in, so send them before releasing that chunk. Leftover bytes
+    that do not fill a frame are copied into an internal buffer.
+    """
+
+    def __init__(self, settings: PacketizerSettings, sample_rate: int, codec: int = CODEC_PCM16) -> None:
+        self.settings = settings
+        self._max_latency = settings.max_latency_ms / 1000.0
+        self._pending = bytearray()
+        self._pending_since: Optional[float] = None
+        self._sequence = 0
+        self._silent_run = 0
+        self._configure(sample_rate, codec, settings.frame_ms)
+
+    def _configure(self, sample_rate: int, codec: int, frame_ms: int) -> None:
+        self.sample_rate = sample_rate
+        self.codec = codec
+        self.frame_ms = frame_ms
+        self.bytes_per_sample = BYTES_PER_SAMPLE[codec]
+        self.frame_bytes = max(1, sample_rate * frame_ms // 1000) * self.bytes_per_sample
+
+    def retune(self, sample_rate: int, codec: int, frame_ms: int) -> List[Frame]:
+        """Switches the format of later frames; returns the pending partial frame in the old one."""
+        if (sample_rate, codec, frame_ms) == (self.sample_rate, self.codec, self.frame_ms):
+            return []
+        frames = self.flush()
+        self._configure(sample_rate, codec, frame_ms)
+        return frames
+
+    @property
+    def sequence(self) -> int:
+        """Sequence number the next framed packet will carry."""
+        return self._sequence
+
+    def push(self, chunk: Any, now: float) -> List[Frame]:
+        """Adds a chunk in the current codec and returns every frame that is now complete."""
+        view = memoryview(chunk).cast("B")
+        frames: List[Frame] = []
+        self._silent_run = 0
+        if self._pending:
+            take = min(self.frame_bytes - len(self._pending), len(view))
+            self._pending += view[:take]
+            view = view[take:]
+            if len(self._pending) == self.frame_bytes:
+                self._emit(frames, bytes(self._pending))
+                self._reset_pending()
+        while len(view) >= self.frame_bytes:
+            self._emit(frames, view[: self.frame_bytes])
+            view = view[self.frame_bytes:]
+        if len(view):
+            if not self._pending:
+                self._pending_since = now
+            self._pending += view
+        return frames
+
+    def time_until_flush(self, now: float) -> Optional[float]:
+        """Seconds until the partial frame must go out; ``None`` if nothing is pending."""
+        if self._pending_since is None:
+            return None
+        return max(0.0, self._pending_since + self._max_latency - now)
+
+    def flush(self) -> List[Frame]:
+        """Emits the pending partial frame, if any."""
+        if not self._pending:
+            return []
+        frames: List[Frame] = []
+        self._silent_run = 0
+        self._emit(frames, bytes(self._pending))
+        self._reset_pending()
+        return frames
+
+    def _reset_pending(self) -> None:
+        self._pending.clear()
+        self._pending_since = None
+
+    def _emit(self, frames: List[Frame], payload: Frame) -> None:
+        threshold = self.settings.silence_threshold
+        if threshold is None or frame_peak(payload, self.codec) > threshold:
+            self._silent_run = 0
+            frames.append(self._frame(payload))
+            return
+        sample_count = len(payload) // self.bytes_per_sample
+        if self._silent_run:
+            # Extend the marker sent for the previous frame of this run instead of adding one.
+            self._silent_run += sample_count
+            frames[-1] = self._header(CODEC_SILENCE, self._sequence - 1, self._silent_run)
+            return
+        self._silent_run = sample_count
+        frames.append(self._header(CODEC_SILENCE, self._sequence, sample_count))
+        self._sequence += 1
+
+    def _header(self, codec: int, sequence: int, sample_count: int) -> bytes:
+        return FRAME_HEADER.pack(FRAME_MAGIC, FRAME_VERSION, codec, sequence & 0xFFFFFFFF, self.sample_rate, sample_count)
+
+    def _frame(self, payload: Frame) -> Frame:
+        if not self.settings.framed:
+            return payload
+        header = self._header(self.codec, self._sequence, len(payload) // self.bytes_per_sample)
+        self._sequence += 1
+        return b"".join((header, payload))
@@ -5,15 +5,22 @@ import asyncio
 import json
 import logging
 import threading
-from dataclasses import dataclass
-from typing import Callable, Dict, Optional, Set
+import time
+import uuid
+from dataclasses import dataclass, field, replace
+from typing import Any, Callable, Dict, Optional
 
 
 from fastapi import FastAPI, WebSocket, WebSocketDisconnect
 from fastapi.middleware.cors import CORSMiddleware
 
+from .adaptive_bitrate import AdaptiveBitrateConfig, AudioEncoder, ClientFeedback, CongestionController
+from .packetizer import AudioPacketizer, PacketizerSettings
+
 logger = logging.getLogger(__name__)
 
+DEFAULT_AGENT_ID = "default"
+
 
 @dataclass
 class StreamConfig:
@@ -21,37 +28,164 @@ class StreamConfig:
     port: int = 5000
     audio_endpoint: str = "/ws/audio"
     emotion_endpoint: str = "/ws/emotion"
+    control_endpoint: str = "/ws/control"
+    # Framing for audio clients that ask for it without naming values.
+    default_frame_ms: int = 40
+    default_max_latency_ms: int = 40
+    # Peak int16 level at or below which frames go to dtx=1 clients as silence markers; null refuses DTX.
+    dtx_threshold: Optional[int] = 64
+    adaptive_bitrate: AdaptiveBitrateConfig = field(default_factory=AdaptiveBitrateConfig)
+
+    def __post_init__(self) -> None:
+        if isinstance(self.adaptive_bitrate, dict):
+            self.adaptive_bitrate = AdaptiveBitrateConfig(**self.adaptive_bitrate)
 
 
 class BroadcastQueue:
-    """A small helper to fan out audio or metadata frames to multiple listeners."""
+    """A small helper to fan out audio or metadata frames to multiple listeners.
+
+    Listeners live on the uvicorn thread's event loop while producers usually
+    run on the orchestrator loop, so each queue remembers its owning loop and
+    payloads are handed over with ``call_soon_threadsafe`` when needed.
+    """
 
     def __init__(self) -> None:
-        self._listeners: Set[asyncio.Queue] = set()
-        self._lock = asyncio.Lock()
+        self._listeners: Dict[asyncio.Queue, asyncio.AbstractEventLoop] = {}
+        self._lock = threading.Lock()
+
+    async def register(self, maxsize: int = 4) -> asyncio.Queue:
+        """Adds a listener queue holding up to ``maxsize`` payloads.
 
-    async def register(self) -> asyncio.Queue:
-        queue: asyncio.Queue = asyncio.Queue(maxsize=4)
-        async with self._lock:
-            self._listeners.add(queue)
+        When a listener falls behind, new payloads are dropped, which suits
+        stale audio frames. Pass ``maxsize=0`` for an unbounded queue when
+        every payload must arrive.
+        """
+        queue: asyncio.Queue = asyncio.Queue(maxsize=maxsize)
+        with self._lock:
+            self._listeners[queue] = asyncio.get_running_loop()
         return queue
 
     async def unregister(self, queue: asyncio.Queue) -> None:
-        async with self._lock:
-            self._listeners.discard(queue)
+        with self._lock:
+            self._listeners.pop(queue, None)
+
+    def __len__(self) -> int:
+        with self._lock:
+            return len(self._listeners)
+
+    async def broadcast(self, payload: Any) -> None:
+        """Queues ``payload`` for every listener.
+
+        Reference-counted payloads (objects exposing ``retain``/``release``,
+        such as pooled PCM frames) are retained once per listener and must be
+        handed to :func:`release_payload` after sending.
+        """
+        with self._lock:
+            listeners = list(self._listeners.items())
+        try:
+            current_loop: Optional[asyncio.AbstractEventLoop] = asyncio.get_running_loop()
+        except RuntimeError:
+            current_loop = None
+        retain = getattr(payload, "retain", None)
+        for queue, loop in listeners:
+            if loop.is_closed():
+                continue
+            if retain is not None:
+                retain()
+            if loop is current_loop:
+                self._offer(queue, payload)
+            else:
+                loop.call_soon_threadsafe(self._offer, queue, payload)
+
+    async def send(self, queue: asyncio.Queue, payload: Any) -> bool:
+        """Queues ``payload`` for a single registered listener."""
+        with self._lock:
+            loop = self._listeners.get(queue)
+        if loop is None or loop.is_closed():
+            return False
+        retain = getattr(payload, "retain", None)
+        if retain is not None:
+            retain()
+        try:
+            current_loop: Optional[asyncio.AbstractEventLoop] = asyncio.get_running_loop()
+        except RuntimeError:
+            current_loop = None
+        if loop is current_loop:
+            self._offer(queue, payload)
+        else:
+            loop.call_soon_threadsafe(self._offer, queue, payload)
+        return True
+
+    async def flush(self, timeout: float) -> bool:
+        """Waits until every listener has sent what was queued before the call.
+
+        Only listeners that mark each sent payload with ``task_done`` can be
+        flushed. Returns False if some listener was still behind after
+        ``timeout`` seconds (for example a client that stopped reading).
+        """
+        with self._lock:
+            listeners = list(self._listeners.items())
+        current_loop = asyncio.get_running_loop()
+        waits = []
+        for queue, loop in listeners:
+            if loop.is_closed():
+                continue
+            if loop is current_loop:
+                waits.append(asyncio.ensure_future(queue.join()))
+            else:
+                # Scheduled after any pending ``_offer`` calls, so those payloads are included.
+                waits.append(asyncio.wrap_future(asyncio.run_coroutine_threadsafe(queue.join(), loop)))
+        if not waits:
+            return True
+        _, pending = await asyncio.wait(waits, timeout=timeout)
+        for waiter in pending:
+            waiter.cancel()
+        return not pending
+
+    @staticmethod
+    def _offer(queue: asyncio.Queue, payload: Any) -> None:
+        try:
+            queue.put_nowait(payload)
+        except asyncio.QueueFull:
+            logger.debug("Dropping stale payload for listener %s", id(queue))
+            release_payload(payload)
+
+    @staticmethod
+    def drain(queue: asyncio.Queue) -> None:
+        """Releases payloads left in a listener queue after it disconnects."""
+        while not queue.empty():
+            release_payload(queue.get_nowait())
 
-    async def broadcast(self, payload: bytes) -> None:
-        async with self._lock:
-            listeners = list(self._listeners)
-        for queue in listeners:
-            try:
-                queue.put_nowait(payload)
-            except asyncio.QueueFull:
-                logger.debug("Dropping stale payload for listener %s", id(queue))
+
+def payload_view(payload: Any) -> Any:
+    """Bytes-like view of a payload; pooled frames expose a ``view`` memoryview."""
+    return getattr(payload, "view", payload)
+
+
+def release_payload(payload: Any) -> None:
+    release = getattr(payload, "release", None)
+    if release is not None:
+        release()
 
 
 class StreamServer:
-    """FastAPI application bundling the audio and emotion streaming endpoints."""
+    """FastAPI application bundling the audio, emotion and control endpoints.
+
+    Audio and emotion clients subscribe to one agent with the ``agent_id``
+    query parameter (``?agent_id=guard_01``); each agent has its own pair of
+    broadcast queues, so a client only hears the agent it follows. A queue
+    exists only while the agent has clients; frames for an agent nobody
+    follows are dropped. Audio clients may also negotiate fixed-duration
+    framing (see :mod:`Server.packetizer`).
+
+    The control endpoint carries JSON messages tagged with a ``type`` field.
+    Each control connection gets a ``client_id`` (from the query string or
+    generated) announced in a ``welcome`` message, followed by the latest
+    ``status``. Inbound messages are forwarded to ``on_control_message``
+    together with that id, and :meth:`send_control` replies to one client.
+    ``ping`` (answered with a ``pong`` echoing its ``t``) and ``feedback``
+    are handled here for adaptive bitrate (see :mod:`Server.adaptive_bitrate`).
+    """
 
     def __init__(
         self,
@@ -59,8 +193,11 @@ class StreamServer:
         *,
         on_audio_client_count_changed: Optional[Callable[[int], None]] = None,
         on_emotion_client_count_changed: Optional[Callable[[int], None]] = None,
+        on_control_message: Optional[Callable[[str, Dict[str, Any]], None]] = None,
+        audio_sample_rate: int = 24000,
     ):
         self.config = config
+        self.audio_sample_rate = audio_sample_rate
         self.app = FastAPI(title="Unreal Voice Agent Stream Server")
         self.app.add_middleware(
             CORSMiddleware,
@@ -69,38 +206,169 @@ class StreamServer:
             allow_headers=["*"],
         )
 
-        self.audio_broadcast = BroadcastQueue()
-        self.emotion_broadcast = BroadcastQueue()
+        self._audio_channels: Dict[str, BroadcastQueue] = {}
+        self._emotion_channels: Dict[str, BroadcastQueue] = {}
+        self.control_broadcast = BroadcastQueue()
+        self._control_clients: Dict[str, asyncio.Queue] = {}
+        self._status: Dict[str, Any] = {"type": "status", "state": "offline"}
+        # Adaptive bitrate state per control client, shared by its audio sockets.
+        # Only touched from the uvicorn loop.
+        self._links: Dict[str, CongestionController] = {}
+        self._link_sockets: Dict[str, int] = {}
 
         self._audio_client_count = 0
         self._emotion_client_count = 0
         self._on_audio_client_count_changed = on_audio_client_count_changed
         self._on_emotion_client_count_changed = on_emotion_client_count_changed
+        self._on_control_message = on_control_message
 
         self.app.websocket(self.config.audio_endpoint)(self._audio_handler)
         self.app.websocket(self.config.emotion_endpoint)(self._emotion_handler)
+        self.app.websocket(self.config.control_endpoint)(self._control_handler)
+
+    def audio_channel(self, agent_id: str = DEFAULT_AGENT_ID) -> BroadcastQueue:
+        return self._channel(self._audio_channels, agent_id)
+
+    def emotion_channel(self, agent_id: str = DEFAULT_AGENT_ID) -> BroadcastQueue:
+        return self._channel(self._emotion_channels, agent_id)
+
+    @staticmethod
+    def _channel(channels: Dict[str, BroadcastQueue], agent_id: str) -> BroadcastQueue:
+        channel = channels.get(agent_id)
+        if channel is None:
+            # setdefault is atomic, so the uvicorn and orchestrator threads
+            # always agree on a single queue per agent.
+            channel = channels.setdefault(agent_id, BroadcastQueue())
+        return channel
+
+    @staticmethod
+    def _release_channel(channels: Dict[str, BroadcastQueue], agent_id: str, channel: BroadcastQueue) -> None:
+        """Forgets an agent's queue once its last listener has gone.
+
+        Listeners only come and go on the uvicorn loop, and handlers register
+        right after looking a channel up, so a queue that is empty here has
+        no listener about to join it. Producers never create channels.
+        """
+        if len(channel) == 0 and channels.get(agent_id) is channel:
+            del channels[agent_id]
+
+    @staticmethod
+    def _agent_id(websocket: WebSocket) -> str:
+        return websocket.query_params.get("agent_id") or DEFAULT_AGENT_ID
 
     async def _audio_handler(self, websocket: WebSocket) -> None:
         await websocket.accept()
-        listener_queue = await self.audio_broadcast.register()
-        logger.info("Audio client connected: %s", websocket.client)
+        agent_id = self._agent_id(websocket)
+        channel = self.audio_channel(agent_id)
+        listener_queue = await channel.register()
+        settings = PacketizerSettings.from_query(
+            websocket.query_params,
+            default_frame_ms=self.config.default_frame_ms,
+            default_max_latency_ms=self.config.default_max_latency_ms,
+            silence_threshold=self.config.dtx_threshold,
+        )
+        link_id = self._adaptive_link_id(websocket)
+        controller: Optional[CongestionController] = None
+        if link_id is not None:
+            # Codec and rate switches are announced in frame headers, so adaptive clients are always framed.
+            if settings is None:
+                settings = PacketizerSettings(self.config.default_frame_ms, self.config.default_max_latency_ms, True)
+            elif not settings.framed:
+                settings = replace(settings, framed=True)
+            controller = self._acquire_link(link_id)
+        logger.info(
+            "Audio client connected: %s (agent %s, framing %s, adaptive link %s)", websocket.client, agent_id, settings, link_id
+        )
         self._audio_client_count += 1
         self._emit_audio_client_count()
         try:
-            while True:
-                chunk = await listener_queue.get()
-                await websocket.send_bytes(chunk)
+            if settings is None:
+                while True:
+                    chunk = await listener_queue.get()
+                    try:
+                        await websocket.send_bytes(payload_view(chunk))
+                    finally:
+                        release_payload(chunk)
+            else:
+                await self._send_packetized(
+                    websocket, listener_queue, AudioPacketizer(settings, self.audio_sample_rate), controller
+                )
         except WebSocketDisconnect:
             logger.info("Audio client disconnected: %s", websocket.client)
         finally:
-            await self.audio_broadcast.unregister(listener_queue)
+            await channel.unregister(listener_queue)
+            channel.drain(listener_queue)
+            self._release_channel(self._audio_channels, agent_id, channel)
+            if link_id is not None:
+                self._release_link(link_id)
             self._audio_client_count = max(0, self._audio_client_count - 1)
             self._emit_audio_client_count()
 
+    def _adaptive_link_id(self, websocket: WebSocket) -> Optional[str]:
+        params = websocket.query_params
+        if not self.config.adaptive_bitrate.enabled or (params.get("abr") or "").lower() not in {"1", "true"}:
+            return None
+        client_id = params.get("client_id")
+        if not client_id:
+            logger.warning("Audio client %s asked for adaptive bitrate without a client_id", websocket.client)
+            return None
+        return client_id
+
+    def _acquire_link(self, client_id: str) -> CongestionController:
+        controller = self._links.get(client_id)
+        if controller is None:
+            controller = CongestionController(self.config.adaptive_bitrate, time.monotonic())
+            self._links[client_id] = controller
+        self._link_sockets[client_id] = self._link_sockets.get(client_id, 0) + 1
+        return controller
+
+    def _release_link(self, client_id: str) -> None:
+        remaining = self._link_sockets.get(client_id, 1) - 1
+        if remaining > 0:
+            self._link_sockets[client_id] = remaining
+        else:
+            self._link_sockets.pop(client_id, None)
+            self._links.pop(client_id, None)
+
+    async def _send_packetized(
+        self,
+        websocket: WebSocket,
+        listener_queue: asyncio.Queue,
+        packetizer: AudioPacketizer,
+        controller: Optional[CongestionController] = None,
+    ) -> None:
+        loop = asyncio.get_running_loop()
+        encoder = AudioEncoder(self.audio_sample_rate) if controller is not None else None
+        while True:
+            timeout = packetizer.time_until_flush(loop.time())
+            try:
+                chunk = await asyncio.wait_for(listener_queue.get(), timeout)
+            except asyncio.TimeoutError:
+                for frame in packetizer.flush():
+                    await websocket.send_bytes(frame)
+                continue
+            try:
+                payload = payload_view(chunk)
+                if encoder is not None:
+                    rung = controller.rung
+                    if rung != encoder.rung:
+                        frame_ms = max(packetizer.settings.frame_ms, rung.frame_ms)
+                        for frame in packetizer.retune(rung.sample_rate, rung.codec, frame_ms):
+                            await websocket.send_bytes(frame)
+                        encoder.configure(rung)
+                    payload = encoder.encode(payload)
+                # Frames may slice the chunk's buffer, so send before releasing.
+                for frame in packetizer.push(payload, loop.time()):
+                    await websocket.send_bytes(frame)
+            finally:
+                release_payload(chunk)
+
     async def _emotion_handler(self, websocket: WebSocket) -> None:
         await websocket.accept()
-        listener_queue = await self.emotion_broadcast.register()
-        logger.info("Emotion client connected: %s", websocket.client)
+        agent_id = self._agent_id(websocket)
+        channel = self.emotion_channel(agent_id)
+        listener_queue = await channel.register()
+        logger.info("Emotion client connected: %s (agent %s)", websocket.client, agent_id)
         self._emotion_client_count += 1
         self._emit_emotion_client_count()
         try:
@@ -110,16 +378,116 @@ class StreamServer:
         except WebSocketDisconnect:
             logger.info("Emotion client disconnected: %s", websocket.client)
         finally:
-            await self.emotion_broadcast.unregister(listener_queue)
+            await channel.unregister(listener_queue)
+            self._release_channel(self._emotion_channels, agent_id, channel)
             self._emotion_client_count = max(0, self._emotion_client_count - 1)
             self._emit_emotion_client_count()
 
-    async def push_audio(self, chunk: bytes) -> None:
-        await self.audio_broadcast.broadcast(chunk)
+    async def _control_handler(self, websocket: WebSocket) -> None:
+        await websocket.accept()
+        client_id = websocket.query_params.get("client_id") or uuid.uuid4().hex
+        # Replies such as turn results and admission answers must not be dropped.
+        listener_queue = await self.control_broadcast.register(maxsize=0)
+        self._control_clients[client_id] = listener_queue
+        logger.info("Control client connected: %s (%s)", websocket.client, client_id)
+
+        async def _send_loop() -> None:
+            await websocket.send_text(json.dumps({"type": "welcome", "client_id": client_id}))
+            await websocket.send_text(json.dumps(self._status))
+            while True:
+                payload = await listener_queue.get()
+                try:
+                    await websocket.send_text(payload.decode("utf-8"))
+                finally:
+                    listener_queue.task_done()
 
-    async def push_emotion(self, payload: Dict[str, float]) -> None:
+        sender = asyncio.create_task(_send_loop())
+        try:
+            while True:
+                raw_message = await websocket.receive_text()
+                await self._dispatch_control_message(client_id, raw_message)
+        except WebSocketDisconnect:
+            logger.info("Control client disconnected: %s", websocket.client)
+        finally:
+            sender.cancel()
+            if self._control_clients.get(client_id) is listener_queue:
+                del self._control_clients[client_id]
+            await self.control_broadcast.unregister(listener_queue)
+
+    async def _dispatch_control_message(self, client_id: str, raw_message: str) -> None:
+        try:
+            message = json.loads(raw_message)
+        except json.JSONDecodeError:
+            logger.warning("Invalid control message from %s: %s", client_id, raw_message)
+            return
+        if not isinstance(message, dict) or "type" not in message:
+            logger.warning("Control message from %s lacks a type: %s", client_id, raw_message)
+            return
+        if message["type"] == "ping":
+            await self.send_control(client_id, {"type": "pong", "t": message.get("t")})
+            return
+        if message["type"] == "feedback":
+            await self._on_feedback(client_id, message)
+            return
+        if not self._on_control_message:
+            logger.debug("Ignoring control message from %s: %s", client_id, raw_message)
+            return
+        try:
+            self._on_control_message(client_id, message)
+        except Exception:  # pragma: no cover - defensive logging
+            logger.exception("Control message callback failed")
+
+    async def _on_feedback(self, client_id: str, message: Dict[str, Any]) -> None:
+        controller = self._links.get(client_id)
+        if controller is None:
+            logger.debug("Feedback from %s without adaptive audio sockets", client_id)
+            return
+        if controller.on_feedback(ClientFeedback.from_message(message), time.monotonic()):
+            rung = controller.rung
+            await self.send_control(
+                client_id,
+                {"type": "bitrate", "rung": rung.name, "kbps": rung.kbps, "sample_rate": rung.sample_rate},
+            )
+
+    async def push_audio(self, chunk: Any, agent_id: str = DEFAULT_AGENT_ID) -> None:
+        """Broadcasts a PCM chunk to the clients following ``agent_id``.
+
+        Chunks are bytes-like or pooled frames exposing a ``view``. Pooled
+        frames travel to ``send_bytes`` as memoryviews without copies; the
+        caller keeps its own reference and releases it afterwards.
+        """
+        channel = self._audio_channels.get(agent_id)
+        if channel is not None:
+            await channel.broadcast(chunk)
+
+    async def push_emotion(self, payload: Dict[str, float], agent_id: str = DEFAULT_AGENT_ID) -> None:
+        channel = self._emotion_channels.get(agent_id)
+        if channel is not None:
+            await channel.broadcast(json.dumps(payload).encode("utf-8"))
+
+    async def push_control(self, payload: Dict[str, Any]) -> None:
         message = json.dumps(payload)
-        await self.emotion_broadcast.broadcast(message.encode("utf-8"))
+        await self.control_broadcast.broadcast(message.encode("utf-8"))
+
+    async def send_control(self, client_id: str, payload: Dict[str, Any]) -> bool:
+        """Sends a control message to one client; returns False if it is gone."""
+        queue = self._control_clients.get(client_id)
+        if queue is None:
+            return False
+        return await self.control_broadcast.send(queue, json.dumps(payload).encode("utf-8"))
+
+    async def set_status(self, state: str, **details: Any) -> None:
+        """Records the server status and announces it on the control channel."""
+        self._status = {"type": "status", "state": state, **details}
+        await self.push_control(self._status)
+
+    async def flush_control(self, timeout: float = 1.0) -> bool:
+        """Waits until control messages queued so far have reached every client."""
+        return await self.control_broadcast.flush(timeout)
+
+    @property
+    def status(self) -> Dict[str, Any]:
+        return dict(self._status)
 
     def _emit_audio_client_count(self) -> None:
         if self._on_audio_client_count_changed:
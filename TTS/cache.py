@@ -0,0 +1,148 @@
+"""Cache of synthesised speech shared by identical TTS requests."""
+from __future__ import annotations
+
+import asyncio
+import logging
+from collections import OrderedDict
+from typing import AsyncIterator, Callable, Hashable, List, Optional, Set, Union
+
+import numpy as np
+
+from TTS.kani_tts.audio.pcm import PCMChunk, PCMFrame, pcm_view, release_pcm
+
+logger = logging.getLogger(__name__)
+
+# Stored chunk: int16 samples of a pooled frame, or the bytes of any other chunk.
+_Stored = Union[np.ndarray, bytes]
+
+
+class _Entry:
+    __slots__ = ("chunks", "size", "done", "error", "changed")
+
+    def __init__(self) -> None:
+        self.chunks: List[_Stored] = []
+        self.size = 0
+        self.done = False
+        self.error: Optional[BaseException] = None
+        self.changed = asyncio.Event()
+
+    def notify(self) -> None:
+        # Waiters hold the old event; the next chunk gets a fresh one.
+        changed, self.changed = self.changed, asyncio.Event()
+        changed.set()
+
+
+class TTSResultCache:
+    """Keeps the PCM chunks of recent utterances and shares generations in flight.
+
+    Requests are keyed by everything that shapes the audio (voice, text,
+    rate, temperature, chunk size, seed). The first request for a key starts
+    one generation in a background task. Every request for that key,
+    including ones that arrive while it is still running, replays the
+    chunks produced so far and then follows the generation as it goes
+    (single flight). Finished utterances stay cached until the least
+    recently used ones are evicted to keep the total under ``max_bytes``.
+
+    Replayed chunks are unpooled :class:`PCMFrame` views over read-only
+    samples shared by every listener, so fan-out costs no copies; releasing
+    them is a no-op. Failed generations are not cached.
+
+    Not thread-safe: use it from one event loop.
+    """
+
+    def __init__(self, max_bytes: int, max_text_chars: int = 200) -> None:
+        self.max_bytes = max(0, max_bytes)
+        self.max_text_chars = max_text_chars
+        self.hits = 0
+        self.joins = 0
+        self.misses = 0
+        self._entries: "OrderedDict[Hashable, _Entry]" = OrderedDict()
+        self._size = 0
+        self._tasks: Set[asyncio.Task] = set()
+
+    @property
+    def size_bytes(self) -> int:
+        """Bytes held by finished utterances."""
+        return self._size
+
+    def accepts(self, text: str) -> bool:
+        """Only short texts (barks, system lines) are worth keeping; long replies rarely repeat."""
+        return self.max_bytes > 0 and len(text) <= self.max_text_chars
+
+    async def stream(
+        self, key: Hashable, generate: Callable[[], AsyncIterator[PCMChunk]]
+    ) -> AsyncIterator[PCMChunk]:
+        """Yields the chunks for ``key``, from the cache, a running generation or a new one."""
+        entry = self._entries.get(key)
+        if entry is None:
+            self.misses += 1
+            entry = _Entry()
+            self._entries[key] = entry
+            task = asyncio.get_running_loop().create_task(self._fill(key, entry, generate()))
+            self._tasks.add(task)
+            task.add_done_callback(self._tasks.discard)
+        else:
+            self._entries.move_to_end(key)
+            if entry.done:
+                self.hits += 1
+            else:
+                self.joins += 1
+                logger.debug("TTS request joined a generation in flight (%s chunks so far)", len(entry.chunks))
+
+        index = 0
+        while True:
+            if index < len(entry.chunks):
+                yield self._replay(entry.chunks[index])
+                index += 1
+                continue
+            if entry.done:
+                if entry.error is not None:
+                    raise entry.error
+                return
+            await entry.changed.wait()
+
+    async def _fill(self, key: Hashable, entry: _Entry, source: AsyncIterator[PCMChunk]) -> None:
+        try:
+            async for chunk in source:
+                try:
+                    stored = self._store(chunk)
+                finally:
+                    release_pcm(chunk)
+                entry.chunks.append(stored)
+                entry.size += len(stored) * 2 if isinstance(stored, np.ndarray) else len(stored)
+                entry.notify()
+        except BaseException as exc:
+            entry.error = exc
+            if self._entries.get(key) is entry:
+                del self._entries[key]
+            if not isinstance(exc, Exception):
+                raise
+        finally:
+            entry.done = True
+            entry.notify()
+        if self._entries.get(key) is entry:
+            self._size += entry.size
+            self._evict()
+
+    def _evict(self) -> None:
+        for key in list(self._entries):
+            if self._size <= self.max_bytes:
+                return
+            entry = self._entries[key]
+            if entry.done:
+                del self._entries[key]
+                self._size -= entry.size
+
+    @staticmethod
+    def _store(chunk: PCMChunk) -> _Stored:
+        if isinstance(chunk, PCMFrame):
+            samples = chunk.samples.copy()
+            samples.setflags(write=False)
+            return samples
+        return bytes(pcm_view(chunk))
+
+    @staticmethod
+    def _replay(stored: _Stored) -> PCMChunk:
+        if isinstance(stored, np.ndarray):
+            return PCMFrame(None, stored, stored.shape[0])
+        return stored
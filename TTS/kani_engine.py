@@ -1,18 +1,72 @@
 """Wrapper for the Kani-TTS synthesiser with streaming output."""
 from __future__ import annotations
 
+import asyncio
 import logging
+import re
+import time
 from pathlib import Path
-from typing import AsyncIterator, Optional
+from typing import AsyncIterator, List, Optional, Union
 
 import numpy as np
 
+from TTS.cache import TTSResultCache
 from TTS.kani_tts import KaniSynthesizer
+from TTS.kani_tts.audio.pcm import PCMBufferPool, PCMChunk, PCMFrame, pcm_view, release_pcm
 from TTS.kani_tts.model_utils import resolve_model_directory
 
 
 logger = logging.getLogger(__name__)
 
+# A run of sentence-ending punctuation (plus closing quotes or brackets) followed by whitespace.
+_SENTENCE_END = re.compile(r"(?:(?<=[.!?…])|(?<=[.!?…][\"')\]]))\s+")
+_CLAUSE_END = re.compile(r"(?<=[,;:])\s+")
+
+
+def _pack(parts: List[str], max_chars: int) -> List[str]:
+    packed: List[str] = []
+    for part in parts:
+        if packed and len(packed[-1]) + 1 + len(part) <= max_chars:
+            packed[-1] = f"{packed[-1]} {part}"
+        else:
+            packed.append(part)
+    return packed
+
+
+def split_sentences(text: str, min_chars: int = 20, max_chars: int = 250) -> List[str]:
+    """Splits ``text`` into segments that are synthesised separately.
+
+    Segments end at sentence punctuation. Sentences shorter than
+    ``min_chars`` are joined to the next one (a short trailing sentence to
+    the previous one). Sentences longer than ``max_chars`` are split at
+    clause punctuation, then between words, so no segment runs into the
+    generator's token limit.
+    """
+    pieces: List[str] = []
+    for sentence in _SENTENCE_END.split(text.strip()):
+        sentence = sentence.strip()
+        if len(sentence) <= max_chars:
+            pieces.append(sentence)
+            continue
+        for clause in _pack(_CLAUSE_END.split(sentence), max_chars):
+            pieces.extend(_pack(clause.split(), max_chars) if len(clause) > max_chars else [clause])
+
+    segments: List[str] = []
+    current = ""
+    for piece in pieces:
+        if not piece:
+            continue
+        current = f"{current} {piece}" if current else piece
+        if len(current) >= min_chars:
+            segments.append(current)
+            current = ""
+    if current:
+        if segments and len(segments[-1]) + 1 + len(current) <= max_chars:
+            segments[-1] = f"{segments[-1]} {current}"
+        else:
+            segments.append(current)
+    return segments
+
 
 class KaniTTSConfig:
     """Configuration for the Kani-TTS wrapper."""
@@ -24,12 +78,50 @@ class KaniTTSConfig:
         sample_rate: int = 24000,
         chunk_size: int = 1024,
         temperature: float = 0.8,
+        warmup_text: str = "Hello.",
+        device: Optional[str] = None,
+        quantization: Optional[str] = None,
+        voice_prompt_format: str = "{text}",
+        decode_batch_wait_ms: Optional[float] = 5.0,
+        decode_batch_size: int = 8,
+        parallel_sentences: int = 2,
+        sentence_min_chars: int = 20,
+        sentence_max_chars: int = 250,
+        sentence_join_ms: float = 5.0,
+        cache_max_mb: float = 64.0,
+        cache_max_text_chars: int = 200,
     ) -> None:
         self.model_dir = model_dir
+        # Default speaker; requests may pick another voice of the same model.
         self.voice = voice
         self.sample_rate = sample_rate
         self.chunk_size = chunk_size
         self.temperature = temperature
+        self.warmup_text = warmup_text
+        # ``None`` picks CUDA/MPS when available; "cpu" forces float32 on CPU.
+        self.device = device
+        # "int8" applies dynamic int8 quantisation to the TTS LM on CPU.
+        self.quantization = quantization
+        # How the speaker is put in the prompt. The default "{text}" sends the
+        # plain text; multi-speaker Kani checkpoints expect "{voice}: {text}".
+        self.voice_prompt_format = voice_prompt_format
+        # Codec chunks of concurrent streams are decoded together; a chunk waits at
+        # most this long for others. ``None`` decodes every stream separately.
+        self.decode_batch_wait_ms = decode_batch_wait_ms
+        self.decode_batch_size = decode_batch_size
+        # Long texts are split into sentences (see split_sentences); up to this
+        # many are generated at once and streamed in order. 1 synthesises the
+        # whole text in one generation.
+        self.parallel_sentences = parallel_sentences
+        self.sentence_min_chars = sentence_min_chars
+        self.sentence_max_chars = sentence_max_chars
+        # Length of the fade that joins consecutive sentences without a click.
+        self.sentence_join_ms = sentence_join_ms
+        # Speech of recent short texts is kept (up to this many MB) and identical
+        # requests share one generation; 0 disables the cache. Texts longer than
+        # cache_max_text_chars are always generated afresh.
+        self.cache_max_mb = cache_max_mb
+        self.cache_max_text_chars = cache_max_text_chars
 
 
 class KaniTTSEngine:
@@ -38,6 +130,10 @@ class KaniTTSEngine:
     def __init__(self, config: KaniTTSConfig):
         self.config = config
         self._synth: Optional[KaniSynthesizer] = None
+        self._join_pool = PCMBufferPool(max_free=4)
+        self.cache: Optional[TTSResultCache] = None
+        if config.cache_max_mb > 0:
+            self.cache = TTSResultCache(int(config.cache_max_mb * 1024 * 1024), config.cache_max_text_chars)
 
     async def load(self) -> None:
 
@@ -48,9 +144,26 @@ class KaniTTSEngine:
             voice=self.config.voice,
             sample_rate=self.config.sample_rate,
             chunk_size=self.config.chunk_size,
+            device=self.config.device,
+            quantization=self.config.quantization,
+            voice_prompt_format=self.config.voice_prompt_format,
+            decode_batch_wait_ms=self.config.decode_batch_wait_ms,
+            decode_batch_size=self.config.decode_batch_size,
         )
+        # The synthesiser would otherwise load lazily on the first stream()
+        # call, charging model loading to the first utterance.
+        await asyncio.to_thread(self._synth.load)
         logger.info("Kani-TTS ready with voice '%s'", self.config.voice)
 
+    async def warm_up(self) -> None:
+        """Runs one throwaway synthesis so CUDA kernels and caches are primed."""
+        if not self.config.warmup_text:
+            return
+        started = time.perf_counter()
+        async for chunk in self.synthesize_stream(self.config.warmup_text):
+            release_pcm(chunk)
+        logger.info("Kani-TTS warm-up finished in %.2fs", time.perf_counter() - started)
+
     @property
     def is_ready(self) -> bool:
         return self._synth is not None
@@ -59,45 +172,185 @@ class KaniTTSEngine:
         self,
         text: str,
         *,
+        voice: Optional[str] = None,
         sample_rate: Optional[int] = None,
         temperature: Optional[float] = None,
         chunk_size: Optional[int] = None,
-    ) -> AsyncIterator[bytes]:
-        """Generates PCM16 audio chunks for the supplied text."""
+        seed: Optional[int] = None,
+    ) -> AsyncIterator[PCMChunk]:
+        """Generates PCM16 audio chunks for the supplied text.
+
+        Chunks are pooled :class:`PCMFrame` objects (or plain bytes-like
+        objects from other synthesiser backends). The consumer owns one
+        reference and should call :func:`release_pcm` when done with it.
+        ``seed`` makes the sampled speech reproducible.
+
+        Texts with several sentences are generated sentence by sentence, the
+        next ones concurrently while the first streams (``parallel_sentences``).
+        Chunks still arrive strictly in text order.
+
+        Short texts go through the result cache (see :class:`TTSResultCache`):
+        a repeat of a recent request replays its audio, and concurrent
+        identical requests share one generation.
+        """
         if not self.is_ready:
             raise RuntimeError("KaniTTSEngine.synthesize_stream called before load().")
 
-        assert self._synth is not None
-
         stream_sample_rate = sample_rate or self.config.sample_rate
         stream_temperature = temperature if temperature is not None else self.config.temperature
         stream_chunk_size = chunk_size or self.config.chunk_size
+        voice = voice or self.config.voice
+
+        def _generate() -> AsyncIterator[PCMChunk]:
+            return self._generate(text, voice, stream_sample_rate, stream_temperature, stream_chunk_size, seed)
 
-        stream = self._synth.stream(  # type: ignore[attr-defined]
+        if self.cache is not None and self.cache.accepts(text):
+            key = (voice, text, stream_sample_rate, stream_temperature, stream_chunk_size, seed)
+            stream = self.cache.stream(key, _generate)
+        else:
+            stream = _generate()
+        async for chunk in stream:
+            yield chunk
+
+    async def _generate(
+        self,
+        text: str,
+        voice: str,
+        stream_sample_rate: int,
+        stream_temperature: float,
+        stream_chunk_size: int,
+        seed: Optional[int],
+    ) -> AsyncIterator[PCMChunk]:
+        segments = [text]
+        if self.config.parallel_sentences > 1:
+            segments = split_sentences(text, self.config.sentence_min_chars, self.config.sentence_max_chars) or [text]
+        if len(segments) == 1:
+            stream = self._stream_segment(text, voice, stream_sample_rate, stream_temperature, stream_chunk_size, seed)
+        else:
+            stream = self._stream_sentences(segments, voice, stream_sample_rate, stream_temperature, stream_chunk_size, seed)
+        async for chunk in stream:
+            yield chunk
+
+    async def _stream_segment(
+        self,
+        text: str,
+        voice: Optional[str],
+        stream_sample_rate: int,
+        stream_temperature: float,
+        stream_chunk_size: int,
+        seed: Optional[int],
+    ) -> AsyncIterator[PCMChunk]:
+        assert self._synth is not None
+        stream_kwargs = {"seed": seed} if seed is not None else {}
+        # Prefer the asyncio stream: the sync one blocks the event loop between chunks.
+        stream_method = getattr(self._synth, "astream", None) or self._synth.stream
+        stream = stream_method(
             text=text,
+            voice=voice or self.config.voice,
             sample_rate=stream_sample_rate,
             temperature=stream_temperature,
             chunk_size=stream_chunk_size,
+            **stream_kwargs,
         )
 
         if hasattr(stream, "__aiter__"):
             async for chunk in stream:  # type: ignore[assignment]
-                if isinstance(chunk, np.ndarray):
-                    yield chunk.tobytes()
-                else:
-                    yield bytes(chunk)
+                yield self._as_pcm_chunk(chunk)
         else:
             for chunk in stream:  # type: ignore[assignment]
-                if isinstance(chunk, np.ndarray):
-                    yield chunk.tobytes()
-                else:
-                    yield bytes(chunk)
+                yield self._as_pcm_chunk(chunk)
+
+    async def _stream_sentences(
+        self,
+        segments: List[str],
+        voice: Optional[str],
+        stream_sample_rate: int,
+        stream_temperature: float,
+        stream_chunk_size: int,
+        seed: Optional[int],
+    ) -> AsyncIterator[PCMChunk]:
+        """Generates ``segments`` concurrently and yields their chunks in order.
+
+        Sentences later than the one being streamed buffer their audio until
+        it is their turn. Each sentence gets its own seed derived from ``seed``.
+        """
+        outputs: List["asyncio.Queue[Union[PCMChunk, BaseException, None]]"] = [asyncio.Queue() for _ in segments]
+        slots = asyncio.Semaphore(self.config.parallel_sentences)
+
+        async def _produce(index: int, segment: str) -> None:
+            async with slots:
+                segment_seed = None if seed is None else (seed + index) & 0x7FFFFFFF
+                stream = self._stream_segment(
+                    segment, voice, stream_sample_rate, stream_temperature, stream_chunk_size, segment_seed
+                )
+                try:
+                    async for chunk in stream:
+                        outputs[index].put_nowait(chunk)
+                except Exception as exc:
+                    outputs[index].put_nowait(exc)
+                    return
+                finally:
+                    await stream.aclose()
+            outputs[index].put_nowait(None)
+
+        # Semaphore waiters are served in order, so sentences start in text order.
+        producers = [asyncio.create_task(_produce(index, segment)) for index, segment in enumerate(segments)]
+        fade_samples = int(stream_sample_rate * self.config.sentence_join_ms / 1000.0)
+        tail = 0
+        try:
+            for index, output in enumerate(outputs):
+                first = index > 0
+                while True:
+                    chunk = await output.get()
+                    if chunk is None:
+                        break
+                    if isinstance(chunk, BaseException):
+                        raise chunk
+                    if first and fade_samples > 0 and isinstance(chunk, PCMFrame):
+                        ramp = self._join_sentences(tail, chunk, fade_samples)
+                        if ramp is not None:
+                            yield ramp
+                    first = False
+                    if isinstance(chunk, PCMFrame) and len(chunk):
+                        tail = int(chunk.samples[-1])
+                    yield chunk
+        finally:
+            for producer in producers:
+                producer.cancel()
+            await asyncio.gather(*producers, return_exceptions=True)
+            for output in outputs:
+                while not output.empty():
+                    leftover = output.get_nowait()
+                    if not isinstance(leftover, BaseException) and leftover is not None:
+                        release_pcm(leftover)
+
+    def _join_sentences(self, tail: int, head: PCMFrame, fade_samples: int) -> Optional[PCMFrame]:
+        """Fades ``head`` in and returns a short ramp from the previous sentence's last sample to silence."""
+        samples = head.samples
+        count = min(fade_samples, samples.shape[0])
+        if count:
+            gain = np.linspace(0.0, 1.0, count, endpoint=False, dtype=np.float32)
+            samples[:count] = (samples[:count] * gain).astype(np.int16)
+        if tail == 0:
+            return None
+        ramp = self._join_pool.acquire(fade_samples)
+        ramp.samples[:] = (tail * np.linspace(1.0, 0.0, fade_samples, endpoint=False, dtype=np.float32)).astype(np.int16)
+        return ramp
+
+    @staticmethod
+    def _as_pcm_chunk(chunk: object) -> PCMChunk:
+        if isinstance(chunk, (PCMFrame, bytes, bytearray, memoryview)):
+            return chunk
+        if isinstance(chunk, np.ndarray):
+            return memoryview(np.ascontiguousarray(chunk)).cast("B")
+        return bytes(chunk)  # type: ignore[arg-type]
 
     async def synthesize_to_file(self, text: str, output_path: Path) -> Path:
         """Synthesise the provided text to a WAV file on disk."""
         output_path.parent.mkdir(parents=True, exist_ok=True)
         audio_data = bytearray()
         async for chunk in self.synthesize_stream(text):
-            audio_data.extend(chunk)
+            audio_data.extend(pcm_view(chunk))
+            release_pcm(chunk)
         output_path.write_bytes(bytes(audio_data))
         return output_path
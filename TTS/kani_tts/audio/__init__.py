@@ -1,6 +1,18 @@
 """Audio processing modules for Kani TTS"""
 
-from .player import LLMAudioPlayer
+from .batching import BatchedCodecDecoder
+from .pcm import PCMBufferPool, PCMChunk, PCMFrame, pcm_view, release_pcm
+from .player import LLMAudioPlayer, load_codec_model
 from .streaming import StreamingAudioWriter
 
-__all__ = ['LLMAudioPlayer', 'StreamingAudioWriter']
+__all__ = [
+    'BatchedCodecDecoder',
+    'LLMAudioPlayer',
+    'PCMBufferPool',
+    'PCMChunk',
+    'PCMFrame',
+    'StreamingAudioWriter',
+    'load_codec_model',
+    'pcm_view',
+    'release_pcm',
+]
@@ -0,0 +1,104 @@
+"""Codec decoding shared by concurrent streams."""
+from __future__ import annotations
+
+import threading
+import time
+from dataclasses import dataclass, field
+from typing import List, Optional
+
+import numpy as np
+
+
+@dataclass
+class _DecodeRequest:
+    codes: np.ndarray
+    submitted: float = field(default_factory=time.monotonic)
+    done: threading.Event = field(default_factory=threading.Event)
+    audio: Optional[np.ndarray] = None
+    error: Optional[BaseException] = None
+
+
+class BatchedCodecDecoder:
+    """Stands in for an :class:`LLMAudioPlayer` and decodes chunks of all open streams together.
+
+    Each :class:`StreamingAudioWriter` still calls :meth:`decode_audio_chunk`
+    from its own thread, but the call only queues the chunk. One worker
+    thread takes the queued chunks, decodes them in a single padded
+    :meth:`LLMAudioPlayer.decode_audio_batch` pass and hands every writer
+    its own audio.
+
+    The worker starts a batch as soon as every open stream (see
+    :meth:`open_stream`) has a chunk waiting or ``max_batch`` chunks are
+    queued, and never holds the oldest chunk longer than ``max_wait_ms``.
+    A lone stream is therefore decoded without delay, and with several
+    streams a chunk waits at most ``max_wait_ms`` for company.
+
+    Other attributes (speech markers, device) are read from the wrapped player.
+    """
+
+    def __init__(self, player, max_wait_ms: float = 5.0, max_batch: int = 8) -> None:
+        self._player = player
+        self.max_wait = max(0.0, max_wait_ms) / 1000.0
+        self.max_batch = max(1, max_batch)
+        self._cond = threading.Condition()
+        self._pending: List[_DecodeRequest] = []
+        self._open_streams = 0
+        self._worker: Optional[threading.Thread] = None
+
+    def __getattr__(self, name: str):
+        return getattr(self._player, name)
+
+    def open_stream(self) -> None:
+        """Registers a stream that will submit chunks; the worker waits for open streams only."""
+        with self._cond:
+            self._open_streams += 1
+
+    def close_stream(self) -> None:
+        with self._cond:
+            self._open_streams = max(0, self._open_streams - 1)
+            # A batch waiting for this stream can go now.
+            self._cond.notify_all()
+
+    def decode_audio_chunk(self, audio_codes) -> Optional[np.ndarray]:
+        """Decodes ``audio_codes`` (shape ``[num_frames, 4]``) as part of the next batch."""
+        if len(audio_codes) == 0:
+            return None
+        request = _DecodeRequest(np.asarray(audio_codes))
+        with self._cond:
+            if self._worker is None:
+                self._worker = threading.Thread(target=self._run, name="KaniCodecBatch", daemon=True)
+                self._worker.start()
+            self._pending.append(request)
+            self._cond.notify_all()
+        request.done.wait()
+        if request.error is not None:
+            raise request.error
+        return request.audio
+
+    def _take_batch(self) -> List[_DecodeRequest]:
+        with self._cond:
+            while not self._pending:
+                self._cond.wait()
+            deadline = self._pending[0].submitted + self.max_wait
+            while len(self._pending) < min(self.max_batch, max(1, self._open_streams)):
+                remaining = deadline - time.monotonic()
+                if remaining <= 0:
+                    break
+                self._cond.wait(remaining)
+            batch = self._pending[: self.max_batch]
+            del self._pending[: self.max_batch]
+            return batch
+
+    def _run(self) -> None:
+        while True:
+            batch = self._take_batch()
+            try:
+                results = self._player.decode_audio_batch([request.codes for request in batch])
+            except BaseException as exc:  # pragma: no cover - codec failure reaches every caller
+                for request in batch:
+                    request.error = exc
+                    request.done.set()
+                continue
+            for request, audio in zip(batch, results):
+                request.audio = audio
+                request.done.set()
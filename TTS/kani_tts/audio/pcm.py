@@ -0,0 +1,116 @@
+"""Pooled PCM16 buffers shared between the decoder and the stream server.
+
+The codec produces float32 chunks. :class:`PCMBufferPool` converts each one
+into a reusable int16 buffer in a single pass and wraps it in a
+:class:`PCMFrame`. The frame is handed to consumers as a ``memoryview``
+without further copies. A frame goes back to the pool once every holder
+has called :meth:`PCMFrame.release`. Frames that are never released are
+simply garbage collected, so a forgotten release costs an allocation and
+never corrupts audio.
+"""
+from __future__ import annotations
+
+import threading
+from typing import List, Optional, Union
+
+import numpy as np
+
+
+class PCMFrame:
+    """Reference-counted view over a pooled int16 buffer."""
+
+    __slots__ = ("_pool", "_buffer", "_length", "_refs")
+
+    def __init__(self, pool: Optional["PCMBufferPool"], buffer: np.ndarray, length: int) -> None:
+        self._pool = pool
+        self._buffer = buffer
+        self._length = length
+        self._refs = 1
+
+    @property
+    def samples(self) -> np.ndarray:
+        """The int16 samples as a numpy view (no copy)."""
+        return self._buffer[: self._length]
+
+    @property
+    def view(self) -> memoryview:
+        """The PCM16 little-endian payload as a byte ``memoryview`` (no copy)."""
+        return memoryview(self._buffer[: self._length]).cast("B")
+
+    def retain(self) -> "PCMFrame":
+        if self._pool is not None:
+            with self._pool._lock:
+                self._refs += 1
+        return self
+
+    def release(self) -> None:
+        pool = self._pool
+        if pool is None:
+            return
+        with pool._lock:
+            self._refs -= 1
+            if self._refs > 0:
+                return
+            self._pool = None
+        pool._recycle(self._buffer)
+
+    def __len__(self) -> int:
+        return self._length * 2
+
+
+PCMChunk = Union[bytes, bytearray, memoryview, PCMFrame]
+
+
+class PCMBufferPool:
+    """Free list of int16 buffers reused across chunks and streams."""
+
+    def __init__(self, *, max_free: int = 16) -> None:
+        self.max_free = max_free
+        self._free: List[np.ndarray] = []
+        self._lock = threading.Lock()
+
+    def acquire(self, num_samples: int) -> PCMFrame:
+        with self._lock:
+            for index, buffer in enumerate(self._free):
+                if buffer.shape[0] >= num_samples:
+                    del self._free[index]
+                    break
+            else:
+                buffer = None
+        if buffer is None:
+            buffer = np.empty(num_samples, dtype=np.int16)
+        return PCMFrame(self, buffer, num_samples)
+
+    def convert(self, audio: np.ndarray) -> PCMFrame:
+        """Convert float samples in ``[-1, 1]`` into a pooled PCM16 frame.
+
+        Clipping happens in place when ``audio`` is a writable float array
+        (the codec output is owned by the caller), so the only write is the
+        float → int16 conversion into the pooled buffer.
+        """
+        audio = np.asarray(audio).reshape(-1)
+        if audio.dtype.kind == "f" and audio.flags.writeable:
+            np.clip(audio, -1.0, 1.0, out=audio)
+        else:
+            audio = np.clip(audio, -1.0, 1.0)
+        frame = self.acquire(audio.shape[0])
+        np.multiply(audio, 32767, out=frame.samples, casting="unsafe")
+        return frame
+
+    def _recycle(self, buffer: np.ndarray) -> None:
+        with self._lock:
+            if len(self._free) < self.max_free:
+                self._free.append(buffer)
+
+
+def pcm_view(chunk: PCMChunk) -> Union[bytes, bytearray, memoryview]:
+    """Return a bytes-like view of ``chunk`` without copying."""
+    if isinstance(chunk, PCMFrame):
+        return chunk.view
+    return chunk
+
+
+def release_pcm(chunk: PCMChunk) -> None:
+    """Drop the caller's reference to ``chunk`` if it is a pooled frame."""
+    if isinstance(chunk, PCMFrame):
+        chunk.release()
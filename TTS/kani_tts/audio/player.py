@@ -98,25 +98,34 @@ def _load_audio_codec_model():  # pragma: no cover - heavy dependency
     return AudioCodecModel
 
 
+def _default_device() -> str:
+    if torch.cuda.is_available():
+        return 'cuda'
+    if hasattr(torch.backends, "mps") and torch.backends.mps.is_available():
+        return 'mps'
+    return 'cpu'
+
+
+def load_codec_model(device: str | None = None):
+    """Load the NeMo nano codec onto ``device``.
+
+    Split out of :class:`LLMAudioPlayer` so callers can load the codec on a
+    worker thread while the TTS language model loads on another.
+    """
+    try:
+        audio_codec_model = _load_audio_codec_model()
+    except RuntimeError as exc:
+        raise RuntimeError(str(exc)) from exc
+
+    codec_model = audio_codec_model.from_pretrained(config.CODEC_MODEL_NAME).eval()
+    codec_model.to(device or _default_device())
+    return codec_model
+
+
 class LLMAudioPlayer:
-    def __init__(self, tokenizer) -> None:
-        try:
-            audio_codec_model = _load_audio_codec_model()
-        except RuntimeError as exc:
-            raise RuntimeError(str(exc)) from exc
-
-        self.nemo_codec_model = audio_codec_model.from_pretrained(
-            config.CODEC_MODEL_NAME
-        ).eval()
-
-        if torch.cuda.is_available():
-            self.device = 'cuda'
-        elif hasattr(torch.backends, "mps") and torch.backends.mps.is_available():
-            self.device = 'mps'
-        else:
-            self.device = 'cpu'
-
-        self.nemo_codec_model.to(self.device)
+    def __init__(self, tokenizer, codec_model=None, device: str | None = None) -> None:
+        self.device = device or _default_device()
+        self.nemo_codec_model = codec_model if codec_model is not None else load_codec_model(self.device)
         self.tokenizer = tokenizer
 
         self.tokeniser_length = TOKENIZER_LENGTH
@@ -201,3 +210,39 @@ class LLMAudioPlayer:
             output_audio = reconstructed_audio.cpu().detach().numpy().squeeze()
 
         return output_audio
+
+    def decode_audio_batch(self, batch):
+        """Decode several chunks (each ``[num_frames, 4]``) in one padded codec pass.
+
+        Returns one waveform per chunk, trimmed to the chunk's own length;
+        empty or invalid chunks yield ``None`` like :meth:`decode_audio_chunk`.
+        """
+        results = [None] * len(batch)
+        offsets = torch.tensor([self.codebook_size * i for i in range(4)], device=self.device)
+        rows = []
+        codes = []
+        for index, audio_codes in enumerate(batch):
+            if len(audio_codes) == 0:
+                continue
+            chunk_codes = torch.tensor(audio_codes, device=self.device) - offsets - self.audio_tokens_start
+            if (chunk_codes < 0).sum().item() > 0:
+                continue
+            rows.append(index)
+            codes.append(chunk_codes.T)
+        if not codes:
+            return results
+
+        # Shape: (batch, 4, max_frames); frames past a chunk's length are padding masked by tokens_len.
+        lengths = torch.tensor([chunk.shape[-1] for chunk in codes], device=self.device)
+        tokens = torch.zeros((len(codes), 4, int(lengths.max().item())), dtype=codes[0].dtype, device=self.device)
+        for row, chunk in enumerate(codes):
+            tokens[row, :, : chunk.shape[-1]] = chunk
+
+        with torch.inference_mode():
+            reconstructed_audio, audio_len = self.nemo_codec_model.decode(tokens=tokens, tokens_len=lengths)
+            output_audio = reconstructed_audio.cpu().detach().numpy()
+            output_len = audio_len.cpu().tolist()
+
+        for row, index in enumerate(rows):
+            results[index] = output_audio[row, : output_len[row]]
+        return results
@@ -1,21 +1,28 @@
 """Text-to-speech generation logic"""
 
+import copy
 import logging
 import time
 import warnings
-from threading import Thread
-from typing import Optional
+from collections import OrderedDict
+from dataclasses import dataclass
+from threading import Lock
+from typing import Any, Dict, Optional, Tuple
 
 import torch
 from transformers import AutoModelForCausalLM, AutoTokenizer
 from transformers.generation.streamers import BaseStreamer
 
+from Utils.model_loading import quantize_dynamic_int8, safetensors_kwargs
+
 from ..config import (
     MODEL_NAME,
     START_OF_HUMAN,
     END_OF_TEXT,
     END_OF_HUMAN,
     END_OF_AI,
+    START_OF_SPEECH,
+    END_OF_SPEECH,
     TEMPERATURE,
     TOP_P,
     REPETITION_PENALTY,
@@ -26,11 +33,23 @@ from ..model_utils import resolve_model_reference
 
 logger = logging.getLogger(__name__)
 
+# torch's sampling RNG is process-wide, so seeded generations run one at a time.
+_seeded_generation_lock = Lock()
+
 
 class TokenIDStreamer(BaseStreamer):
-    """Custom streamer that yields token IDs"""
-    def __init__(self, callback):
+    """Custom streamer that hands token IDs to ``callback`` a codec frame at a time.
+
+    ``model.generate()`` emits one token per step. They are collected into
+    lists of ``batch_size`` tokens (one frame of 4 codes); speech markers
+    flush immediately so the writer sees the start and end of speech
+    without delay.
+    """
+    def __init__(self, callback, batch_size=4, flush_tokens=(START_OF_SPEECH, END_OF_SPEECH)):
         self.callback = callback
+        self.batch_size = batch_size
+        self.flush_tokens = frozenset(flush_tokens)
+        self._pending = []
 
     def put(self, value):
         """Called by model.generate() with token IDs"""
@@ -39,12 +58,36 @@ class TokenIDStreamer(BaseStreamer):
         else:
             token_ids = value.tolist()
 
+        pending = self._pending
         for token_id in token_ids:
-            self.callback(token_id)
+            pending.append(token_id)
+            if len(pending) >= self.batch_size or token_id in self.flush_tokens:
+                self._flush()
+                pending = self._pending
+
+    def _flush(self):
+        if self._pending:
+            token_ids, self._pending = self._pending, []
+            self.callback(token_ids)
 
     def end(self):
         """Called when generation is complete"""
-        pass
+        self._flush()
+
+
+@dataclass
+class VoicePrefix:
+    """Conditioning shared by every request spoken in one voice.
+
+    ``input_ids`` holds ``START_OF_HUMAN`` plus the tokenised voice prompt.
+    ``past_key_values`` is the model's cache for those ids, so a request
+    only runs the forward pass over its own text. Each request decodes on a
+    deep copy, which keeps the cached entry intact.
+    """
+
+    voice: str
+    input_ids: torch.Tensor
+    past_key_values: Any = None
 
 
 class TTSGenerator:
@@ -54,7 +97,20 @@ class TTSGenerator:
         model_name: Optional[str] = None,
         torch_dtype: torch.dtype = torch.bfloat16,
         device_map: str = "auto",
+        device: Optional[str] = None,
+        quantization: Optional[str] = None,
+        voice_prompt_format: str = "{text}",
+        cache_voice_prefix: bool = True,
+        max_voice_prefixes: int = 16,
     ) -> None:
+        if "{text}" not in voice_prompt_format:
+            raise ValueError("voice_prompt_format must contain '{text}'")
+        self.voice_prompt_format = voice_prompt_format
+        self.cache_voice_prefix = cache_voice_prefix
+        # Voices come from clients, so only the most recently used keep their KV cache.
+        self.max_voice_prefixes = max(1, max_voice_prefixes)
+        self._voice_prefixes: "OrderedDict[str, VoicePrefix]" = OrderedDict()
+        self._voice_lock = Lock()
         self.model_path = model_name or MODEL_NAME
         self.model_path = resolve_model_reference(self.model_path, log=logger)
 
@@ -63,62 +119,138 @@ class TTSGenerator:
             UserWarning,
         )
 
+        if device == "cpu":
+            # bfloat16 matmuls are emulated on most CPUs; float32 is faster.
+            torch_dtype = torch.float32
+            device_map = {"": "cpu"}
+
+        # Safetensors checkpoints are memory-mapped and copied straight into
+        # the target device instead of being materialised twice in RAM.
         self.model = AutoModelForCausalLM.from_pretrained(
             self.model_path,
             torch_dtype=torch_dtype,
             device_map=device_map,
             trust_remote_code=True,
             ignore_mismatched_sizes=True,
+            low_cpu_mem_usage=True,
+            **safetensors_kwargs(self.model_path),
         )
+        if quantization == "int8":
+            if device == "cpu":
+                self.model = quantize_dynamic_int8(self.model)
+            else:
+                logger.warning("int8 dynamic quantisation only applies to device 'cpu'; ignoring")
         self.tokenizer = AutoTokenizer.from_pretrained(
             self.model_path,
             trust_remote_code=True,
         )
 
-        if torch.cuda.is_available():
+        if device is not None:
+            self.device = device
+        elif torch.cuda.is_available():
             self.device = 'cuda'
         elif hasattr(torch.backends, "mps") and torch.backends.mps.is_available():
             self.device = 'mps'
         else:
             self.device = 'cpu'
 
-    def prepare_input(self, prompt):
-        """Build custom input_ids with special tokens"""
-        input_ids = self.tokenizer(prompt, return_tensors="pt").input_ids
-        start_token = torch.tensor([[START_OF_HUMAN]], dtype=torch.int64)
+    def _split_voice_prompt(self, voice: str) -> Tuple[str, str]:
+        head, tail = self.voice_prompt_format.split("{text}", 1)
+        return head.format(voice=voice), tail.format(voice=voice)
+
+    def voice_prefix(self, voice: str) -> VoicePrefix:
+        """Return the cached conditioning for ``voice``, building it on first use."""
+        with self._voice_lock:
+            prefix = self._voice_prefixes.get(voice)
+            if prefix is not None:
+                self._voice_prefixes.move_to_end(voice)
+                return prefix
+            head, _ = self._split_voice_prompt(voice)
+            start_token = torch.tensor([[START_OF_HUMAN]], dtype=torch.int64)
+            input_ids = start_token
+            if head.strip():
+                voice_ids = self.tokenizer(head.rstrip(), return_tensors="pt").input_ids
+                input_ids = torch.cat([start_token, voice_ids], dim=1)
+            input_ids = input_ids.to(self.device)
+
+            past_key_values = None
+            if self.cache_voice_prefix:
+                try:
+                    with torch.inference_mode():
+                        past_key_values = self.model(input_ids=input_ids, use_cache=True).past_key_values
+                except Exception:  # pragma: no cover - model specific
+                    logger.warning("Model cannot cache voice prefixes; recomputing them per request", exc_info=True)
+                    self.cache_voice_prefix = False
+
+            prefix = VoicePrefix(voice=voice, input_ids=input_ids, past_key_values=past_key_values)
+            self._voice_prefixes[voice] = prefix
+            logger.info("Cached conditioning for voice '%s' (%s tokens)", voice, input_ids.shape[1])
+            while len(self._voice_prefixes) > self.max_voice_prefixes:
+                evicted, _ = self._voice_prefixes.popitem(last=False)
+                logger.info("Dropped cached conditioning for voice '%s'", evicted)
+            return prefix
+
+    def prepare_input(self, prompt, voice: Optional[str] = None):
+        """Build custom input_ids with special tokens.
+
+        Returns ``(input_ids, attention_mask, prefix)`` where ``prefix`` is the
+        cached :class:`VoicePrefix` the ids start with, or ``None`` when the
+        plain prompt was used.
+        """
         end_tokens = torch.tensor([[END_OF_TEXT, END_OF_HUMAN]], dtype=torch.int64)
-        modified_input_ids = torch.cat([start_token, input_ids, end_tokens], dim=1)
-        modified_input_ids = modified_input_ids.to(self.device)
+        if voice and "{voice}" not in self.voice_prompt_format:
+            # Single-speaker formats such as the default "{text}" keep the plain prompt.
+            prompt = self.voice_prompt_format.format(voice=voice, text=prompt)
+            voice = None
+        if voice:
+            prefix = self.voice_prefix(voice)
+            head, tail = self._split_voice_prompt(voice)
+            # Trailing whitespace of the head stays with the text so BPE
+            # merges match the unsplit "{voice}: {text}" prompt.
+            text = head[len(head.rstrip()):] + prompt + tail
+            input_ids = self.tokenizer(text, add_special_tokens=False, return_tensors="pt").input_ids
+            modified_input_ids = torch.cat([prefix.input_ids, input_ids.to(self.device), end_tokens.to(self.device)], dim=1)
+        else:
+            prefix = None
+            input_ids = self.tokenizer(prompt, return_tensors="pt").input_ids
+            start_token = torch.tensor([[START_OF_HUMAN]], dtype=torch.int64)
+            modified_input_ids = torch.cat([start_token, input_ids, end_tokens], dim=1)
+            modified_input_ids = modified_input_ids.to(self.device)
 
         attention_mask = torch.ones(1, modified_input_ids.shape[1], dtype=torch.int64)
         attention_mask = attention_mask.to(self.device)
 
-        return modified_input_ids, attention_mask
+        return modified_input_ids, attention_mask, prefix
 
     def generate(
         self,
         prompt,
         audio_writer,
         *,
+        voice: Optional[str] = None,
         temperature: Optional[float] = None,
         top_p: Optional[float] = None,
         max_tokens: Optional[int] = None,
+        seed: Optional[int] = None,
     ):
-        """Generate speech tokens from text prompt"""
-        modified_input_ids, attention_mask = self.prepare_input(prompt)
+        """Generate speech tokens from text prompt.
+
+        With ``seed`` the sampled tokens depend only on the seed and the
+        prompt, at the cost of serialising seeded generations.
+        """
+        modified_input_ids, attention_mask, prefix = self.prepare_input(prompt, voice)
 
         point_1 = time.time()
 
         # Stream tokens from LLM
         all_token_ids = []
 
-        def on_token_generated(token_id):
-            """Callback for each generated token"""
-            all_token_ids.append(token_id)
-            # print(f"[LLM] Token {len(all_token_ids)}: {token_id}")
-            audio_writer.add_token(token_id)
+        def on_tokens_generated(token_ids):
+            """Callback for each frame of generated tokens"""
+            all_token_ids.extend(token_ids)
+            audio_writer.add_tokens(token_ids)
 
-        streamer = TokenIDStreamer(callback=on_token_generated)
+        streamer = TokenIDStreamer(callback=on_tokens_generated)
 
         generation_kwargs = dict(
             input_ids=modified_input_ids,
@@ -132,14 +264,19 @@ class TTSGenerator:
             eos_token_id=END_OF_AI,
             streamer=streamer,
         )
+        if prefix is not None and prefix.past_key_values is not None:
+            generation_kwargs["past_key_values"] = copy.deepcopy(prefix.past_key_values)
 
-        thread = Thread(target=self.model.generate, kwargs=generation_kwargs)
-        thread.start()
-        thread.join()
+        if seed is None:
+            self.model.generate(**generation_kwargs)
+        else:
+            with _seeded_generation_lock:
+                torch.manual_seed(seed)
+                self.model.generate(**generation_kwargs)
 
         point_2 = time.time()
 
-        print(f"\n[MAIN] Generation complete. Total tokens: {len(all_token_ids)}")
+        logger.debug("Generation complete: %s tokens in %.2fs", len(all_token_ids), point_2 - point_1)
 
         # Decode generated text from token IDs
         generated_text = self.tokenizer.decode(all_token_ids, skip_special_tokens=True)
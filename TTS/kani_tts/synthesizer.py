@@ -1,15 +1,15 @@
 """High level synthesizer API exposed to the rest of the project."""
 from __future__ import annotations
 
+import asyncio
 import queue
 import threading
+from concurrent.futures import ThreadPoolExecutor
 from pathlib import Path
-from typing import Generator, Iterable, Optional
-
-import numpy as np
+from typing import AsyncIterator, Callable, Generator, Iterable, Optional
 
 from . import config
-from .audio import LLMAudioPlayer, StreamingAudioWriter
+from .audio import BatchedCodecDecoder, LLMAudioPlayer, PCMBufferPool, PCMFrame, StreamingAudioWriter, load_codec_model
 from .generation import TTSGenerator
 
 
@@ -23,88 +23,245 @@ class KaniSynthesizer:
         sample_rate: int | None = None,
         chunk_size: int | None = None,
         lookback_frames: int | None = None,
+        device: str | None = None,
+        quantization: str | None = None,
+        voice_prompt_format: str = "{text}",
+        decode_batch_wait_ms: float | None = 5.0,
+        decode_batch_size: int = 8,
     ) -> None:
         self.model_path = str(model_path) if model_path else config.MODEL_NAME
         self.voice = voice or "kari"
         self.sample_rate = sample_rate or config.SAMPLE_RATE
         self.chunk_size = chunk_size or config.CHUNK_SIZE
         self.lookback_frames = lookback_frames or config.LOOKBACK_FRAMES
+        self.device = device
+        self.quantization = quantization
+        self.voice_prompt_format = voice_prompt_format
+        # ``None`` lets every stream run the codec on its own; otherwise see BatchedCodecDecoder.
+        self.decode_batch_wait_ms = decode_batch_wait_ms
+        self.decode_batch_size = decode_batch_size
 
         self._generator: Optional[TTSGenerator] = None
         self._player: Optional[LLMAudioPlayer] = None
+        self._batched_decoder: Optional[BatchedCodecDecoder] = None
+        self._load_lock = threading.Lock()
+        self._pcm_pool = PCMBufferPool()
 
     def load(self) -> None:
-        if self._generator is None:
-            self._generator = TTSGenerator(model_name=self.model_path)
-        if self._player is None:
-            self._player = LLMAudioPlayer(self._generator.tokenizer)
+        """Load the TTS language model and the audio codec concurrently."""
+        with self._load_lock:
+            if self._generator is not None and self._player is not None:
+                return
+            with ThreadPoolExecutor(max_workers=2, thread_name_prefix="KaniLoad") as pool:
+                generator_future = None
+                codec_future = None
+                if self._generator is None:
+                    generator_future = pool.submit(
+                        TTSGenerator,
+                        model_name=self.model_path,
+                        device=self.device,
+                        quantization=self.quantization,
+                        voice_prompt_format=self.voice_prompt_format,
+                    )
+                if self._player is None:
+                    codec_future = pool.submit(load_codec_model, self.device)
+                if generator_future is not None:
+                    self._generator = generator_future.result()
+                if codec_future is not None:
+                    self._player = LLMAudioPlayer(
+                        self._generator.tokenizer,
+                        codec_model=codec_future.result(),
+                        device=self.device,
+                    )
+
+    def _decoder(self):
+        """The codec as seen by stream writers: the shared batching decoder when enabled."""
+        if self.decode_batch_wait_ms is None:
+            return self._player
+        with self._load_lock:
+            if self._batched_decoder is None:
+                self._batched_decoder = BatchedCodecDecoder(
+                    self._player,
+                    max_wait_ms=self.decode_batch_wait_ms,
+                    max_batch=self.decode_batch_size,
+                )
+            return self._batched_decoder
 
     def stream(
         self,
         text: str,
         *,
+        voice: str | None = None,
         sample_rate: int | None = None,
         chunk_size: int | None = None,
         lookback_frames: int | None = None,
         temperature: float | None = None,
         top_p: float | None = None,
         max_tokens: int | None = None,
-    ) -> Iterable[bytes]:
+        seed: int | None = None,
+    ) -> Iterable[PCMFrame]:
+        """Stream ``text`` spoken in ``voice`` (the synthesizer default if unset).
+
+        Streams may run concurrently from several threads; every voice shares
+        the loaded model and reuses its cached conditioning, and their codec
+        chunks are decoded in shared batches. A ``seed`` makes the audio
+        reproducible (see :meth:`TTSGenerator.generate`); seeded streams skip
+        the shared batches, whose padded passes depend on the other streams.
+        """
         if not text:
             return iter(())
 
-        self.load()
-        assert self._generator is not None
-        assert self._player is not None
+        chunk_queue: "queue.Queue[tuple[str, PCMFrame | str | None]]" = queue.Queue()
+        self._start(
+            text,
+            lambda message, payload: chunk_queue.put((message, payload)),
+            voice=voice,
+            sample_rate=sample_rate,
+            chunk_size=chunk_size,
+            lookback_frames=lookback_frames,
+            temperature=temperature,
+            top_p=top_p,
+            max_tokens=max_tokens,
+            seed=seed,
+        )
 
-        chunk_queue: "queue.Queue[tuple[str, Optional[np.ndarray] | Optional[str]]]" = queue.Queue()
+        def _pcm_chunks() -> Generator[PCMFrame, None, None]:
+            while True:
+                message, payload = chunk_queue.get()
+                if message == "chunk":
+                    assert isinstance(payload, PCMFrame)
+                    yield payload
+                elif message == "done":
+                    break
+                elif message == "error":
+                    raise RuntimeError(payload or "KaniSynthesizer failed")
 
-        stream_sample_rate = sample_rate or self.sample_rate
-        stream_chunk_size = chunk_size or self.chunk_size
-        stream_lookback_frames = lookback_frames or self.lookback_frames
+        return _pcm_chunks()
 
-        class _ChunkList(list):
-            def append(self, chunk: np.ndarray) -> None:  # type: ignore[override]
-                super().append(chunk)
-                chunk_queue.put(("chunk", chunk))
+    async def astream(
+        self,
+        text: str,
+        *,
+        voice: str | None = None,
+        sample_rate: int | None = None,
+        chunk_size: int | None = None,
+        lookback_frames: int | None = None,
+        temperature: float | None = None,
+        top_p: float | None = None,
+        max_tokens: int | None = None,
+        seed: int | None = None,
+    ) -> AsyncIterator[PCMFrame]:
+        """:meth:`stream` for asyncio callers.
 
-        writer = StreamingAudioWriter(
-            self._player,
-            output_file=None,
-            sample_rate=stream_sample_rate,
-            chunk_size=stream_chunk_size,
-            lookback_frames=stream_lookback_frames,
-        )
-        writer.audio_chunks = _ChunkList()  # type: ignore[assignment]
+        The decoder thread posts each frame to the running loop as soon as it
+        is converted, so the loop never blocks on synthesis. Frames not yet
+        consumed when the caller stops iterating are released.
+        """
+        if not text:
+            return
+        if self._generator is None or self._player is None:
+            await asyncio.to_thread(self.load)
 
-        def _generate() -> None:
-            try:
-                writer.start()
-                self._generator.generate(
-                    text,
-                    writer,
-                    temperature=temperature,
-                    top_p=top_p,
-                    max_tokens=max_tokens,
-                )
-                writer.finalize()
-                chunk_queue.put(("done", None))
-            except Exception as exc:  # pragma: no cover - propagation
-                chunk_queue.put(("error", str(exc)))
+        loop = asyncio.get_running_loop()
+        chunk_queue: "asyncio.Queue[tuple[str, PCMFrame | str | None]]" = asyncio.Queue()
+        closed = threading.Event()
 
-        thread = threading.Thread(target=_generate, daemon=True)
-        thread.start()
+        def _emit(message: str, payload: PCMFrame | str | None) -> None:
+            if not closed.is_set():
+                try:
+                    loop.call_soon_threadsafe(chunk_queue.put_nowait, (message, payload))
+                    return
+                except RuntimeError:  # loop already closed
+                    pass
+            if isinstance(payload, PCMFrame):
+                payload.release()
 
-        def _pcm_chunks() -> Generator[bytes, None, None]:
+        self._start(
+            text,
+            _emit,
+            voice=voice,
+            sample_rate=sample_rate,
+            chunk_size=chunk_size,
+            lookback_frames=lookback_frames,
+            temperature=temperature,
+            top_p=top_p,
+            max_tokens=max_tokens,
+            seed=seed,
+        )
+        try:
             while True:
-                message, payload = chunk_queue.get()
+                message, payload = await chunk_queue.get()
                 if message == "chunk":
-                    assert isinstance(payload, np.ndarray)
-                    pcm_data = np.clip(payload, -1.0, 1.0)
-                    yield (pcm_data * 32767).astype(np.int16).tobytes()
+                    assert isinstance(payload, PCMFrame)
+                    yield payload
                 elif message == "done":
                     break
                 elif message == "error":
                     raise RuntimeError(payload or "KaniSynthesizer failed")
+        finally:
+            closed.set()
+            while not chunk_queue.empty():
+                _, payload = chunk_queue.get_nowait()
+                if isinstance(payload, PCMFrame):
+                    payload.release()
 
-        return _pcm_chunks()
+    def _start(
+        self,
+        text: str,
+        emit: Callable[[str, PCMFrame | str | None], None],
+        *,
+        voice: str | None,
+        sample_rate: int | None,
+        chunk_size: int | None,
+        lookback_frames: int | None,
+        temperature: float | None,
+        top_p: float | None,
+        max_tokens: int | None,
+        seed: int | None,
+    ) -> None:
+        """Runs one generation on a worker thread.
+
+        ``emit`` is called from worker threads with ``("chunk", frame)`` for
+        every decoded chunk, then ``("done", None)`` or ``("error", message)``.
+        """
+        self.load()
+        assert self._generator is not None
+        assert self._player is not None
+
+        # A padded batch pass is not bit-identical to decoding alone, so seeded audio bypasses it.
+        decoder = self._player if seed is not None else self._decoder()
+        batched = isinstance(decoder, BatchedCodecDecoder)
+        writer = StreamingAudioWriter(
+            decoder,
+            output_file=None,
+            sample_rate=sample_rate or self.sample_rate,
+            chunk_size=chunk_size or self.chunk_size,
+            lookback_frames=lookback_frames or self.lookback_frames,
+            on_chunk=lambda audio: emit("chunk", self._pcm_pool.convert(audio)),
+        )
+
+        def _generate() -> None:
+            if batched:
+                decoder.open_stream()
+            try:
+                writer.start()
+                try:
+                    self._generator.generate(
+                        text,
+                        writer,
+                        voice=voice or self.voice,
+                        temperature=temperature,
+                        top_p=top_p,
+                        max_tokens=max_tokens,
+                        seed=seed,
+                    )
+                finally:
+                    writer.finalize()
+                emit("done", None)
+            except Exception as exc:  # pragma: no cover - propagation
+                emit("error", str(exc))
+            finally:
+                if batched:
+                    decoder.close_stream()
+
+        threading.Thread(target=_generate, daemon=True).start()
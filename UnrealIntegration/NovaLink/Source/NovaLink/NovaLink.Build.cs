@@ -14,7 +14,9 @@ public class NovaLink : ModuleRules
             "InputCore",
             "Json",
             "JsonUtilities",
-            "AudioMixer"
+            "AudioMixer",
+            // NovaLinkChannel.h is a public template over IWebSocket.
+            "WebSockets"
         });
 
         PrivateDependencyModuleNames.AddRange(new[]
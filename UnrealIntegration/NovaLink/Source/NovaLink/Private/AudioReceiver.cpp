@@ -1,8 +1,9 @@
 #include "AudioReceiver.h"
 
-#include "WebSocketsModule.h"
-#include "IWebSocket.h"
-#include "Modules/ModuleManager.h"
+#include "Core/PcmConvert.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "NovaLinkUrl.h"
 
 namespace
 {
@@ -11,101 +12,151 @@ namespace
 
 UAudioReceiver::UAudioReceiver()
     : WebSocketUrl(DefaultAudioUrl)
-    , bIsConnected(false)
 {
 }
 
 void UAudioReceiver::StartConnection(const FString& OptionalOverrideUrl)
 {
     FString TargetUrl = OptionalOverrideUrl.IsEmpty() ? WebSocketUrl : OptionalOverrideUrl;
-
-    if (TargetUrl.IsEmpty())
+    TargetUrl = NovaLink::AppendQueryParameter(TargetUrl, TEXT("agent_id"), AgentId);
+    if (FrameMs > 0)
     {
-        UE_LOG(LogTemp, Warning, TEXT("NovaLink AudioReceiver requires a websocket URL."));
-        return;
+        TargetUrl = NovaLink::AppendQueryParameter(TargetUrl, TEXT("frame_ms"), FString::FromInt(FrameMs));
     }
-
-    StopConnection();
-
-    FWebSocketsModule* Module = FModuleManager::GetModulePtr<FWebSocketsModule>("WebSockets");
-    if (!Module)
+    if (MaxLatencyMs > 0)
+    {
+        TargetUrl = NovaLink::AppendQueryParameter(TargetUrl, TEXT("max_latency_ms"), FString::FromInt(MaxLatencyMs));
+    }
+    if (bAdaptiveBitrate && ClientId.IsEmpty())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("NovaLink AudioReceiver needs a ClientId for adaptive bitrate; using a fixed bitrate."));
+    }
+    // Codec switches and silence markers are announced in frame headers.
+    const bool bFramed = UsesFramedAudio();
+    if (bAdaptiveBitrate && !ClientId.IsEmpty())
+    {
+        TargetUrl = NovaLink::AppendQueryParameter(TargetUrl, TEXT("abr"), TEXT("1"));
+        TargetUrl = NovaLink::AppendQueryParameter(TargetUrl, TEXT("client_id"), ClientId);
+    }
+    if (bSilenceSuppression)
+    {
+        TargetUrl = NovaLink::AppendQueryParameter(TargetUrl, TEXT("dtx"), TEXT("1"));
+    }
+    if (bFramed)
     {
-        Module = &FModuleManager::LoadModuleChecked<FWebSocketsModule>("WebSockets");
+        TargetUrl = NovaLink::AppendQueryParameter(TargetUrl, TEXT("framing"), TEXT("nv1"));
     }
 
-    WebSocket = Module->CreateWebSocket(TargetUrl);
+    Channel.GetDecoder().bFramed = bFramed;
+    Channel.Start(TargetUrl);
+}
 
-    WebSocket->OnConnected().AddUObject(this, &UAudioReceiver::HandleConnected);
-    WebSocket->OnConnectionError().AddUObject(this, &UAudioReceiver::HandleConnectionError);
-    WebSocket->OnClosed().AddUObject(this, &UAudioReceiver::HandleClosed);
-    WebSocket->OnRawMessage().AddUObject(this, &UAudioReceiver::HandleBinaryMessage);
+void UAudioReceiver::StopConnection()
+{
+    Channel.Stop();
+}
 
-    WebSocket->Connect();
+bool UAudioReceiver::IsConnected() const
+{
+    return Channel.IsConnected();
 }
 
-void UAudioReceiver::StopConnection()
+void UAudioReceiver::HandleConnectionChanged(bool bConnected)
+{
+    OnConnectionStateChanged.Broadcast(bConnected);
+}
+
+void UAudioReceiver::DeliverPayload(const FNovaLinkAudioPayload& Payload)
 {
-    if (WebSocket.IsValid())
+    const uint8* Data = Payload.Data;
+    int32 Size = Payload.Size;
+
+    if (Payload.bFramed)
     {
-        WebSocket->OnConnected().RemoveAll(this);
-        WebSocket->OnConnectionError().RemoveAll(this);
-        WebSocket->OnClosed().RemoveAll(this);
-        WebSocket->OnRawMessage().RemoveAll(this);
+        OnAudioFrameReceived.Broadcast(Payload.Info, Data, Size);
 
-        if (WebSocket->IsConnected())
+        if (!OnRawAudioReceived.IsBound() && !OnAudioChunkReceived.IsBound())
+        {
+            return;
+        }
+        if (Payload.Info.Codec == static_cast<uint8>(NovaLink::Dsp::EFrameCodec::MuLaw))
         {
-            WebSocket->Close(1000, TEXT("AudioReceiver Stop"));
+            DecodedPayload.SetNumUninitialized(Size * 2, EAllowShrinking::No);
+            NovaLink::Dsp::ConvertMuLawToPcm16(Data, static_cast<std::size_t>(Size), DecodedPayload.GetData());
+            Data = DecodedPayload.GetData();
+            Size = DecodedPayload.Num();
+        }
+        else if (Payload.Info.Codec == static_cast<uint8>(NovaLink::Dsp::EFrameCodec::Silence))
+        {
+            ExpandSilence(Payload.Info.SampleCount);
+            Data = DecodedPayload.GetData();
+            Size = DecodedPayload.Num();
         }
     }
 
-    ResetWebSocket();
-}
+    OnRawAudioReceived.Broadcast(Data, Size);
 
-bool UAudioReceiver::IsConnected() const
-{
-    return bIsConnected;
+    if (OnAudioChunkReceived.IsBound())
+    {
+        TArray<uint8> Buffer;
+        Buffer.Append(Data, Size);
+        OnAudioChunkReceived.Broadcast(Buffer);
+    }
 }
 
-void UAudioReceiver::HandleConnected()
+void UAudioReceiver::ExpandSilence(int32 NumSamples)
 {
-    bIsConnected = true;
-    OnConnectionStateChanged.Broadcast(true);
-}
+    NumSamples = FMath::Max(0, NumSamples);
+    DecodedPayload.SetNumUninitialized(NumSamples * 2, EAllowShrinking::No);
+    if (ComfortNoiseLevel <= 0.0f)
+    {
+        FMemory::Memzero(DecodedPayload.GetData(), DecodedPayload.Num());
+        return;
+    }
 
-void UAudioReceiver::HandleConnectionError(const FString& Error)
-{
-    UE_LOG(LogTemp, Error, TEXT("NovaLink AudioReceiver connection error: %s"), *Error);
-    bIsConnected = false;
-    OnConnectionStateChanged.Broadcast(false);
-    ResetWebSocket();
+    const float Scale = FMath::Clamp(ComfortNoiseLevel, 0.0f, 1.0f) * 32767.0f;
+    uint8* Out = DecodedPayload.GetData();
+    for (int32 Index = 0; Index < NumSamples; ++Index)
+    {
+        NoiseState = NoiseState * 1664525u + 1013904223u;
+        const float Noise = static_cast<float>(NoiseState >> 8) * (2.0f / 16777216.0f) - 1.0f;
+        const uint16 Sample = static_cast<uint16>(static_cast<int16>(Noise * Scale));
+        Out[2 * Index] = static_cast<uint8>(Sample);
+        Out[2 * Index + 1] = static_cast<uint8>(Sample >> 8);
+    }
 }
 
-void UAudioReceiver::HandleClosed(int32 StatusCode, const FString& Reason, bool bWasClean)
+void FNovaLinkAudioDecodePolicy::RecordArrival(const FNovaLinkAudioFrameInfo& Info)
 {
-    bIsConnected = false;
-    OnConnectionStateChanged.Broadcast(false);
-    ResetWebSocket();
+    const double ArrivalMs = (FPlatformTime::Seconds() - TraceStartSeconds) * 1000.0;
+    ArrivalTrace += FString::Printf(TEXT("%.3f,%u,%d,%d,%u\n"), ArrivalMs, Info.Sequence, Info.SampleRate, Info.SampleCount, Info.Codec);
 }
 
-void UAudioReceiver::HandleBinaryMessage(const void* Data, SIZE_T Size, SIZE_T BytesRemaining)
+void UAudioReceiver::StartArrivalTrace()
 {
-    if (!Data || Size == 0)
+    if (!UsesFramedAudio())
     {
-        return;
+        UE_LOG(LogTemp, Warning, TEXT("NovaLink AudioReceiver arrival traces need framed audio; enable bFramedAudio before connecting."));
     }
-
-    const uint8* ByteData = static_cast<const uint8*>(Data);
-    TArray<uint8> Buffer;
-    Buffer.Append(ByteData, static_cast<int32>(Size));
-
-    OnAudioChunkReceived.Broadcast(Buffer);
+    FNovaLinkAudioDecodePolicy& Decoder = Channel.GetDecoder();
+    Decoder.bRecordingTrace = true;
+    Decoder.TraceStartSeconds = FPlatformTime::Seconds();
+    Decoder.ArrivalTrace = TEXT("arrival_ms,sequence,sample_rate,sample_count,codec\n");
 }
 
-void UAudioReceiver::ResetWebSocket()
+bool UAudioReceiver::StopArrivalTrace(const FString& FilePath)
 {
-    if (WebSocket.IsValid())
+    FNovaLinkAudioDecodePolicy& Decoder = Channel.GetDecoder();
+    if (!Decoder.bRecordingTrace)
+    {
+        return false;
+    }
+    Decoder.bRecordingTrace = false;
+    const bool bSaved = FFileHelper::SaveStringToFile(Decoder.ArrivalTrace, *FilePath);
+    if (!bSaved)
     {
-        WebSocket.Reset();
+        UE_LOG(LogTemp, Warning, TEXT("NovaLink AudioReceiver could not write the arrival trace to %s."), *FilePath);
     }
-    bIsConnected = false;
+    Decoder.ArrivalTrace.Empty();
+    return bSaved;
 }
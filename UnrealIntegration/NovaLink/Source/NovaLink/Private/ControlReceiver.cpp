@@ -0,0 +1,203 @@
+#include "ControlReceiver.h"
+
+#include "NovaLinkUrl.h"
+
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace
+{
+    const FString DefaultControlUrl = TEXT("ws://localhost:5000/ws/control");
+}
+
+UControlReceiver::UControlReceiver()
+    : WebSocketUrl(DefaultControlUrl)
+    , NextTurnId(0)
+{
+    ServerStatus.State = TEXT("offline");
+}
+
+void UControlReceiver::StartConnection(const FString& OptionalOverrideUrl)
+{
+    FString TargetUrl = OptionalOverrideUrl.IsEmpty() ? WebSocketUrl : OptionalOverrideUrl;
+    TargetUrl = NovaLink::AppendQueryParameter(TargetUrl, TEXT("client_id"), ClientId);
+
+    Channel.Start(TargetUrl);
+}
+
+void UControlReceiver::StopConnection()
+{
+    Channel.Stop();
+}
+
+bool UControlReceiver::IsConnected() const
+{
+    return Channel.IsConnected();
+}
+
+bool UControlReceiver::IsServerReady() const
+{
+    return Channel.IsConnected() && ServerStatus.bIsReady;
+}
+
+FNovaLinkServerStatus UControlReceiver::GetServerStatus() const
+{
+    return ServerStatus;
+}
+
+int32 UControlReceiver::SubmitTurn(const FString& Text, const FString& AgentId, const FString& SessionId, const FString& Voice)
+{
+    const int32 TurnId = NextTurnId++;
+
+    TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
+    JsonObject->SetStringField(TEXT("type"), TEXT("turn"));
+    JsonObject->SetNumberField(TEXT("turn_id"), TurnId);
+    JsonObject->SetStringField(TEXT("text"), Text);
+    if (!AgentId.IsEmpty())
+    {
+        JsonObject->SetStringField(TEXT("agent_id"), AgentId);
+    }
+    if (!SessionId.IsEmpty())
+    {
+        JsonObject->SetStringField(TEXT("session_id"), SessionId);
+    }
+    if (!Voice.IsEmpty())
+    {
+        JsonObject->SetStringField(TEXT("voice"), Voice);
+    }
+
+    return SendJson(JsonObject) ? TurnId : INDEX_NONE;
+}
+
+void UControlReceiver::EndSession(const FString& SessionId)
+{
+    TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
+    JsonObject->SetStringField(TEXT("type"), TEXT("end_session"));
+    JsonObject->SetStringField(TEXT("session_id"), SessionId.IsEmpty() ? ClientId : SessionId);
+    SendJson(JsonObject);
+}
+
+void UControlReceiver::SendPing()
+{
+    if (!Channel.IsConnected())
+    {
+        return;
+    }
+    TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
+    JsonObject->SetStringField(TEXT("type"), TEXT("ping"));
+    JsonObject->SetNumberField(TEXT("t"), FPlatformTime::Seconds());
+    SendJson(JsonObject);
+}
+
+void UControlReceiver::SendAudioFeedback(const FNovaLinkAudioFeedback& Feedback)
+{
+    if (!Channel.IsConnected())
+    {
+        return;
+    }
+    TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
+    JsonObject->SetStringField(TEXT("type"), TEXT("feedback"));
+    JsonObject->SetNumberField(TEXT("receive_kbps"), Feedback.ReceiveKbps);
+    JsonObject->SetNumberField(TEXT("buffered_ms"), Feedback.BufferedMs);
+    JsonObject->SetNumberField(TEXT("underruns"), Feedback.Underruns);
+    JsonObject->SetNumberField(TEXT("lost_frames"), Feedback.LostFrames);
+    if (RoundTripMs > 0.0f)
+    {
+        JsonObject->SetNumberField(TEXT("rtt_ms"), RoundTripMs);
+    }
+    SendJson(JsonObject);
+}
+
+bool UControlReceiver::SendJson(const TSharedRef<FJsonObject>& JsonObject)
+{
+    if (!Channel.IsConnected())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("NovaLink ControlReceiver is not connected; dropping control message."));
+        return false;
+    }
+
+    FString Message;
+    TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Message);
+    FJsonSerializer::Serialize(JsonObject, Writer);
+    return Channel.Send(Message);
+}
+
+void UControlReceiver::HandleConnectionChanged(bool bConnected)
+{
+    OnConnectionStateChanged.Broadcast(bConnected);
+}
+
+bool FNovaLinkJsonDecodePolicy::Decode(const FString& Message, TSharedPtr<FJsonObject>& Out)
+{
+    TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Message);
+    if (!FJsonSerializer::Deserialize(Reader, Out) || !Out.IsValid())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("NovaLink ControlReceiver received invalid JSON: %s"), *Message);
+        return false;
+    }
+    return true;
+}
+
+void UControlReceiver::DeliverPayload(const TSharedPtr<FJsonObject>& JsonObject)
+{
+    const FString Type = JsonObject->GetStringField(TEXT("type"));
+    if (Type == TEXT("welcome"))
+    {
+        JsonObject->TryGetStringField(TEXT("client_id"), ClientId);
+    }
+    else if (Type == TEXT("turn_result"))
+    {
+        FNovaLinkTurnResult Result;
+        JsonObject->TryGetNumberField(TEXT("turn_id"), Result.TurnId);
+        JsonObject->TryGetStringField(TEXT("session_id"), Result.SessionId);
+        JsonObject->TryGetStringField(TEXT("agent_id"), Result.AgentId);
+        JsonObject->TryGetStringField(TEXT("emotion"), Result.Emotion);
+        JsonObject->TryGetStringField(TEXT("text"), Result.Text);
+        JsonObject->TryGetStringField(TEXT("error"), Result.Error);
+        OnTurnResult.Broadcast(Result);
+    }
+    else if (Type == TEXT("admission"))
+    {
+        FNovaLinkTurnAdmission Admission;
+        double EstimatedStartMs = 0.0;
+        double TurnMs = 0.0;
+        JsonObject->TryGetNumberField(TEXT("turn_id"), Admission.TurnId);
+        JsonObject->TryGetStringField(TEXT("session_id"), Admission.SessionId);
+        JsonObject->TryGetStringField(TEXT("agent_id"), Admission.AgentId);
+        JsonObject->TryGetBoolField(TEXT("admitted"), Admission.bAdmitted);
+        JsonObject->TryGetNumberField(TEXT("estimated_start_ms"), EstimatedStartMs);
+        JsonObject->TryGetNumberField(TEXT("queue_position"), Admission.QueuePosition);
+        JsonObject->TryGetNumberField(TEXT("turn_ms"), TurnMs);
+        JsonObject->TryGetStringField(TEXT("reason"), Admission.Reason);
+        Admission.EstimatedStartMs = static_cast<float>(EstimatedStartMs);
+        Admission.AverageTurnMs = static_cast<float>(TurnMs);
+        OnTurnAdmission.Broadcast(Admission);
+    }
+    else if (Type == TEXT("pong"))
+    {
+        double SentAt = 0.0;
+        if (JsonObject->TryGetNumberField(TEXT("t"), SentAt) && SentAt > 0.0)
+        {
+            const float SampleMs = static_cast<float>((FPlatformTime::Seconds() - SentAt) * 1000.0);
+            RoundTripMs = RoundTripMs > 0.0f ? RoundTripMs + 0.25f * (SampleMs - RoundTripMs) : SampleMs;
+        }
+    }
+    else if (Type == TEXT("bitrate"))
+    {
+        FString Rung;
+        double Kbps = 0.0;
+        JsonObject->TryGetStringField(TEXT("rung"), Rung);
+        JsonObject->TryGetNumberField(TEXT("kbps"), Kbps);
+        OnBitrateChanged.Broadcast(Rung, static_cast<float>(Kbps));
+    }
+    else if (Type == TEXT("status"))
+    {
+        ServerStatus.State = JsonObject->GetStringField(TEXT("state"));
+        ServerStatus.Detail.Reset();
+        JsonObject->TryGetStringField(TEXT("detail"), ServerStatus.Detail);
+        ServerStatus.bIsReady = ServerStatus.State == TEXT("ready");
+        OnServerStatusChanged.Broadcast(ServerStatus);
+    }
+}
@@ -1,8 +1,6 @@
 #include "EmotionReceiver.h"
 
-#include "IWebSocket.h"
-#include "Modules/ModuleManager.h"
-#include "WebSocketsModule.h"
+#include "NovaLinkUrl.h"
 
 #include "Dom/JsonObject.h"
 #include "Dom/JsonValue.h"
@@ -16,113 +14,48 @@ namespace
 
 UEmotionReceiver::UEmotionReceiver()
     : WebSocketUrl(DefaultEmotionUrl)
-    , bIsConnected(false)
 {
 }
 
 void UEmotionReceiver::StartConnection(const FString& OptionalOverrideUrl)
 {
     FString TargetUrl = OptionalOverrideUrl.IsEmpty() ? WebSocketUrl : OptionalOverrideUrl;
+    TargetUrl = NovaLink::AppendQueryParameter(TargetUrl, TEXT("agent_id"), AgentId);
 
-    if (TargetUrl.IsEmpty())
-    {
-        UE_LOG(LogTemp, Warning, TEXT("NovaLink EmotionReceiver requires a websocket URL."));
-        return;
-    }
-
-    StopConnection();
-
-    FWebSocketsModule* Module = FModuleManager::GetModulePtr<FWebSocketsModule>("WebSockets");
-    if (!Module)
-    {
-        Module = &FModuleManager::LoadModuleChecked<FWebSocketsModule>("WebSockets");
-    }
-
-    WebSocket = Module->CreateWebSocket(TargetUrl);
-
-    WebSocket->OnConnected().AddUObject(this, &UEmotionReceiver::HandleConnected);
-    WebSocket->OnConnectionError().AddUObject(this, &UEmotionReceiver::HandleConnectionError);
-    WebSocket->OnClosed().AddUObject(this, &UEmotionReceiver::HandleClosed);
-    WebSocket->OnMessage().AddUObject(this, &UEmotionReceiver::HandleMessage);
-
-    WebSocket->Connect();
+    Channel.Start(TargetUrl);
 }
 
 void UEmotionReceiver::StopConnection()
 {
-    if (WebSocket.IsValid())
-    {
-        WebSocket->OnConnected().RemoveAll(this);
-        WebSocket->OnConnectionError().RemoveAll(this);
-        WebSocket->OnClosed().RemoveAll(this);
-        WebSocket->OnMessage().RemoveAll(this);
-
-        if (WebSocket->IsConnected())
-        {
-            WebSocket->Close(1000, TEXT("EmotionReceiver Stop"));
-        }
-    }
-
-    ResetWebSocket();
+    Channel.Stop();
 }
 
 bool UEmotionReceiver::IsConnected() const
 {
-    return bIsConnected;
-}
-
-void UEmotionReceiver::HandleConnected()
-{
-    bIsConnected = true;
-    OnConnectionStateChanged.Broadcast(true);
+    return Channel.IsConnected();
 }
 
-void UEmotionReceiver::HandleConnectionError(const FString& Error)
+void UEmotionReceiver::HandleConnectionChanged(bool bConnected)
 {
-    UE_LOG(LogTemp, Error, TEXT("NovaLink EmotionReceiver connection error: %s"), *Error);
-    bIsConnected = false;
-    OnConnectionStateChanged.Broadcast(false);
-    ResetWebSocket();
+    OnConnectionStateChanged.Broadcast(bConnected);
 }
 
-void UEmotionReceiver::HandleClosed(int32 StatusCode, const FString& Reason, bool bWasClean)
+void UEmotionReceiver::DeliverPayload(const FNovaLinkEmotionData& EmotionData)
 {
-    bIsConnected = false;
-    OnConnectionStateChanged.Broadcast(false);
-    ResetWebSocket();
+    OnEmotionUpdate.Broadcast(EmotionData);
 }
 
-void UEmotionReceiver::HandleMessage(const FString& Message)
-{
-    TMap<FString, float> ParsedValues;
-    if (TryParseEmotionMessage(Message, ParsedValues))
-    {
-        OnEmotionUpdate.Broadcast(FNovaLinkEmotionData(ParsedValues));
-    }
-    else
-    {
-        UE_LOG(LogTemp, Warning, TEXT("NovaLink EmotionReceiver received invalid JSON: %s"), *Message);
-    }
-}
-
-void UEmotionReceiver::ResetWebSocket()
-{
-    if (WebSocket.IsValid())
-    {
-        WebSocket.Reset();
-    }
-    bIsConnected = false;
-}
-
-bool UEmotionReceiver::TryParseEmotionMessage(const FString& Message, TMap<FString, float>& OutValues)
+bool FNovaLinkEmotionDecodePolicy::Decode(const FString& Message, FNovaLinkEmotionData& Out)
 {
     TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Message);
     TSharedPtr<FJsonObject> JsonObject;
     if (!FJsonSerializer::Deserialize(Reader, JsonObject) || !JsonObject.IsValid())
     {
+        UE_LOG(LogTemp, Warning, TEXT("NovaLink EmotionReceiver received invalid JSON: %s"), *Message);
         return false;
     }
 
+    TMap<FString, float>& OutValues = Out.EmotionValues;
     OutValues.Reset();
     for (const auto& Pair : JsonObject->Values)
     {
@@ -146,5 +79,10 @@ bool UEmotionReceiver::TryParseEmotionMessage(const FString& Message, TMap<FStri
         }
     }
 
-    return OutValues.Num() > 0;
+    if (OutValues.Num() == 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("NovaLink EmotionReceiver received no emotion values: %s"), *Message);
+        return false;
+    }
+    return true;
 }
@@ -0,0 +1,24 @@
+#include "NovaLinkFillerBank.h"
+
+#include "Sound/SoundBase.h"
+
+USoundBase* UNovaLinkFillerBank::PickClip(const FString& Emotion, const USoundBase* Previous) const
+{
+    const FNovaLinkFillerClips* Set = ClipsByEmotion.Find(Emotion.ToLower());
+    if (!Set || Set->Clips.Num() == 0)
+    {
+        Set = ClipsByEmotion.Find(FallbackEmotion);
+    }
+    if (!Set || Set->Clips.Num() == 0)
+    {
+        return nullptr;
+    }
+
+    const int32 NumClips = Set->Clips.Num();
+    int32 Index = FMath::RandRange(0, NumClips - 1);
+    if (NumClips > 1 && Set->Clips[Index] == Previous)
+    {
+        Index = (Index + 1) % NumClips;
+    }
+    return Set->Clips[Index];
+}
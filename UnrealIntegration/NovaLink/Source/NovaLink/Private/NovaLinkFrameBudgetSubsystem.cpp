@@ -0,0 +1,132 @@
+#include "NovaLinkFrameBudgetSubsystem.h"
+
+#include "Engine/Engine.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/CoreDelegates.h"
+
+uint64 UNovaLinkFrameBudgetSubsystem::PendingCycles = 0;
+int32 FNovaLinkFrameCostScope::Depth = 0;
+
+namespace
+{
+    /** Frames between runs per shed level (rows) and work (columns); zero is off. */
+    constexpr int32 WorkIntervals[UNovaLinkFrameBudgetSubsystem::MaxShedLevel + 1][3] = {
+        // VisemeAnalysis, EmotionSmoothing, DebugTelemetry
+        {1, 1, 1},
+        {2, 2, 0},
+        {4, 4, 0},
+    };
+
+    constexpr float CostSmoothing = 0.1f;
+    constexpr uint64 DebugMessageKey = 0x4E4F5641;
+}
+
+UNovaLinkFrameBudgetSubsystem* UNovaLinkFrameBudgetSubsystem::Get()
+{
+    return GEngine ? GEngine->GetEngineSubsystem<UNovaLinkFrameBudgetSubsystem>() : nullptr;
+}
+
+bool UNovaLinkFrameBudgetSubsystem::ShouldRun(ENovaLinkOptionalWork Work)
+{
+    const UNovaLinkFrameBudgetSubsystem* Governor = Get();
+    return !Governor || Governor->ShouldRunOptionalWork(Work);
+}
+
+void UNovaLinkFrameBudgetSubsystem::AddFrameCost(uint64 Cycles)
+{
+    PendingCycles += Cycles;
+}
+
+void UNovaLinkFrameBudgetSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+    PendingCycles = 0;
+    EndFrameHandle = FCoreDelegates::OnEndFrame.AddUObject(this, &UNovaLinkFrameBudgetSubsystem::HandleEndFrame);
+}
+
+void UNovaLinkFrameBudgetSubsystem::Deinitialize()
+{
+    FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+    Super::Deinitialize();
+}
+
+int32 UNovaLinkFrameBudgetSubsystem::GetOptionalWorkInterval(ENovaLinkOptionalWork Work) const
+{
+    return WorkIntervals[ShedLevel][static_cast<int32>(Work)];
+}
+
+bool UNovaLinkFrameBudgetSubsystem::ShouldRunOptionalWork(ENovaLinkOptionalWork Work) const
+{
+    const int32 Interval = GetOptionalWorkInterval(Work);
+    if (Work == ENovaLinkOptionalWork::DebugTelemetry)
+    {
+        return Interval > 0;
+    }
+    // Stagger the kinds of work so shed levels spread them across frames instead of bunching them.
+    return Interval > 0 && (GFrameCounter + static_cast<uint64>(Work)) % Interval == 0;
+}
+
+void UNovaLinkFrameBudgetSubsystem::HandleEndFrame()
+{
+    const float CostMs = static_cast<float>(FPlatformTime::ToMilliseconds64(PendingCycles));
+    PendingCycles = 0;
+    AverageCostMs += CostSmoothing * (CostMs - AverageCostMs);
+
+    if (!bEnabled)
+    {
+        SetShedLevel(0);
+        return;
+    }
+
+    FramesOverBudget = CostMs > FrameBudgetMs ? FramesOverBudget + 1 : 0;
+    FramesWithHeadroom = AverageCostMs < FrameBudgetMs * RestoreRatio ? FramesWithHeadroom + 1 : 0;
+    if (FramesOverBudget >= FramesToShed && ShedLevel < MaxShedLevel)
+    {
+        SetShedLevel(ShedLevel + 1);
+    }
+    else if (FramesWithHeadroom >= FramesToRestore && ShedLevel > 0)
+    {
+        SetShedLevel(ShedLevel - 1);
+    }
+
+    if (bShowDebugStats && GEngine && ShouldRunOptionalWork(ENovaLinkOptionalWork::DebugTelemetry))
+    {
+        GEngine->AddOnScreenDebugMessage(DebugMessageKey, 0.0f, FColor::Cyan,
+            FString::Printf(TEXT("NovaLink %.3f ms / %.2f ms budget (avg %.3f ms), shed level %d"), CostMs, FrameBudgetMs, AverageCostMs, ShedLevel));
+    }
+}
+
+void UNovaLinkFrameBudgetSubsystem::SetShedLevel(int32 NewLevel)
+{
+    if (NewLevel != ShedLevel)
+    {
+        UE_LOG(LogTemp, Log, TEXT("NovaLink frame budget: shed level %d -> %d (avg %.3f ms, budget %.2f ms)."), ShedLevel, NewLevel, AverageCostMs, FrameBudgetMs);
+        ShedLevel = NewLevel;
+    }
+    // Each level change needs its own run of evidence.
+    FramesOverBudget = 0;
+    FramesWithHeadroom = 0;
+}
+
+FNovaLinkFrameCostScope::FNovaLinkFrameCostScope()
+{
+    // Render-thread and worker callbacks are outside the game-thread budget.
+    if (IsInGameThread() && Depth++ == 0)
+    {
+        bOutermost = true;
+        StartCycles = FPlatformTime::Cycles64();
+    }
+}
+
+FNovaLinkFrameCostScope::~FNovaLinkFrameCostScope()
+{
+    if (!IsInGameThread())
+    {
+        return;
+    }
+    --Depth;
+    if (bOutermost)
+    {
+        UNovaLinkFrameBudgetSubsystem::AddFrameCost(FPlatformTime::Cycles64() - StartCycles);
+    }
+}
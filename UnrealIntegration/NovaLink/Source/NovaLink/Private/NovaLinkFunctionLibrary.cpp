@@ -1,6 +1,7 @@
 #include "NovaLinkFunctionLibrary.h"
 
 #include "AudioReceiver.h"
+#include "ControlReceiver.h"
 #include "EmotionReceiver.h"
 #include "Engine/World.h"
 
@@ -24,19 +25,40 @@ UEmotionReceiver* UNovaLinkFunctionLibrary::CreateEmotionReceiver(UObject* World
     return NewObject<UEmotionReceiver>(WorldContextObject);
 }
 
-void UNovaLinkFunctionLibrary::ConnectAudio(UObject* WorldContextObject, UAudioReceiver*& OutReceiver, const FString& Url)
+UControlReceiver* UNovaLinkFunctionLibrary::CreateControlReceiver(UObject* WorldContextObject)
+{
+    if (!WorldContextObject)
+    {
+        return nullptr;
+    }
+
+    return NewObject<UControlReceiver>(WorldContextObject);
+}
+
+void UNovaLinkFunctionLibrary::ConnectAudio(UObject* WorldContextObject, UAudioReceiver*& OutReceiver, const FString& Url, const FString& AgentId)
 {
     OutReceiver = CreateAudioReceiver(WorldContextObject);
     if (OutReceiver)
     {
+        OutReceiver->AgentId = AgentId;
         OutReceiver->StartConnection(Url);
     }
 }
 
-void UNovaLinkFunctionLibrary::ConnectEmotion(UObject* WorldContextObject, UEmotionReceiver*& OutReceiver, const FString& Url)
+void UNovaLinkFunctionLibrary::ConnectEmotion(UObject* WorldContextObject, UEmotionReceiver*& OutReceiver, const FString& Url, const FString& AgentId)
 {
     OutReceiver = CreateEmotionReceiver(WorldContextObject);
     if (OutReceiver)
+    {
+        OutReceiver->AgentId = AgentId;
+        OutReceiver->StartConnection(Url);
+    }
+}
+
+void UNovaLinkFunctionLibrary::ConnectControl(UObject* WorldContextObject, UControlReceiver*& OutReceiver, const FString& Url)
+{
+    OutReceiver = CreateControlReceiver(WorldContextObject);
+    if (OutReceiver)
     {
         OutReceiver->StartConnection(Url);
     }
@@ -0,0 +1,158 @@
+#include "NovaLinkLipSyncSubsystem.h"
+
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "NovaLinkFrameBudgetSubsystem.h"
+#include "NovaLinkVoiceSlot.h"
+
+using NovaLink::Dsp::NumVisemes;
+
+static_assert(static_cast<int32>(ENovaLinkViseme::OU) + 1 == static_cast<int32>(NumVisemes), "ENovaLinkViseme must mirror EViseme");
+
+void UNovaLinkLipSyncSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+    Engine.Configure(0);
+}
+
+void UNovaLinkLipSyncSubsystem::QueuePhonemes(const FNovaLinkVoiceHandle& Voice, const TArray<FNovaLinkPhonemeTiming>& Phonemes, float StreamOffsetSeconds)
+{
+    if (!EnsureTrack(Voice))
+    {
+        return;
+    }
+
+    if (StreamOffsetSeconds < 0.0f)
+    {
+        const FNovaLinkVoiceSlot* Slot = GetPool()->FindSlot(Voice);
+        StreamOffsetSeconds = static_cast<float>(static_cast<double>(Slot->GetStreamSamplesReceived()) / Slot->GetOutputSampleRate());
+    }
+
+    for (const FNovaLinkPhonemeTiming& Timing : Phonemes)
+    {
+        const FTCHARToUTF8 Symbol(*Timing.Phoneme);
+        Engine.AppendSegment(
+            Voice.SlotIndex,
+            StreamOffsetSeconds + Timing.StartSeconds,
+            StreamOffsetSeconds + Timing.EndSeconds,
+            NovaLink::Dsp::VisemeForPhoneme(std::string_view(Symbol.Get(), Symbol.Length())));
+    }
+}
+
+void UNovaLinkLipSyncSubsystem::ClearPhonemes(const FNovaLinkVoiceHandle& Voice)
+{
+    if (TrackGenerations.IsValidIndex(Voice.SlotIndex) && TrackGenerations[Voice.SlotIndex] == Voice.Generation)
+    {
+        Engine.ClearTrack(Voice.SlotIndex);
+    }
+}
+
+TArray<float> UNovaLinkLipSyncSubsystem::GetVisemeWeights(const FNovaLinkVoiceHandle& Voice) const
+{
+    const float* VoiceWeights = FindVisemeWeights(Voice);
+    return VoiceWeights ? TArray<float>(VoiceWeights, NumVisemes) : TArray<float>();
+}
+
+float UNovaLinkLipSyncSubsystem::GetVisemeWeight(const FNovaLinkVoiceHandle& Voice, ENovaLinkViseme Viseme) const
+{
+    const float* VoiceWeights = FindVisemeWeights(Voice);
+    return VoiceWeights ? VoiceWeights[static_cast<int32>(Viseme)] : 0.0f;
+}
+
+const float* UNovaLinkLipSyncSubsystem::FindVisemeWeights(const FNovaLinkVoiceHandle& Voice) const
+{
+    if (!TrackGenerations.IsValidIndex(Voice.SlotIndex) || TrackGenerations[Voice.SlotIndex] != Voice.Generation)
+    {
+        return nullptr;
+    }
+    return Weights.GetData() + Voice.SlotIndex * NumVisemes;
+}
+
+void UNovaLinkLipSyncSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    // Under frame-budget pressure weights hold for a frame or three; mouths still close on time.
+    if (!UNovaLinkFrameBudgetSubsystem::ShouldRun(ENovaLinkOptionalWork::VisemeAnalysis))
+    {
+        return;
+    }
+    FNovaLinkFrameCostScope CostScope;
+
+    const UNovaLinkVoicePoolSubsystem* Pool = GetPool();
+    if (!Pool || TrackGenerations.Num() == 0)
+    {
+        return;
+    }
+
+    const float LatencySeconds = OutputLatencyMs * 0.001f;
+    for (int32 TrackIndex = 0; TrackIndex < TrackGenerations.Num(); ++TrackIndex)
+    {
+        FNovaLinkVoiceHandle Handle;
+        Handle.SlotIndex = TrackIndex;
+        Handle.Generation = TrackGenerations[TrackIndex];
+        FNovaLinkVoiceSlot* Slot = TrackGenerations[TrackIndex] != INDEX_NONE ? Pool->FindSlot(Handle) : nullptr;
+        if (!Slot)
+        {
+            if (TrackGenerations[TrackIndex] != INDEX_NONE)
+            {
+                // The voice was released: free the track for the slot's next lease.
+                TrackGenerations[TrackIndex] = INDEX_NONE;
+                Engine.ClearTrack(TrackIndex);
+            }
+            TrackTimes[TrackIndex] = -1.0f;
+            continue;
+        }
+        // Stream time, not buffer time: pauses the jitter buffer stretched or trimmed must not shift the visemes.
+        const double Played = static_cast<double>(Slot->GetStreamSamplesPlayed()) / Slot->GetOutputSampleRate();
+        TrackTimes[TrackIndex] = FMath::Max(0.0f, static_cast<float>(Played) - LatencySeconds);
+    }
+
+    Engine.Evaluate(TrackTimes.GetData(), Weights.GetData());
+}
+
+TStatId UNovaLinkLipSyncSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UNovaLinkLipSyncSubsystem, STATGROUP_Tickables);
+}
+
+UNovaLinkVoicePoolSubsystem* UNovaLinkLipSyncSubsystem::GetPool() const
+{
+    const UWorld* World = GetWorld();
+    const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+    return GameInstance ? GameInstance->GetSubsystem<UNovaLinkVoicePoolSubsystem>() : nullptr;
+}
+
+bool UNovaLinkLipSyncSubsystem::EnsureTrack(const FNovaLinkVoiceHandle& Voice)
+{
+    UNovaLinkVoicePoolSubsystem* Pool = GetPool();
+    if (!Pool || !Pool->FindSlot(Voice))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("NovaLink lip sync ignored phonemes for a stale voice handle."));
+        return false;
+    }
+
+    if (Voice.SlotIndex >= TrackGenerations.Num())
+    {
+        // Tracks follow the pool's slots; size them for the whole pool so growth stays rare.
+        const int32 OldNum = TrackGenerations.Num();
+        const int32 NumTracks = FMath::Max(Voice.SlotIndex + 1, Pool->GetNumActiveVoices() + Pool->GetNumFreeVoices());
+        Engine.SetNumTracks(NumTracks);
+        TrackGenerations.SetNum(NumTracks);
+        TrackTimes.SetNum(NumTracks);
+        Weights.SetNumZeroed(NumTracks * NumVisemes);
+        for (int32 TrackIndex = OldNum; TrackIndex < NumTracks; ++TrackIndex)
+        {
+            TrackGenerations[TrackIndex] = INDEX_NONE;
+            TrackTimes[TrackIndex] = -1.0f;
+            Weights[TrackIndex * NumVisemes + static_cast<int32>(ENovaLinkViseme::Sil)] = 1.0f;
+        }
+    }
+
+    if (TrackGenerations[Voice.SlotIndex] != Voice.Generation)
+    {
+        Engine.ClearTrack(Voice.SlotIndex);
+        TrackGenerations[Voice.SlotIndex] = Voice.Generation;
+    }
+    return true;
+}
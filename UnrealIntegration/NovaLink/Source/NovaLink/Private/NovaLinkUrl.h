@@ -0,0 +1,19 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenericPlatform/GenericPlatformHttp.h"
+
+namespace NovaLink
+{
+    /** Appends "key=value" to a websocket URL; empty values leave the URL untouched. */
+    inline FString AppendQueryParameter(const FString& Url, const TCHAR* Key, const FString& Value)
+    {
+        if (Value.IsEmpty())
+        {
+            return Url;
+        }
+
+        const TCHAR* Separator = Url.Contains(TEXT("?")) ? TEXT("&") : TEXT("?");
+        return FString::Printf(TEXT("%s%s%s=%s"), *Url, Separator, Key, *FGenericPlatformHttp::UrlEncode(Value));
+    }
+}
@@ -0,0 +1,239 @@
+#include "NovaLinkVoiceComponent.h"
+
+#include "Components/AudioComponent.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "NovaLinkFillerBank.h"
+#include "NovaLinkVoiceSlot.h"
+
+UNovaLinkVoiceComponent::UNovaLinkVoiceComponent(const FObjectInitializer& ObjectInitializer)
+    : Super(ObjectInitializer)
+{
+    NumChannels = 1;
+    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+bool UNovaLinkVoiceComponent::AttachVoice(const FNovaLinkVoiceHandle& Handle)
+{
+    const UWorld* World = GetWorld();
+    UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+    UNovaLinkVoicePoolSubsystem* Pool = GameInstance ? GameInstance->GetSubsystem<UNovaLinkVoicePoolSubsystem>() : nullptr;
+    FNovaLinkVoiceSlot* NewSlot = Pool ? Pool->FindSlot(Handle) : nullptr;
+    if (!NewSlot)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("NovaLinkVoiceComponent: cannot attach a stale voice handle."));
+        return false;
+    }
+
+    if (NewSlot->GetOutputSampleRate() != Pool->OutputSampleRate)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("NovaLinkVoiceComponent: slot rate %d differs from pool rate %d."), NewSlot->GetOutputSampleRate(), Pool->OutputSampleRate);
+    }
+
+    if (AttachedHandle.IsSet())
+    {
+        Pool->RemoveVoiceComponent(AttachedHandle, this);
+    }
+    {
+        FScopeLock Lock(&SlotLock);
+        Slot = NewSlot;
+    }
+    AttachedHandle = Handle;
+    Pool->AddVoiceComponent(Handle, this);
+
+    if (!IsActive())
+    {
+        Start();
+    }
+    return true;
+}
+
+void UNovaLinkVoiceComponent::DetachVoice()
+{
+    {
+        // Blocks until a render callback in progress is done with the slot.
+        FScopeLock Lock(&SlotLock);
+        Slot = nullptr;
+    }
+    const UWorld* World = GetWorld();
+    UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+    UNovaLinkVoicePoolSubsystem* Pool = GameInstance ? GameInstance->GetSubsystem<UNovaLinkVoicePoolSubsystem>() : nullptr;
+    if (Pool && AttachedHandle.IsSet())
+    {
+        Pool->RemoveVoiceComponent(AttachedHandle, this);
+    }
+    AttachedHandle = FNovaLinkVoiceHandle();
+    CancelFiller();
+}
+
+bool UNovaLinkVoiceComponent::BeginFiller(const FString& Emotion)
+{
+    if (!FillerBank || !Slot || Slot->GetBufferedSeconds() > 0.0f)
+    {
+        return false;
+    }
+
+    USoundBase* Clip = FillerBank->PickClip(Emotion, LastFillerClip);
+    if (!Clip)
+    {
+        return false;
+    }
+
+    UAudioComponent* Filler = GetOrCreateFillerAudio();
+    if (!Filler)
+    {
+        return false;
+    }
+
+    FillerRequestTime = FPlatformTime::Seconds();
+    // Speech samples only: a leading silence marker is not the voice arriving.
+    SamplesAtFillerRequest = Slot->GetSpeechSamplesReceived();
+    bAwaitingVoice = true;
+    bFillerAudible = false;
+    LastTimeToFillerMs = -1.0f;
+    LastTimeToVoiceMs = -1.0f;
+    LastFillerClip = Clip;
+
+    FadeInLength.store(FMath::RoundToInt(FillerCrossfadeMs * 0.001f * RenderSampleRate), std::memory_order_relaxed);
+    FadeInAfterSample.store(Slot->GetSamplesReceived(), std::memory_order_relaxed);
+    bFadeInNextVoice.store(true, std::memory_order_release);
+
+    Filler->SetSound(Clip);
+    Filler->Play();
+    SetComponentTickEnabled(true);
+    return true;
+}
+
+void UNovaLinkVoiceComponent::CancelFiller()
+{
+    bAwaitingVoice = false;
+    bFadeInNextVoice.store(false, std::memory_order_relaxed);
+    if (FillerAudio && FillerAudio->IsPlaying())
+    {
+        FillerAudio->FadeOut(FillerCrossfadeMs * 0.001f, 0.0f);
+    }
+    SetComponentTickEnabled(false);
+}
+
+void UNovaLinkVoiceComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    if (!bAwaitingVoice || !Slot || Slot->GetSpeechSamplesReceived() == SamplesAtFillerRequest)
+    {
+        return;
+    }
+
+    // The first chunk is in the jitter buffer: fade the filler out while the render thread fades the voice in.
+    bAwaitingVoice = false;
+    SetComponentTickEnabled(false);
+    if (FillerAudio && FillerAudio->IsPlaying())
+    {
+        FillerAudio->FadeOut(FillerCrossfadeMs * 0.001f, 0.0f);
+    }
+
+    LastTimeToVoiceMs = static_cast<float>((FPlatformTime::Seconds() - FillerRequestTime) * 1000.0);
+    UE_LOG(LogTemp, Verbose, TEXT("NovaLinkVoiceComponent: filler after %.1f ms, voice after %.1f ms."), LastTimeToFillerMs, LastTimeToVoiceMs);
+    OnFillerLatencyMeasured.Broadcast(LastTimeToFillerMs, LastTimeToVoiceMs);
+}
+
+UAudioComponent* UNovaLinkVoiceComponent::GetOrCreateFillerAudio()
+{
+    if (FillerAudio)
+    {
+        return FillerAudio;
+    }
+
+    FillerAudio = NewObject<UAudioComponent>(this, TEXT("NovaLinkFillerAudio"));
+    if (!FillerAudio)
+    {
+        return nullptr;
+    }
+    FillerAudio->bAutoActivate = false;
+    FillerAudio->bAutoDestroy = false;
+    // Sound from the same spot, with the same attenuation, as the voice it stands in for.
+    FillerAudio->bAllowSpatialization = bAllowSpatialization;
+    FillerAudio->AttenuationSettings = AttenuationSettings;
+    FillerAudio->bOverrideAttenuation = bOverrideAttenuation;
+    FillerAudio->AttenuationOverrides = AttenuationOverrides;
+    FillerAudio->SetupAttachment(this);
+    FillerAudio->OnAudioPlaybackPercentNative.AddUObject(this, &UNovaLinkVoiceComponent::HandleFillerPlayback);
+    FillerAudio->RegisterComponent();
+    return FillerAudio;
+}
+
+void UNovaLinkVoiceComponent::HandleFillerPlayback(const UAudioComponent* Component, const USoundWave* Wave, const float Percent)
+{
+    if (bFillerAudible || FillerRequestTime <= 0.0)
+    {
+        return;
+    }
+    bFillerAudible = true;
+    LastTimeToFillerMs = static_cast<float>((FPlatformTime::Seconds() - FillerRequestTime) * 1000.0);
+}
+
+bool UNovaLinkVoiceComponent::Init(int32& SampleRate)
+{
+    NumChannels = 1;
+    const UWorld* World = GetWorld();
+    const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+    if (const UNovaLinkVoicePoolSubsystem* Pool = GameInstance ? GameInstance->GetSubsystem<UNovaLinkVoicePoolSubsystem>() : nullptr)
+    {
+        // Slots already resample to this rate, so the mixer needs no further conversion.
+        SampleRate = Pool->OutputSampleRate;
+    }
+    RenderSampleRate = SampleRate;
+    return true;
+}
+
+int32 UNovaLinkVoiceComponent::OnGenerateAudio(float* OutAudio, int32 NumSamples)
+{
+    FScopeLock Lock(&SlotLock);
+    if (!Slot)
+    {
+        FMemory::Memzero(OutAudio, NumSamples * sizeof(float));
+        return NumSamples;
+    }
+
+    const int32 NumReal = Slot->RenderAudio(OutAudio, NumSamples);
+    if (NumReal > 0 && bFadeInNextVoice.load(std::memory_order_acquire) && IsSpeechPlaying()
+        && bFadeInNextVoice.exchange(false, std::memory_order_acquire))
+    {
+        FadeInPosition = 0;
+        bFadingIn = FadeInLength.load(std::memory_order_relaxed) > 0;
+    }
+    if (bFadingIn)
+    {
+        ApplyVoiceFadeIn(OutAudio, NumSamples);
+    }
+    return NumSamples;
+}
+
+bool UNovaLinkVoiceComponent::IsSpeechPlaying() const
+{
+    // Comfort noise for a silence marker renders as real audio; only a talk spurt that began after
+    // BeginFiller, and has started playing, ends the filler.
+    const uint64 SpeechStart = Slot->GetSpeechStartPosition();
+    return SpeechStart >= FadeInAfterSample.load(std::memory_order_relaxed) && Slot->GetSamplesPlayed() > SpeechStart;
+}
+
+void UNovaLinkVoiceComponent::ApplyVoiceFadeIn(float* OutAudio, int32 NumSamples)
+{
+    const int32 Length = FadeInLength.load(std::memory_order_relaxed);
+    for (int32 Index = 0; Index < NumSamples && FadeInPosition < Length; ++Index, ++FadeInPosition)
+    {
+        OutAudio[Index] *= static_cast<float>(FadeInPosition) / Length;
+    }
+    bFadingIn = FadeInPosition < Length;
+}
+
+void UNovaLinkVoiceComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    DetachVoice();
+    if (FillerAudio)
+    {
+        FillerAudio->Stop();
+    }
+    Super::EndPlay(EndPlayReason);
+}
@@ -0,0 +1,319 @@
+#include "NovaLinkVoicePoolSubsystem.h"
+
+#include "ControlReceiver.h"
+#include "NovaLinkFrameBudgetSubsystem.h"
+#include "NovaLinkVoiceComponent.h"
+
+void UNovaLinkVoicePoolSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+    Prewarm(InitialPoolSize);
+    FeedbackTicker = FTSTicker::GetCoreTicker().AddTicker(
+        FTickerDelegate::CreateUObject(this, &UNovaLinkVoicePoolSubsystem::TickFeedback), FeedbackIntervalSeconds);
+    LastFeedbackTime = FPlatformTime::Seconds();
+}
+
+void UNovaLinkVoicePoolSubsystem::Deinitialize()
+{
+    FTSTicker::GetCoreTicker().RemoveTicker(FeedbackTicker);
+    FeedbackChannel = nullptr;
+
+    for (UAudioReceiver* Receiver : Receivers)
+    {
+        if (Receiver)
+        {
+            Receiver->OnAudioFrameReceived.RemoveAll(this);
+            Receiver->StopConnection();
+        }
+    }
+    // DetachVoice calls back into RemoveVoiceComponent, so walk a detached copy.
+    const TMultiMap<int32, TWeakObjectPtr<UNovaLinkVoiceComponent>> Attached = MoveTemp(VoiceComponents);
+    VoiceComponents.Reset();
+    for (const TPair<int32, TWeakObjectPtr<UNovaLinkVoiceComponent>>& Entry : Attached)
+    {
+        if (UNovaLinkVoiceComponent* Component = Entry.Value.Get())
+        {
+            Component->DetachVoice();
+        }
+    }
+    Receivers.Reset();
+    Slots.Reset();
+    FreeSlots.Reset();
+    FeedbackSamples.Reset();
+
+    Super::Deinitialize();
+}
+
+void UNovaLinkVoicePoolSubsystem::Prewarm(int32 NumSlots)
+{
+    FreeSlots.Reserve(NumSlots);
+    while (Slots.Num() < NumSlots)
+    {
+        FreeSlots.Add(CreateSlot());
+    }
+}
+
+FNovaLinkVoiceHandle UNovaLinkVoicePoolSubsystem::AcquireVoice(const FString& AgentId, const FString& Url)
+{
+    const FString TargetUrl = Url.IsEmpty() ? DefaultAudioUrl : Url;
+
+    int32 SlotIndex = TakeFreeSlot(AgentId, TargetUrl);
+    if (SlotIndex == INDEX_NONE)
+    {
+        if (!bAllowGrowth)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("NovaLink voice pool exhausted (%d slots); cannot lease a voice for '%s'."), Slots.Num(), *AgentId);
+            return FNovaLinkVoiceHandle();
+        }
+        UE_LOG(LogTemp, Warning, TEXT("NovaLink voice pool grew to %d slots; raise InitialPoolSize to avoid runtime allocation."), Slots.Num() + 1);
+        SlotIndex = CreateSlot();
+    }
+
+    FNovaLinkVoiceSlot& Slot = *Slots[SlotIndex];
+    UAudioReceiver* Receiver = Receivers[SlotIndex];
+    const bool bReuseConnection = Receiver->IsConnected() && Slot.AgentId == AgentId && Slot.Url == TargetUrl;
+
+    Slot.Reset();
+    Slot.AgentId = AgentId;
+    Slot.Url = TargetUrl;
+    Slot.bInUse = true;
+
+    if (!bReuseConnection)
+    {
+        Receiver->AgentId = AgentId;
+        Receiver->bAdaptiveBitrate = bAdaptiveBitrate && FeedbackChannel && !FeedbackChannel->ClientId.IsEmpty();
+        Receiver->ClientId = Receiver->bAdaptiveBitrate ? FeedbackChannel->ClientId : FString();
+        Receiver->StartConnection(TargetUrl);
+    }
+
+    FNovaLinkVoiceHandle Handle;
+    Handle.SlotIndex = SlotIndex;
+    Handle.Generation = Slot.Generation;
+    return Handle;
+}
+
+void UNovaLinkVoicePoolSubsystem::ReleaseVoice(FNovaLinkVoiceHandle& Handle)
+{
+    FNovaLinkVoiceSlot* Slot = FindSlot(Handle);
+    if (!Slot)
+    {
+        Handle = FNovaLinkVoiceHandle();
+        return;
+    }
+
+    // DetachVoice waits for the component's render callback to leave the slot, so Reset() below
+    // cannot race the audio thread even if the caller forgot to detach.
+    TArray<TWeakObjectPtr<UNovaLinkVoiceComponent>> Attached;
+    VoiceComponents.MultiFind(Handle.SlotIndex, Attached);
+    for (const TWeakObjectPtr<UNovaLinkVoiceComponent>& Component : Attached)
+    {
+        if (Component.IsValid())
+        {
+            Component->DetachVoice();
+        }
+    }
+    VoiceComponents.Remove(Handle.SlotIndex);
+
+    Slot->bInUse = false;
+    ++Slot->Generation;
+    Slot->Reset();
+    if (!bKeepConnectionsWarm)
+    {
+        Receivers[Handle.SlotIndex]->StopConnection();
+    }
+    FreeSlots.Add(Handle.SlotIndex);
+    Handle = FNovaLinkVoiceHandle();
+}
+
+void UNovaLinkVoicePoolSubsystem::AddVoiceComponent(const FNovaLinkVoiceHandle& Handle, UNovaLinkVoiceComponent* Component)
+{
+    if (FindSlot(Handle) && Component)
+    {
+        VoiceComponents.AddUnique(Handle.SlotIndex, Component);
+    }
+}
+
+void UNovaLinkVoicePoolSubsystem::RemoveVoiceComponent(const FNovaLinkVoiceHandle& Handle, UNovaLinkVoiceComponent* Component)
+{
+    if (Handle.IsSet())
+    {
+        VoiceComponents.RemoveSingle(Handle.SlotIndex, Component);
+    }
+}
+
+bool UNovaLinkVoicePoolSubsystem::IsVoiceValid(const FNovaLinkVoiceHandle& Handle) const
+{
+    return FindSlot(Handle) != nullptr;
+}
+
+UAudioReceiver* UNovaLinkVoicePoolSubsystem::GetVoiceReceiver(const FNovaLinkVoiceHandle& Handle) const
+{
+    return FindSlot(Handle) ? Receivers[Handle.SlotIndex].Get() : nullptr;
+}
+
+float UNovaLinkVoicePoolSubsystem::GetVoiceEnvelope(const FNovaLinkVoiceHandle& Handle) const
+{
+    const FNovaLinkVoiceSlot* Slot = FindSlot(Handle);
+    return Slot ? Slot->GetEnvelope() : 0.0f;
+}
+
+float UNovaLinkVoicePoolSubsystem::GetVoiceBufferedSeconds(const FNovaLinkVoiceHandle& Handle) const
+{
+    const FNovaLinkVoiceSlot* Slot = FindSlot(Handle);
+    return Slot ? Slot->GetBufferedSeconds() : 0.0f;
+}
+
+float UNovaLinkVoicePoolSubsystem::GetVoiceConcealedSeconds(const FNovaLinkVoiceHandle& Handle) const
+{
+    const FNovaLinkVoiceSlot* Slot = FindSlot(Handle);
+    return Slot ? Slot->GetConcealedSeconds() : 0.0f;
+}
+
+int32 UNovaLinkVoicePoolSubsystem::GetNumActiveVoices() const
+{
+    return Slots.Num() - FreeSlots.Num();
+}
+
+void UNovaLinkVoicePoolSubsystem::SetFeedbackChannel(UControlReceiver* Control)
+{
+    FeedbackChannel = Control;
+    if (Control && Control->ClientId.IsEmpty())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("NovaLink voice pool feedback channel has no ClientId yet; voices keep a fixed bitrate until it connects."));
+    }
+}
+
+FNovaLinkVoiceSlot* UNovaLinkVoicePoolSubsystem::FindSlot(const FNovaLinkVoiceHandle& Handle) const
+{
+    if (!Slots.IsValidIndex(Handle.SlotIndex))
+    {
+        return nullptr;
+    }
+    FNovaLinkVoiceSlot* Slot = Slots[Handle.SlotIndex].Get();
+    return (Slot->bInUse && Slot->Generation == Handle.Generation) ? Slot : nullptr;
+}
+
+int32 UNovaLinkVoicePoolSubsystem::CreateSlot()
+{
+    FNovaLinkVoiceSlotSettings Settings;
+    Settings.SourceSampleRate = SourceSampleRate;
+    Settings.OutputSampleRate = OutputSampleRate;
+    Settings.BufferSeconds = BufferSeconds;
+    Settings.TargetLatencyMs = JitterBufferMs;
+    Settings.MaxConcealMs = MaxConcealMs;
+    Settings.Concealment.ComfortNoiseLevel = ComfortNoiseLevel;
+
+    TUniquePtr<FNovaLinkVoiceSlot> Slot = MakeUnique<FNovaLinkVoiceSlot>();
+    Slot->Initialize(Settings);
+    const int32 SlotIndex = Slots.Add(MoveTemp(Slot));
+
+    UAudioReceiver* Receiver = NewObject<UAudioReceiver>(this);
+    Receiver->FrameMs = FrameMs;
+    Receiver->MaxLatencyMs = MaxLatencyMs;
+    Receiver->bFramedAudio = true;
+    Receiver->bSilenceSuppression = bSilenceSuppression;
+    Receiver->OnAudioFrameReceived.AddUObject(this, &UNovaLinkVoicePoolSubsystem::HandleSlotAudio, SlotIndex);
+    Receivers.Add(Receiver);
+    FeedbackSamples.AddDefaulted();
+    return SlotIndex;
+}
+
+int32 UNovaLinkVoicePoolSubsystem::TakeFreeSlot(const FString& AgentId, const FString& Url)
+{
+    if (FreeSlots.Num() == 0)
+    {
+        return INDEX_NONE;
+    }
+
+    // Prefer the slot this agent used last: its subscription may still be live.
+    int32 FreeIndex = FreeSlots.Num() - 1;
+    for (int32 Index = FreeSlots.Num() - 1; Index >= 0; --Index)
+    {
+        const FNovaLinkVoiceSlot& Slot = *Slots[FreeSlots[Index]];
+        if (Slot.AgentId == AgentId && Slot.Url == Url)
+        {
+            FreeIndex = Index;
+            break;
+        }
+    }
+
+    const int32 SlotIndex = FreeSlots[FreeIndex];
+    FreeSlots.RemoveAtSwap(FreeIndex, 1, EAllowShrinking::No);
+    return SlotIndex;
+}
+
+bool UNovaLinkVoicePoolSubsystem::TickFeedback(float DeltaTime)
+{
+    FNovaLinkFrameCostScope CostScope;
+    const double Now = FPlatformTime::Seconds();
+    const double Elapsed = Now - LastFeedbackTime;
+    LastFeedbackTime = Now;
+    if (!FeedbackChannel || !FeedbackChannel->IsConnected())
+    {
+        return true;
+    }
+
+    uint64 NewBytes = 0;
+    float MinBufferedMs = TNumericLimits<float>::Max();
+    for (int32 SlotIndex = 0; SlotIndex < Slots.Num(); ++SlotIndex)
+    {
+        const FNovaLinkVoiceSlot& Slot = *Slots[SlotIndex];
+        const UAudioReceiver* Receiver = Receivers[SlotIndex];
+        FFeedbackSample& Last = FeedbackSamples[SlotIndex];
+
+        // Counters restart on reconnect and release, so a smaller value is a fresh total.
+        const uint64 Bytes = Receiver->GetBytesReceived();
+        const uint32 Underruns = Slot.GetUnderrunCount();
+        const int32 LostFrames = Receiver->GetLostFrameCount();
+        NewBytes += Bytes >= Last.BytesReceived ? Bytes - Last.BytesReceived : Bytes;
+        TotalUnderruns += static_cast<int32>(Underruns >= Last.Underruns ? Underruns - Last.Underruns : Underruns);
+        TotalLostFrames += LostFrames >= Last.LostFrames ? LostFrames - Last.LostFrames : LostFrames;
+        Last = {Bytes, Underruns, LostFrames};
+
+        if (Slot.bInUse && Receiver->bAdaptiveBitrate)
+        {
+            MinBufferedMs = FMath::Min(MinBufferedMs, Slot.GetBufferedSeconds() * 1000.0f);
+        }
+    }
+    if (MinBufferedMs == TNumericLimits<float>::Max())
+    {
+        // No adaptive voices are playing; nothing to report.
+        return true;
+    }
+
+    FNovaLinkAudioFeedback Feedback;
+    Feedback.ReceiveKbps = Elapsed > 0.0 ? static_cast<float>(NewBytes * 8 / 1000.0 / Elapsed) : 0.0f;
+    Feedback.BufferedMs = MinBufferedMs;
+    Feedback.Underruns = TotalUnderruns;
+    Feedback.LostFrames = TotalLostFrames;
+    FeedbackChannel->SendPing();
+    FeedbackChannel->SendAudioFeedback(Feedback);
+    return true;
+}
+
+void UNovaLinkVoicePoolSubsystem::HandleSlotAudio(const FNovaLinkAudioFrameInfo& Info, const uint8* Payload, int32 Size, int32 SlotIndex)
+{
+    FNovaLinkVoiceSlot& Slot = *Slots[SlotIndex];
+    if (!Slot.bInUse)
+    {
+        // Warm but unleased subscription: nobody is listening.
+        return;
+    }
+
+    Slot.SetSourceSampleRate(Info.SampleRate);
+    if (Info.NumLostBefore > 0)
+    {
+        // Frames share one duration, so the gap is as long as this frame times the count.
+        Slot.MarkLost(static_cast<int32>(FMath::Min<int64>(static_cast<int64>(Info.NumLostBefore) * Info.SampleCount, MAX_int32)));
+    }
+    if (Info.Codec == static_cast<uint8>(NovaLink::Dsp::EFrameCodec::Silence))
+    {
+        Slot.PushSilence(Info.SampleCount);
+        return;
+    }
+    const int32 Dropped = Slot.PushFrame(static_cast<NovaLink::Dsp::EFrameCodec>(Info.Codec), Payload, Size);
+    if (Dropped > 0)
+    {
+        UE_LOG(LogTemp, Verbose, TEXT("NovaLink voice '%s' overflowed; dropped %d samples."), *Slot.AgentId, Dropped);
+    }
+}
@@ -0,0 +1,145 @@
+#include "NovaLinkVoiceSlot.h"
+
+#include "Core/PcmConvert.h"
+
+void FNovaLinkVoiceSlot::Initialize(const FNovaLinkVoiceSlotSettings& InSettings)
+{
+    Settings = InSettings;
+
+    NovaLink::Dsp::FJitterBufferSettings BufferSettings;
+    BufferSettings.SampleRate = Settings.OutputSampleRate;
+    BufferSettings.CapacitySeconds = Settings.BufferSeconds;
+    BufferSettings.TargetLatencyMs = Settings.TargetLatencyMs;
+    BufferSettings.MaxLatencyMs = Settings.MaxLatencyMs;
+    BufferSettings.MaxConcealMs = Settings.MaxConcealMs;
+    BufferSettings.Concealment = Settings.Concealment;
+    Buffer.Configure(BufferSettings);
+
+    Resampler.SetRates(Settings.SourceSampleRate, Settings.OutputSampleRate);
+    Analyzer.Configure(Settings.OutputSampleRate);
+    DecodeScratch.Reset();
+    ResampleScratch.Reset();
+    GrowScratch(Settings.MaxChunkSamples);
+    Reset();
+}
+
+void FNovaLinkVoiceSlot::Reset()
+{
+    Buffer.Reset();
+    Resampler.Reset();
+    Analyzer.Reset();
+}
+
+int32 FNovaLinkVoiceSlot::PushPcm16(const uint8* Data, int32 NumBytes)
+{
+    return PushFrame(NovaLink::Dsp::EFrameCodec::Pcm16, Data, NumBytes);
+}
+
+int32 FNovaLinkVoiceSlot::PushFrame(NovaLink::Dsp::EFrameCodec Codec, const uint8* Data, int32 NumBytes)
+{
+    const bool bMuLaw = Codec == NovaLink::Dsp::EFrameCodec::MuLaw;
+    const int32 NumSourceSamples = bMuLaw ? NumBytes : NumBytes / 2;
+    if (!Data || NumSourceSamples <= 0)
+    {
+        return 0;
+    }
+
+    // Only an unexpectedly large chunk reallocates; steady-state traffic reuses the scratch buffers.
+    GrowScratch(NumSourceSamples);
+
+    if (bMuLaw)
+    {
+        NovaLink::Dsp::ConvertMuLawToFloat(Data, static_cast<std::size_t>(NumSourceSamples), DecodeScratch.GetData());
+    }
+    else
+    {
+        NovaLink::Dsp::ConvertPcm16ToFloat(Data, static_cast<std::size_t>(NumSourceSamples) * 2, DecodeScratch.GetData());
+    }
+    const std::size_t NumOutput = Resampler.Process(
+        DecodeScratch.GetData(), NumSourceSamples, ResampleScratch.GetData(), ResampleScratch.Num());
+
+    Analyzer.Process(ResampleScratch.GetData(), NumOutput);
+    const std::size_t NumWritten = Buffer.Write(ResampleScratch.GetData(), NumOutput);
+    return static_cast<int32>(NumOutput - NumWritten);
+}
+
+void FNovaLinkVoiceSlot::PushSilence(int32 NumSourceSamples)
+{
+    if (NumSourceSamples <= 0 || Settings.SourceSampleRate <= 0)
+    {
+        return;
+    }
+
+    const int64 NumOutput = static_cast<int64>(NumSourceSamples) * Settings.OutputSampleRate / Settings.SourceSampleRate;
+    // The next frame interpolates from silence, not from the last sample before the pause.
+    Resampler.Reset();
+    Analyzer.ProcessSilence(static_cast<std::size_t>(NumOutput));
+    Buffer.WriteSilence(static_cast<std::size_t>(NumOutput));
+}
+
+void FNovaLinkVoiceSlot::MarkLost(int32 NumSourceSamples)
+{
+    if (NumSourceSamples <= 0 || Settings.SourceSampleRate <= 0)
+    {
+        return;
+    }
+
+    const int64 NumOutput = static_cast<int64>(NumSourceSamples) * Settings.OutputSampleRate / Settings.SourceSampleRate;
+    if (!Buffer.MarkLost(static_cast<std::size_t>(NumOutput)))
+    {
+        UE_LOG(LogTemp, Verbose, TEXT("NovaLink voice '%s' has too many pending gaps; playing one as silence."), *AgentId);
+    }
+}
+
+void FNovaLinkVoiceSlot::SetSourceSampleRate(int32 SampleRate)
+{
+    if (SampleRate <= 0 || SampleRate == Settings.SourceSampleRate)
+    {
+        return;
+    }
+    Settings.SourceSampleRate = SampleRate;
+    Resampler.SetRates(Settings.SourceSampleRate, Settings.OutputSampleRate);
+}
+
+int32 FNovaLinkVoiceSlot::RenderAudio(float* Out, int32 NumSamples)
+{
+    if (!Out || NumSamples <= 0)
+    {
+        return 0;
+    }
+    return static_cast<int32>(Buffer.Render(Out, static_cast<std::size_t>(NumSamples)));
+}
+
+int32 FNovaLinkVoiceSlot::ReadAudio(float* Out, int32 NumSamples)
+{
+    if (!Out || NumSamples <= 0)
+    {
+        return 0;
+    }
+    return static_cast<int32>(Buffer.Read(Out, NumSamples));
+}
+
+float FNovaLinkVoiceSlot::GetBufferedSeconds() const
+{
+    return Settings.OutputSampleRate > 0 ? static_cast<float>(Buffer.NumBuffered()) / Settings.OutputSampleRate : 0.0f;
+}
+
+float FNovaLinkVoiceSlot::GetConcealedSeconds() const
+{
+    return Settings.OutputSampleRate > 0
+        ? static_cast<float>(Buffer.GetConcealedSamples()) / Settings.OutputSampleRate
+        : 0.0f;
+}
+
+void FNovaLinkVoiceSlot::GrowScratch(int32 NumSourceSamples)
+{
+    if (DecodeScratch.Num() < NumSourceSamples)
+    {
+        DecodeScratch.SetNumUninitialized(NumSourceSamples);
+    }
+    const int32 NumOutput = static_cast<int32>(Resampler.MaxOutputFor(NumSourceSamples));
+    if (ResampleScratch.Num() < NumOutput)
+    {
+        ResampleScratch.SetNumUninitialized(NumOutput);
+    }
+}
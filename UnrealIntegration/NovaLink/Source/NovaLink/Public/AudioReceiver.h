@@ -1,12 +1,129 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Core/FrameHeader.h"
+#include "NovaLinkChannel.h"
 #include "AudioReceiver.generated.h"
 
-class IWebSocket;
-
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FNovaLinkAudioChunkReceived, const TArray<uint8>&, AudioChunk);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FNovaLinkConnectionStateChanged, bool, bIsConnected);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FNovaLinkRawAudioReceived, const uint8* /*Data*/, int32 /*Size*/);
+
+/** Metadata of one framed audio packet (see Core/FrameHeader.h). */
+struct FNovaLinkAudioFrameInfo
+{
+    uint32 Sequence = 0;
+    int32 SampleRate = 0;
+    int32 SampleCount = 0;
+    uint8 Codec = 0;
+
+    /** Frames missing between the previous packet and this one. */
+    int32 NumLostBefore = 0;
+};
+
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FNovaLinkAudioFrameReceived, const FNovaLinkAudioFrameInfo& /*Info*/, const uint8* /*Payload*/, int32 /*Size*/);
+
+/** One audio message after header parsing. Data points into the websocket buffer and is only valid during delivery. */
+struct FNovaLinkAudioPayload
+{
+    FNovaLinkAudioFrameInfo Info;
+    bool bFramed = false;
+    const uint8* Data = nullptr;
+    int32 Size = 0;
+};
+
+/** Decode policy of the audio channel: frame headers, sequence gaps and arrival traces. */
+struct NOVALINK_API FNovaLinkAudioDecodePolicy
+{
+    static constexpr bool bBinaryMessages = true;
+
+    /** Messages carry the 16-byte frame header; set before connecting. */
+    bool bFramed = false;
+
+    /** Frames with a higher (or zero) header sample rate are dropped. */
+    static constexpr uint32 MaxSampleRate = 192000;
+
+    /**
+     * Longest duration a header may claim. Silence markers size buffers from their sample count, so
+     * longer claims are clamped before anything allocates.
+     */
+    static constexpr uint32 MaxFrameSeconds = 5;
+
+    uint32 ExpectedSequence = 0;
+    bool bHasSequence = false;
+    int32 LostFrameCount = 0;
+    uint64 BytesReceived = 0;
+
+    bool bRecordingTrace = false;
+    double TraceStartSeconds = 0.0;
+    FString ArrivalTrace;
+
+    void Reset()
+    {
+        bHasSequence = false;
+        LostFrameCount = 0;
+        BytesReceived = 0;
+    }
+
+    FORCEINLINE bool Decode(const uint8* Data, int32 Size, FNovaLinkAudioPayload& Out)
+    {
+        BytesReceived += static_cast<uint64>(Size);
+        Out.Data = Data;
+        Out.Size = Size;
+        Out.bFramed = bFramed;
+        if (!bFramed)
+        {
+            return true;
+        }
+
+        NovaLink::Dsp::FFrameHeader Header;
+        if (!NovaLink::Dsp::ParseFrameHeader(Data, Size, Header))
+        {
+            UE_LOG(LogTemp, Warning, TEXT("NovaLink AudioReceiver dropped a message without a valid frame header (%d bytes)."), Size);
+            return false;
+        }
+
+        if (Header.SampleRate == 0 || Header.SampleRate > MaxSampleRate)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("NovaLink AudioReceiver dropped a frame with sample rate %u."), Header.SampleRate);
+            return false;
+        }
+        const uint32 MaxSampleCount = Header.SampleRate * MaxFrameSeconds;
+        if (Header.SampleCount > MaxSampleCount)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("NovaLink AudioReceiver clamped a frame of %u samples to %u."), Header.SampleCount, MaxSampleCount);
+            Header.SampleCount = MaxSampleCount;
+        }
+
+        Out.Info.Sequence = Header.Sequence;
+        Out.Info.SampleRate = static_cast<int32>(Header.SampleRate);
+        Out.Info.SampleCount = static_cast<int32>(Header.SampleCount);
+        Out.Info.Codec = static_cast<uint8>(Header.Codec);
+        if (bHasSequence && Header.Sequence != ExpectedSequence)
+        {
+            // Unsigned arithmetic handles wrap-around; late or duplicate frames count as no loss.
+            const uint32 Gap = Header.Sequence - ExpectedSequence;
+            Out.Info.NumLostBefore = Gap < 0x80000000u ? static_cast<int32>(Gap) : 0;
+            LostFrameCount += Out.Info.NumLostBefore;
+        }
+        ExpectedSequence = Header.Sequence + 1;
+        bHasSequence = true;
+
+        if (bRecordingTrace)
+        {
+            RecordArrival(Out.Info);
+        }
+
+        Out.Data = Data + NovaLink::Dsp::FFrameHeader::Size;
+        Out.Size = Size - static_cast<int32>(NovaLink::Dsp::FFrameHeader::Size);
+        return true;
+    }
+
+    void RecordArrival(const FNovaLinkAudioFrameInfo& Info);
+};
+
+class UAudioReceiver;
+using FNovaLinkAudioChannel = TNovaLinkChannel<FNovaLinkAudioPayload, FNovaLinkAudioDecodePolicy, FNovaLinkImmediateQueue, TNovaLinkOwnerDelivery<UAudioReceiver>>;
 
 UCLASS(BlueprintType)
 class NOVALINK_API UAudioReceiver : public UObject
@@ -20,10 +137,64 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Audio")
     FString WebSocketUrl;
 
+    /** Agent whose audio stream to follow; sent as the agent_id query parameter. Empty follows the server default agent. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Audio")
+    FString AgentId;
+
+    /**
+     * Target duration of each audio message, negotiated with the server as frame_ms. Zero keeps the
+     * legacy behaviour of one message per synthesised chunk.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Audio", meta = (ClampMin = "0"))
+    int32 FrameMs = 0;
+
+    /** Longest the server may hold a partial frame, sent as max_latency_ms. Zero uses the server default. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Audio", meta = (ClampMin = "0"))
+    int32 MaxLatencyMs = 0;
+
+    /** Ask for the 16-byte frame header (sequence, sample rate, sample count). Chunk delegates still receive PCM only. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Audio")
+    bool bFramedAudio = false;
+
+    /**
+     * Let the server adapt codec, sample rate and frame duration to the link (implies framed audio).
+     * Needs ClientId: the server reads this stream's link feedback from that control client.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Audio")
+    bool bAdaptiveBitrate = false;
+
+    /**
+     * Ask the server to send silent frames as header-only silence markers (dtx=1, implies framed
+     * audio). The chunk delegates still receive PCM16: markers are expanded here, see ComfortNoiseLevel.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Audio")
+    bool bSilenceSuppression = false;
+
+    /** Amplitude of the noise silence markers expand to for the chunk delegates; 0 gives digital silence. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Audio", meta = (ClampMin = "0.0", ClampMax = "0.1"))
+    float ComfortNoiseLevel = 0.0f;
+
+    /** Control client (UControlReceiver::ClientId) that reports feedback for this stream. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Audio")
+    FString ClientId;
+
     /** Invoked whenever a binary audio chunk is received from the websocket. */
     UPROPERTY(BlueprintAssignable, Category = "NovaLink|Audio")
     FNovaLinkAudioChunkReceived OnAudioChunkReceived;
 
+    /**
+     * Native counterpart of OnAudioChunkReceived that hands out the websocket buffer without copying it.
+     * The data is only valid during the callback. When no Blueprint delegate is bound, no TArray is built.
+     */
+    FNovaLinkRawAudioReceived OnRawAudioReceived;
+
+    /**
+     * Native per-frame callback with header metadata and the payload in Info.Codec; only fires with
+     * framed audio. Silence markers arrive with an empty payload and Info.SampleCount samples of
+     * silence. The chunk delegates above always receive PCM16.
+     */
+    FNovaLinkAudioFrameReceived OnAudioFrameReceived;
+
     /** Broadcasts whenever the websocket connection opens or closes. */
     UPROPERTY(BlueprintAssignable, Category = "NovaLink|Audio")
     FNovaLinkConnectionStateChanged OnConnectionStateChanged;
@@ -40,14 +211,43 @@ public:
     UFUNCTION(BlueprintPure, Category = "NovaLink|Audio")
     bool IsConnected() const;
 
+    /** Frames detected as missing from sequence gaps since the connection opened (framed audio only). */
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Audio")
+    int32 GetLostFrameCount() const { return Channel.GetDecoder().LostFrameCount; }
+
+    /** Audio payload bytes received since the connection opened; sampled for receive-rate feedback. */
+    uint64 GetBytesReceived() const { return Channel.GetDecoder().BytesReceived; }
+
+    /**
+     * Records the arrival time of every framed packet until StopArrivalTrace(), for replay in the
+     * JitterSim tool (Tools/JitterSim). Only framed audio carries the metadata a trace needs.
+     */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|Audio")
+    void StartArrivalTrace();
+
+    /** Writes the recorded trace as CSV to FilePath; returns false if no trace was running or the write failed. */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|Audio")
+    bool StopArrivalTrace(const FString& FilePath);
+
 private:
-    void HandleConnected();
-    void HandleConnectionError(const FString& Error);
-    void HandleClosed(int32 StatusCode, const FString& Reason, bool bWasClean);
-    void HandleBinaryMessage(const void* Data, SIZE_T Size, SIZE_T BytesRemaining);
+    friend struct TNovaLinkOwnerDelivery<UAudioReceiver>;
+
+    void DeliverPayload(const FNovaLinkAudioPayload& Payload);
+    void HandleConnectionChanged(bool bConnected);
+
+    /** Whether StartConnection asks for framed audio, either directly or for a feature that implies it. */
+    bool UsesFramedAudio() const
+    {
+        return bFramedAudio || (bAdaptiveBitrate && !ClientId.IsEmpty()) || bSilenceSuppression;
+    }
+
+    FNovaLinkAudioChannel Channel{TEXT("AudioReceiver"), this};
+
+    /** Writes NumSamples of PCM16 silence (or comfort noise) into DecodedPayload; the decode policy bounds NumSamples. */
+    void ExpandSilence(int32 NumSamples);
 
-    void ResetWebSocket();
+    /** PCM16 expansion of compressed frames and silence markers for the chunk delegates. */
+    TArray<uint8> DecodedPayload;
 
-    TSharedPtr<IWebSocket> WebSocket;
-    bool bIsConnected;
+    uint32 NoiseState = 22222u;
 };
@@ -0,0 +1,232 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NovaLinkChannel.h"
+#include "ControlReceiver.generated.h"
+
+class FJsonObject;
+
+USTRUCT(BlueprintType)
+struct NOVALINK_API FNovaLinkServerStatus
+{
+    GENERATED_BODY()
+
+    /** Server lifecycle state: offline, loading, warming, ready or error. */
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Control")
+    FString State;
+
+    /** Optional human readable detail (e.g. the load error). */
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Control")
+    FString Detail;
+
+    /** True once the server has loaded and warmed its models. */
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Control")
+    bool bIsReady = false;
+};
+
+USTRUCT(BlueprintType)
+struct NOVALINK_API FNovaLinkTurnResult
+{
+    GENERATED_BODY()
+
+    /** Id returned by SubmitTurn for the turn this result answers. */
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Control")
+    int32 TurnId = INDEX_NONE;
+
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Control")
+    FString SessionId;
+
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Control")
+    FString AgentId;
+
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Control")
+    FString Emotion;
+
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Control")
+    FString Text;
+
+    /** Non-empty when the server failed to process the turn. */
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Control")
+    FString Error;
+};
+
+/**
+ * Immediate answer to SubmitTurn, sent before any audio: either the turn was queued with an estimated
+ * start, or the server is saturated and rejected it (a turn result with the same error follows).
+ */
+USTRUCT(BlueprintType)
+struct NOVALINK_API FNovaLinkTurnAdmission
+{
+    GENERATED_BODY()
+
+    /** Id returned by SubmitTurn for the turn this answers. */
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Control")
+    int32 TurnId = INDEX_NONE;
+
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Control")
+    FString SessionId;
+
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Control")
+    FString AgentId;
+
+    /** False when the server rejected the turn; play a canned line or try another server. */
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Control")
+    bool bAdmitted = false;
+
+    /** Server estimate of the wait before the turn starts; long waits are worth covering with filler. */
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Control")
+    float EstimatedStartMs = 0.0f;
+
+    /** Turns queued ahead of this one. */
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Control")
+    int32 QueuePosition = 0;
+
+    /** Average turn duration the estimate is based on. */
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Control")
+    float AverageTurnMs = 0.0f;
+
+    /** Why a turn was rejected: "busy" (the wait would be too long) or "queue full". */
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Control")
+    FString Reason;
+};
+
+/** Link quality report the server's adaptive bitrate controller works from. */
+USTRUCT(BlueprintType)
+struct NOVALINK_API FNovaLinkAudioFeedback
+{
+    GENERATED_BODY()
+
+    /** Audio received over the last report interval, in kilobits per second. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Control")
+    float ReceiveKbps = 0.0f;
+
+    /** Audio waiting in the jitter buffer; the smallest across streams when several share the link. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Control")
+    float BufferedMs = 0.0f;
+
+    /** Running total of playback underruns. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Control")
+    int32 Underruns = 0;
+
+    /** Running total of frames lost in transit. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Control")
+    int32 LostFrames = 0;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FNovaLinkServerStatusChanged, const FNovaLinkServerStatus&, Status);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FNovaLinkTurnResultReceived, const FNovaLinkTurnResult&, Result);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FNovaLinkTurnAdmissionReceived, const FNovaLinkTurnAdmission&, Admission);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FNovaLinkControlConnectionStateChanged, bool, bIsConnected);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FNovaLinkBitrateChanged, const FString&, Rung, float, Kbps);
+
+/** Decode policy of the control channel: one JSON object per message, dispatched on its "type" field. */
+struct NOVALINK_API FNovaLinkJsonDecodePolicy
+{
+    static constexpr bool bBinaryMessages = false;
+
+    bool Decode(const FString& Message, TSharedPtr<FJsonObject>& Out);
+    void Reset() {}
+};
+
+class UControlReceiver;
+using FNovaLinkControlChannel = TNovaLinkChannel<TSharedPtr<FJsonObject>, FNovaLinkJsonDecodePolicy, FNovaLinkImmediateQueue, TNovaLinkOwnerDelivery<UControlReceiver>>;
+
+UCLASS(BlueprintType)
+class NOVALINK_API UControlReceiver : public UObject
+{
+    GENERATED_BODY()
+
+public:
+    UControlReceiver();
+
+    /** Default websocket URL used if none is provided when starting the connection. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Control")
+    FString WebSocketUrl;
+
+    /**
+     * Identifies this client to the server. Leave empty to let the server assign one;
+     * it is filled in from the server's welcome message and reused on reconnect.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Control")
+    FString ClientId;
+
+    /** Invoked whenever the server announces a new status. */
+    UPROPERTY(BlueprintAssignable, Category = "NovaLink|Control")
+    FNovaLinkServerStatusChanged OnServerStatusChanged;
+
+    /**
+     * Invoked as soon as the server has admitted or rejected a turn submitted by this client, with the
+     * estimated wait; use it to start filler or fall back without waiting for audio.
+     */
+    UPROPERTY(BlueprintAssignable, Category = "NovaLink|Control")
+    FNovaLinkTurnAdmissionReceived OnTurnAdmission;
+
+    /** Invoked when the server finished (or failed) a turn submitted by this client. */
+    UPROPERTY(BlueprintAssignable, Category = "NovaLink|Control")
+    FNovaLinkTurnResultReceived OnTurnResult;
+
+    /** Broadcasts whenever the websocket connection opens or closes. */
+    UPROPERTY(BlueprintAssignable, Category = "NovaLink|Control")
+    FNovaLinkControlConnectionStateChanged OnConnectionStateChanged;
+
+    /** Invoked when the server moves this client's adaptive audio streams to another bitrate rung. */
+    UPROPERTY(BlueprintAssignable, Category = "NovaLink|Control")
+    FNovaLinkBitrateChanged OnBitrateChanged;
+
+    /** Starts the websocket connection. */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|Control")
+    void StartConnection(const FString& OptionalOverrideUrl = TEXT(""));
+
+    /** Stops the websocket connection if active. */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|Control")
+    void StopConnection();
+
+    /** Returns true when the websocket is currently connected. */
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Control")
+    bool IsConnected() const;
+
+    /** Returns true when the last status reported by the server was "ready". */
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Control")
+    bool IsServerReady() const;
+
+    /** Last status received from the server. */
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Control")
+    FNovaLinkServerStatus GetServerStatus() const;
+
+    /**
+     * Sends a user turn to the server. Audio and emotion stream to the receivers following AgentId.
+     * An empty SessionId uses this client's own session. A non-empty Voice picks the TTS voice for the
+     * session from then on. Returns the turn id, or INDEX_NONE if not connected.
+     */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|Control")
+    int32 SubmitTurn(const FString& Text, const FString& AgentId = TEXT(""), const FString& SessionId = TEXT(""), const FString& Voice = TEXT(""));
+
+    /** Drops the server-side chat history of a session. */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|Control")
+    void EndSession(const FString& SessionId);
+
+    /** Sends a ping; the answer updates GetRoundTripMs(). */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|Control")
+    void SendPing();
+
+    /** Reports link quality for this client's adaptive audio streams, with the latest round-trip time. */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|Control")
+    void SendAudioFeedback(const FNovaLinkAudioFeedback& Feedback);
+
+    /** Smoothed ping round-trip time in milliseconds; zero until the first pong. */
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Control")
+    float GetRoundTripMs() const { return RoundTripMs; }
+
+private:
+    friend struct TNovaLinkOwnerDelivery<UControlReceiver>;
+
+    void DeliverPayload(const TSharedPtr<FJsonObject>& JsonObject);
+    void HandleConnectionChanged(bool bConnected);
+
+    bool SendJson(const TSharedRef<FJsonObject>& JsonObject);
+
+    FNovaLinkControlChannel Channel{TEXT("ControlReceiver"), this};
+    FNovaLinkServerStatus ServerStatus;
+    int32 NextTurnId;
+    float RoundTripMs = 0.0f;
+};
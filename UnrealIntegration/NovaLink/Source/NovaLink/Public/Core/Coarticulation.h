@@ -0,0 +1,259 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace NovaLink::Dsp
+{
+    /** Mouth shapes driven by lip sync; the common 15-viseme set used by most face rigs. */
+    enum class EViseme : std::uint8_t
+    {
+        Sil,
+        PP,
+        FF,
+        TH,
+        DD,
+        KK,
+        CH,
+        SS,
+        NN,
+        RR,
+        AA,
+        E,
+        IH,
+        OH,
+        OU,
+        Count
+    };
+
+    constexpr std::size_t NumVisemes = static_cast<std::size_t>(EViseme::Count);
+
+    /** Maps an ARPAbet phoneme ("AA1", "p", "sil") to its viseme; lexical stress digits are ignored. */
+    inline EViseme VisemeForPhoneme(std::string_view Phoneme)
+    {
+        char Upper[4] = {};
+        std::size_t Length = 0;
+        for (const char Char : Phoneme)
+        {
+            if (Char >= '0' && Char <= '9')
+            {
+                break;
+            }
+            if (Length == sizeof(Upper) - 1)
+            {
+                return EViseme::Sil;
+            }
+            Upper[Length++] = (Char >= 'a' && Char <= 'z') ? static_cast<char>(Char - 'a' + 'A') : Char;
+        }
+        const std::string_view Key(Upper, Length);
+
+        struct FEntry
+        {
+            std::string_view Phoneme;
+            EViseme Viseme;
+        };
+        static constexpr FEntry Table[] = {
+            {"P", EViseme::PP}, {"B", EViseme::PP}, {"M", EViseme::PP},
+            {"F", EViseme::FF}, {"V", EViseme::FF},
+            {"TH", EViseme::TH}, {"DH", EViseme::TH},
+            {"T", EViseme::DD}, {"D", EViseme::DD},
+            {"K", EViseme::KK}, {"G", EViseme::KK}, {"NG", EViseme::KK}, {"HH", EViseme::KK},
+            {"CH", EViseme::CH}, {"JH", EViseme::CH}, {"SH", EViseme::CH}, {"ZH", EViseme::CH},
+            {"S", EViseme::SS}, {"Z", EViseme::SS},
+            {"N", EViseme::NN}, {"L", EViseme::NN},
+            {"R", EViseme::RR}, {"ER", EViseme::RR},
+            {"AA", EViseme::AA}, {"AE", EViseme::AA}, {"AH", EViseme::AA}, {"AY", EViseme::AA}, {"AW", EViseme::AA},
+            {"EH", EViseme::E}, {"EY", EViseme::E},
+            {"IH", EViseme::IH}, {"IY", EViseme::IH}, {"Y", EViseme::IH},
+            {"AO", EViseme::OH}, {"OW", EViseme::OH}, {"OY", EViseme::OH},
+            {"UH", EViseme::OU}, {"UW", EViseme::OU}, {"W", EViseme::OU},
+        };
+        for (const FEntry& Entry : Table)
+        {
+            if (Entry.Phoneme == Key)
+            {
+                return Entry.Viseme;
+            }
+        }
+        return EViseme::Sil;
+    }
+
+    /**
+     * Cohen-Massaro dominance of one viseme: full strength Alpha inside its segment, decaying as
+     * exp(-Theta * distance) outside it. A small ThetaBefore makes the shape anticipated early.
+     */
+    struct FDominance
+    {
+        float Alpha = 1.0f;
+        float ThetaBefore = 25.0f;
+        float ThetaAfter = 30.0f;
+    };
+
+    inline std::array<FDominance, NumVisemes> DefaultDominance()
+    {
+        std::array<FDominance, NumVisemes> Dominance;
+        Dominance.fill(FDominance{});
+        // Lip closures and labiodentals must be reached exactly, whatever surrounds them.
+        Dominance[static_cast<std::size_t>(EViseme::PP)] = {4.0f, 35.0f, 45.0f};
+        Dominance[static_cast<std::size_t>(EViseme::FF)] = {3.0f, 30.0f, 40.0f};
+        // Lip rounding spreads over neighbouring consonants.
+        Dominance[static_cast<std::size_t>(EViseme::OU)] = {1.5f, 12.0f, 20.0f};
+        Dominance[static_cast<std::size_t>(EViseme::OH)] = {1.3f, 15.0f, 22.0f};
+        // Tongue-only consonants barely constrain the lips.
+        Dominance[static_cast<std::size_t>(EViseme::DD)] = {0.5f, 40.0f, 40.0f};
+        Dominance[static_cast<std::size_t>(EViseme::KK)] = {0.5f, 40.0f, 40.0f};
+        Dominance[static_cast<std::size_t>(EViseme::NN)] = {0.5f, 40.0f, 40.0f};
+        Dominance[static_cast<std::size_t>(EViseme::Sil)] = {0.8f, 30.0f, 20.0f};
+        return Dominance;
+    }
+
+    /**
+     * Turns timed phoneme (viseme) segments into blended viseme weights for many speakers at once.
+     *
+     * Each track stores its segments structure-of-arrays and keeps a cursor at the playback position,
+     * so Evaluate() only visits segments within WindowSeconds of each track's time: a single
+     * allocation-free pass over every active track per frame. Weights of a track sum to one.
+     */
+    class FCoarticulationEngine
+    {
+    public:
+        /** Beyond this distance a segment's dominance is negligible. */
+        float WindowSeconds = 0.3f;
+
+        void Configure(std::size_t NumTracks, std::size_t InSegmentsPerTrack = 512)
+        {
+            SegmentsPerTrack = InSegmentsPerTrack;
+            Tracks.clear();
+            SetNumTracks(NumTracks);
+            Dominance = DefaultDominance();
+        }
+
+        /** Adds tracks (keeping existing ones) or drops trailing ones. */
+        void SetNumTracks(std::size_t NumTracks)
+        {
+            const std::size_t OldNum = Tracks.size();
+            Tracks.resize(NumTracks);
+            for (std::size_t Index = OldNum; Index < NumTracks; ++Index)
+            {
+                Tracks[Index].Start.reserve(SegmentsPerTrack);
+                Tracks[Index].End.reserve(SegmentsPerTrack);
+                Tracks[Index].Viseme.reserve(SegmentsPerTrack);
+            }
+        }
+
+        std::size_t GetNumTracks() const { return Tracks.size(); }
+
+        void SetDominance(EViseme Viseme, const FDominance& Value) { Dominance[static_cast<std::size_t>(Viseme)] = Value; }
+
+        void ClearTrack(std::size_t TrackIndex)
+        {
+            FTrack& Track = Tracks[TrackIndex];
+            Track.Start.clear();
+            Track.End.clear();
+            Track.Viseme.clear();
+            Track.Cursor = 0;
+        }
+
+        /** Appends a segment in stream seconds; segments of a track must arrive in time order. */
+        void AppendSegment(std::size_t TrackIndex, float StartSeconds, float EndSeconds, EViseme Viseme)
+        {
+            FTrack& Track = Tracks[TrackIndex];
+            if (Track.Cursor > 0 && Track.Start.size() == Track.Start.capacity())
+            {
+                Compact(Track);
+            }
+            Track.Start.push_back(StartSeconds);
+            Track.End.push_back(EndSeconds > StartSeconds ? EndSeconds : StartSeconds);
+            Track.Viseme.push_back(static_cast<std::uint8_t>(Viseme));
+        }
+
+        /**
+         * Samples every track whose Times entry is non-negative at that time and writes NumVisemes
+         * weights per track to OutWeights (GetNumTracks() * NumVisemes floats). Tracks with a negative
+         * time are skipped and keep their previous output.
+         */
+        void Evaluate(const float* Times, float* OutWeights)
+        {
+            for (std::size_t TrackIndex = 0; TrackIndex < Tracks.size(); ++TrackIndex)
+            {
+                const float Time = Times[TrackIndex];
+                if (Time < 0.0f)
+                {
+                    continue;
+                }
+                EvaluateTrack(Tracks[TrackIndex], Time, OutWeights + TrackIndex * NumVisemes);
+            }
+        }
+
+    private:
+        struct FTrack
+        {
+            std::vector<float> Start;
+            std::vector<float> End;
+            std::vector<std::uint8_t> Viseme;
+            std::size_t Cursor = 0;
+        };
+
+        void EvaluateTrack(FTrack& Track, float Time, float* Out) const
+        {
+            const std::size_t NumSegments = Track.Start.size();
+            while (Track.Cursor < NumSegments && Track.End[Track.Cursor] < Time - WindowSeconds)
+            {
+                ++Track.Cursor;
+            }
+
+            float Sums[NumVisemes] = {};
+            float Total = 0.0f;
+            for (std::size_t Index = Track.Cursor; Index < NumSegments && Track.Start[Index] <= Time + WindowSeconds; ++Index)
+            {
+                const FDominance& Params = Dominance[Track.Viseme[Index]];
+                float Weight = Params.Alpha;
+                if (Time < Track.Start[Index])
+                {
+                    Weight *= std::exp(-Params.ThetaBefore * (Track.Start[Index] - Time));
+                }
+                else if (Time > Track.End[Index])
+                {
+                    Weight *= std::exp(-Params.ThetaAfter * (Time - Track.End[Index]));
+                }
+                Sums[Track.Viseme[Index]] += Weight;
+                Total += Weight;
+            }
+
+            // Far from any segment the mouth rests; near an utterance edge silence blends in.
+            const float Rest = Dominance[static_cast<std::size_t>(EViseme::Sil)].Alpha * 0.05f;
+            Sums[static_cast<std::size_t>(EViseme::Sil)] += Rest;
+            Total += Rest;
+
+            const float Scale = 1.0f / Total;
+            for (std::size_t Viseme = 0; Viseme < NumVisemes; ++Viseme)
+            {
+                Out[Viseme] = Sums[Viseme] * Scale;
+            }
+        }
+
+        /** Drops segments behind the cursor in place, keeping the reserved capacity. */
+        static void Compact(FTrack& Track)
+        {
+            const std::size_t Keep = Track.Start.size() - Track.Cursor;
+            for (std::size_t Index = 0; Index < Keep; ++Index)
+            {
+                Track.Start[Index] = Track.Start[Track.Cursor + Index];
+                Track.End[Index] = Track.End[Track.Cursor + Index];
+                Track.Viseme[Index] = Track.Viseme[Track.Cursor + Index];
+            }
+            Track.Start.resize(Keep);
+            Track.End.resize(Keep);
+            Track.Viseme.resize(Keep);
+            Track.Cursor = 0;
+        }
+
+        std::vector<FTrack> Tracks;
+        std::size_t SegmentsPerTrack = 512;
+        std::array<FDominance, NumVisemes> Dominance = DefaultDominance();
+    };
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+namespace NovaLink::Dsp
+{
+    /** Block RMS/peak meter with an attack/release smoothed envelope, e.g. for jaw-open or VU meters. */
+    class FEnvelopeAnalyzer
+    {
+    public:
+        void Configure(int InSampleRate, float AttackMs = 10.0f, float ReleaseMs = 80.0f)
+        {
+            SampleRate = InSampleRate > 0 ? InSampleRate : 48000;
+            AttackSamples = AttackMs * 0.001f * SampleRate;
+            ReleaseSamples = ReleaseMs * 0.001f * SampleRate;
+            Reset();
+        }
+
+        void Reset()
+        {
+            Rms = 0.0f;
+            Peak = 0.0f;
+            Envelope = 0.0f;
+        }
+
+        void Process(const float* In, std::size_t Num)
+        {
+            if (Num == 0)
+            {
+                return;
+            }
+            double SumSquares = 0.0;
+            float BlockPeak = 0.0f;
+            for (std::size_t Index = 0; Index < Num; ++Index)
+            {
+                const float Sample = In[Index];
+                SumSquares += static_cast<double>(Sample) * Sample;
+                BlockPeak = std::fmax(BlockPeak, std::fabs(Sample));
+            }
+            Rms = static_cast<float>(std::sqrt(SumSquares / static_cast<double>(Num)));
+            Peak = BlockPeak;
+
+            const float TimeConstant = Rms > Envelope ? AttackSamples : ReleaseSamples;
+            const float Coefficient = TimeConstant > 0.0f ? std::exp(-static_cast<float>(Num) / TimeConstant) : 0.0f;
+            Envelope = Rms + (Envelope - Rms) * Coefficient;
+        }
+
+        /** Like Process for Num samples of silence, without needing the samples. */
+        void ProcessSilence(std::size_t Num)
+        {
+            if (Num == 0)
+            {
+                return;
+            }
+            Rms = 0.0f;
+            Peak = 0.0f;
+            Envelope *= ReleaseSamples > 0.0f ? std::exp(-static_cast<float>(Num) / ReleaseSamples) : 0.0f;
+        }
+
+        float GetRms() const { return Rms; }
+        float GetPeak() const { return Peak; }
+        float GetEnvelope() const { return Envelope; }
+
+    private:
+        int SampleRate = 48000;
+        float AttackSamples = 480.0f;
+        float ReleaseSamples = 3840.0f;
+        float Rms = 0.0f;
+        float Peak = 0.0f;
+        float Envelope = 0.0f;
+    };
+}
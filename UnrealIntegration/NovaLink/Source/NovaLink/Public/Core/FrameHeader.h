@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace NovaLink::Dsp
+{
+    /** Codec ids carried in the frame header. */
+    enum class EFrameCodec : std::uint8_t
+    {
+        Pcm16 = 0,
+        MuLaw = 1,
+
+        /** Header-only frame standing for SampleCount samples of silence (server DTX, dtx=1). */
+        Silence = 2,
+    };
+
+    /**
+     * Header the server prepends to audio frames when the client connects with framing=nv1:
+     * magic "NV", version, codec, sequence, sample rate and sample count, all little-endian (16 bytes).
+     */
+    struct FFrameHeader
+    {
+        static constexpr std::size_t Size = 16;
+        static constexpr std::uint8_t Version = 1;
+
+        EFrameCodec Codec = EFrameCodec::Pcm16;
+        std::uint32_t Sequence = 0;
+        std::uint32_t SampleRate = 0;
+        std::uint32_t SampleCount = 0;
+    };
+
+    inline std::uint32_t ReadUint32LE(const std::uint8_t* Bytes)
+    {
+        return static_cast<std::uint32_t>(Bytes[0])
+            | (static_cast<std::uint32_t>(Bytes[1]) << 8)
+            | (static_cast<std::uint32_t>(Bytes[2]) << 16)
+            | (static_cast<std::uint32_t>(Bytes[3]) << 24);
+    }
+
+    inline void WriteUint32LE(std::uint8_t* Bytes, std::uint32_t Value)
+    {
+        Bytes[0] = static_cast<std::uint8_t>(Value);
+        Bytes[1] = static_cast<std::uint8_t>(Value >> 8);
+        Bytes[2] = static_cast<std::uint8_t>(Value >> 16);
+        Bytes[3] = static_cast<std::uint8_t>(Value >> 24);
+    }
+
+    /** Parses a frame header; returns false for short buffers, bad magic or an unknown version. */
+    inline bool ParseFrameHeader(const std::uint8_t* Bytes, std::size_t NumBytes, FFrameHeader& OutHeader)
+    {
+        if (!Bytes || NumBytes < FFrameHeader::Size || Bytes[0] != 'N' || Bytes[1] != 'V' || Bytes[2] != FFrameHeader::Version)
+        {
+            return false;
+        }
+        OutHeader.Codec = static_cast<EFrameCodec>(Bytes[3]);
+        OutHeader.Sequence = ReadUint32LE(Bytes + 4);
+        OutHeader.SampleRate = ReadUint32LE(Bytes + 8);
+        OutHeader.SampleCount = ReadUint32LE(Bytes + 12);
+        return true;
+    }
+
+    /** Writes Header into Bytes (at least FFrameHeader::Size long). */
+    inline void WriteFrameHeader(const FFrameHeader& Header, std::uint8_t* Bytes)
+    {
+        Bytes[0] = 'N';
+        Bytes[1] = 'V';
+        Bytes[2] = FFrameHeader::Version;
+        Bytes[3] = static_cast<std::uint8_t>(Header.Codec);
+        WriteUint32LE(Bytes + 4, Header.Sequence);
+        WriteUint32LE(Bytes + 8, Header.SampleRate);
+        WriteUint32LE(Bytes + 12, Header.SampleCount);
+    }
+}
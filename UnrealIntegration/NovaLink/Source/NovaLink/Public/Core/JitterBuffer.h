@@ -0,0 +1,370 @@
+#pragma once
+
+#include "Core/PacketLossConcealer.h"
+#include "Core/PcmRingBuffer.h"
+#include "Core/SpscQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace NovaLink::Dsp
+{
+    struct FJitterBufferSettings
+    {
+        int SampleRate = 48000;
+
+        /** Seconds of audio the ring can hold. */
+        float CapacitySeconds = 2.0f;
+
+        /** Audio buffered before playback (re)starts; absorbs network jitter. */
+        float TargetLatencyMs = 60.0f;
+
+        /** Buffered audio beyond this is dropped back to the target, so clock drift cannot pile up delay. */
+        float MaxLatencyMs = 400.0f;
+
+        /** Longest run of lost frames that is concealed; longer gaps are treated as silence. */
+        float MaxConcealMs = 500.0f;
+
+        FConcealerSettings Concealment;
+    };
+
+    /**
+     * Playout buffer for one voice: prebuffering, drift trimming and concealment of lost frames and
+     * underruns. Write/WriteSilence/MarkLost are the producer side, Render the single consumer (the audio render
+     * thread). Memory is allocated in Configure() only.
+     */
+    class FJitterBuffer
+    {
+    public:
+        void Configure(const FJitterBufferSettings& InSettings)
+        {
+            Settings = InSettings;
+            Settings.Concealment.SampleRate = Settings.SampleRate;
+            Ring.Allocate(static_cast<std::size_t>(std::ceil(Settings.CapacitySeconds * Settings.SampleRate)));
+            Concealer.Configure(Settings.Concealment);
+            Reset();
+        }
+
+        /** Only safe while neither side is running. */
+        void Reset()
+        {
+            Ring.Reset();
+            Gaps.Reset();
+            Concealer.Reset();
+            Pauses.Reset();
+            SettledPauseAdjustment = 0;
+            TotalPauseAdjustment = 0;
+            bInSpeech = false;
+            SpeechSampleCount.store(0, std::memory_order_relaxed);
+            SpeechStartPosition.store(0, std::memory_order_relaxed);
+            ConcealRemaining = 0;
+            LastSeenWritePosition = 0;
+            bPlaying = false;
+            bStarved = false;
+            ConcealedSampleCount.store(0, std::memory_order_relaxed);
+            DiscardedSampleCount.store(0, std::memory_order_relaxed);
+            UnderrunCount.store(0, std::memory_order_relaxed);
+        }
+
+        const FJitterBufferSettings& GetSettings() const { return Settings; }
+
+        /** Buffers Num samples of speech; returns how many fit. */
+        std::size_t Write(const float* In, std::size_t Num)
+        {
+            if (!bInSpeech || Ring.NumAvailable() == 0)
+            {
+                // A talk spurt starts after a pause or once playback has drained everything before it.
+                SpeechStartPosition.store(Ring.GetWritePosition(), std::memory_order_relaxed);
+                bInSpeech = true;
+            }
+            const std::size_t Written = Ring.Write(In, Num);
+            SpeechSampleCount.fetch_add(Written, std::memory_order_relaxed);
+            return Written;
+        }
+
+        /**
+         * Buffers Num samples of silence announced by the server, filled with the concealment's comfort
+         * noise. Pauses are where playout delay can change without touching speech: a run is shortened
+         * while more than the target latency is buffered and stretched (by at most its own length)
+         * while less is, so the next phrase starts with the full cushion against network jitter.
+         * Returns how many samples were buffered; the difference to Num is recorded for
+         * ToStreamPosition().
+         */
+        std::size_t WriteSilence(std::size_t Num)
+        {
+            bInSpeech = false;
+            const std::size_t Start = Ring.GetWritePosition();
+            const std::size_t Target = MsToSamples(Settings.TargetLatencyMs);
+            const std::size_t Buffered = Ring.NumAvailable();
+            std::size_t Length = Num;
+            if (Buffered > Target)
+            {
+                const std::size_t Excess = std::min(Num, Buffered - Target);
+                Length -= Excess;
+                DiscardedSampleCount.fetch_add(Excess, std::memory_order_relaxed);
+            }
+            else
+            {
+                Length += std::min(Num, Target - Buffered);
+            }
+
+            const float NoiseLevel = Settings.Concealment.ComfortNoiseLevel;
+            float Block[256];
+            std::size_t Written = 0;
+            while (Written < Length)
+            {
+                const std::size_t Count = std::min(Length - Written, sizeof(Block) / sizeof(Block[0]));
+                for (std::size_t Index = 0; Index < Count; ++Index)
+                {
+                    float Sample = 0.0f;
+                    if (NoiseLevel > 0.0f)
+                    {
+                        SilenceNoiseState = SilenceNoiseState * 1664525u + 1013904223u;
+                        Sample = (static_cast<float>(SilenceNoiseState >> 8) * (2.0f / 16777216.0f) - 1.0f) * NoiseLevel;
+                    }
+                    Block[Index] = Sample;
+                }
+                const std::size_t NumWritten = Ring.Write(Block, Count);
+                Written += NumWritten;
+                if (NumWritten < Count)
+                {
+                    break;
+                }
+            }
+
+            if (Written != Num)
+            {
+                FPause Pause;
+                Pause.Position = Start;
+                Pause.Written = Written;
+                Pause.Nominal = Num;
+                while (!Pauses.Push(Pause))
+                {
+                    // More adjusted pauses queued than playback has reached: settle the oldest early.
+                    SettleOldestPause();
+                }
+            }
+            TotalPauseAdjustment += static_cast<std::int64_t>(Written) - static_cast<std::int64_t>(Num);
+            return Written;
+        }
+
+        /** Records NumSamples of missing audio at the current write position, to be concealed on playback. */
+        bool MarkLost(std::size_t NumSamples)
+        {
+            FGap Gap;
+            Gap.Position = Ring.GetWritePosition();
+            Gap.NumSamples = std::min(NumSamples, MsToSamples(Settings.MaxConcealMs));
+            return Gap.NumSamples == 0 || Gaps.Push(Gap);
+        }
+
+        /**
+         * Fills all Num samples of Out: buffered audio, concealment for lost frames and underruns, or
+         * silence while (re)buffering. Returns how many samples were real audio.
+         */
+        std::size_t Render(float* Out, std::size_t Num)
+        {
+            const std::size_t WritePosition = Ring.GetWritePosition();
+            const bool bStreamStalled = WritePosition == LastSeenWritePosition;
+            LastSeenWritePosition = WritePosition;
+
+            if (!bPlaying)
+            {
+                // Wait for the target latency, or play what is there once the stream pauses.
+                const std::size_t Available = Ring.NumAvailable();
+                if (Available == 0 || (Available < MsToSamples(Settings.TargetLatencyMs) && !bStreamStalled))
+                {
+                    std::memset(Out, 0, Num * sizeof(float));
+                    return 0;
+                }
+                bPlaying = true;
+            }
+
+            const std::size_t Buffered = Ring.NumAvailable();
+            if (Buffered > MsToSamples(Settings.MaxLatencyMs))
+            {
+                const std::size_t Excess = Buffered - MsToSamples(Settings.TargetLatencyMs);
+                Ring.Discard(Excess);
+                DiscardedSampleCount.fetch_add(Excess, std::memory_order_relaxed);
+            }
+
+            std::size_t Produced = 0;
+            std::size_t NumReal = 0;
+            while (Produced < Num)
+            {
+                const std::size_t ReadPosition = Ring.GetReadPosition();
+                const FGap* Gap = Gaps.Peek();
+                if (ConcealRemaining == 0 && Gap && Gap->Position <= ReadPosition)
+                {
+                    // Gaps overtaken by a drift discard are skipped rather than concealed late.
+                    if (Gap->Position == ReadPosition)
+                    {
+                        ConcealRemaining = Gap->NumSamples;
+                    }
+                    Gaps.Pop();
+                    continue;
+                }
+
+                if (ConcealRemaining > 0)
+                {
+                    const std::size_t Count = std::min(ConcealRemaining, Num - Produced);
+                    Concealer.Conceal(Out + Produced, Count);
+                    ConcealRemaining -= Count;
+                    ConcealedSampleCount.fetch_add(Count, std::memory_order_relaxed);
+                    Produced += Count;
+                    continue;
+                }
+
+                std::size_t Limit = Ring.NumAvailable();
+                if (Gap)
+                {
+                    Limit = std::min(Limit, Gap->Position - ReadPosition);
+                }
+                if (Limit == 0)
+                {
+                    // Underrun: extend the voice, fading to comfort silence, then rebuffer.
+                    const std::size_t Count = Num - Produced;
+                    Concealer.Conceal(Out + Produced, Count);
+                    if (!Concealer.HasFadedOut())
+                    {
+                        ConcealedSampleCount.fetch_add(Count, std::memory_order_relaxed);
+                        bStarved = true;
+                    }
+                    else
+                    {
+                        // Speech ended (or the stream stalled for good): not an underrun worth reporting.
+                        bPlaying = false;
+                        bStarved = false;
+                    }
+                    break;
+                }
+
+                if (bStarved)
+                {
+                    UnderrunCount.fetch_add(1, std::memory_order_relaxed);
+                    bStarved = false;
+                }
+                const std::size_t Count = std::min(Limit, Num - Produced);
+                Ring.Read(Out + Produced, Count);
+                Concealer.OnRealAudio(Out + Produced, Count);
+                Produced += Count;
+                NumReal += Count;
+            }
+            return NumReal;
+        }
+
+        /** Pops up to Num samples without concealment; returns how many were available. */
+        std::size_t Read(float* Out, std::size_t Num)
+        {
+            return Ring.Read(Out, Num);
+        }
+
+        /**
+         * Maps a buffer position (e.g. GetReadPosition()) to the server's stream position, where every
+         * pause has its nominal length: stretched pauses hold the stream clock at their end, trimmed
+         * ones skip it forward. Producer side; Position must not decrease between calls.
+         */
+        std::size_t ToStreamPosition(std::size_t Position)
+        {
+            std::int64_t Excess = 0;
+            while (const FPause* Pause = Pauses.Peek())
+            {
+                if (Pause->Position + Pause->Written <= Position)
+                {
+                    SettleOldestPause();
+                    continue;
+                }
+                if (Pause->Position < Position && Position - Pause->Position > Pause->Nominal)
+                {
+                    Excess = static_cast<std::int64_t>(Position - Pause->Position - Pause->Nominal);
+                }
+                break;
+            }
+            const std::int64_t StreamPosition = static_cast<std::int64_t>(Position) - SettledPauseAdjustment - Excess;
+            return static_cast<std::size_t>(std::max<std::int64_t>(0, StreamPosition));
+        }
+
+        /** Stream position of the next sample to be written: GetWritePosition() without pause adjustments. */
+        std::size_t GetStreamWritePosition() const
+        {
+            const std::int64_t StreamPosition = static_cast<std::int64_t>(Ring.GetWritePosition()) - TotalPauseAdjustment;
+            return static_cast<std::size_t>(std::max<std::int64_t>(0, StreamPosition));
+        }
+
+        /** Net samples WriteSilence has added to (positive) or cut from (negative) pauses since Reset(). */
+        std::int64_t GetPauseAdjustment() const { return TotalPauseAdjustment; }
+
+        /** Samples buffered by Write() since Reset(): received speech, excluding silence markers. */
+        std::uint64_t GetSpeechSamples() const { return SpeechSampleCount.load(std::memory_order_relaxed); }
+
+        /** Buffer position where the most recent talk spurt began; readable from the render thread. */
+        std::size_t GetSpeechStartPosition() const { return SpeechStartPosition.load(std::memory_order_relaxed); }
+
+        std::size_t NumBuffered() const { return Ring.NumAvailable(); }
+        std::size_t GetWritePosition() const { return Ring.GetWritePosition(); }
+        std::size_t GetReadPosition() const { return Ring.GetReadPosition(); }
+        bool IsPlaying() const { return bPlaying; }
+
+        std::uint64_t GetConcealedSamples() const { return ConcealedSampleCount.load(std::memory_order_relaxed); }
+        std::uint64_t GetDiscardedSamples() const { return DiscardedSampleCount.load(std::memory_order_relaxed); }
+
+        /** Times playback ran dry mid-speech and recovered before the concealment faded out. */
+        std::uint32_t GetUnderrunCount() const { return UnderrunCount.load(std::memory_order_relaxed); }
+
+        std::size_t MsToSamples(float Milliseconds) const
+        {
+            return static_cast<std::size_t>(std::max(0.0f, std::round(Milliseconds * 0.001f * Settings.SampleRate)));
+        }
+
+    private:
+        struct FGap
+        {
+            std::size_t Position = 0;
+            std::size_t NumSamples = 0;
+        };
+
+        /** A pause WriteSilence stretched or trimmed: buffered at Position, Written samples standing for Nominal. */
+        struct FPause
+        {
+            std::size_t Position = 0;
+            std::size_t Written = 0;
+            std::size_t Nominal = 0;
+        };
+
+        void SettleOldestPause()
+        {
+            if (const FPause* Pause = Pauses.Peek())
+            {
+                SettledPauseAdjustment += static_cast<std::int64_t>(Pause->Written) - static_cast<std::int64_t>(Pause->Nominal);
+                Pauses.Pop();
+            }
+        }
+
+        FJitterBufferSettings Settings;
+        FPcmRingBuffer Ring;
+        TSpscQueue<FGap, 32> Gaps;
+
+        // Producer side only.
+        std::uint32_t SilenceNoiseState = 33333u;
+        TSpscQueue<FPause, 32> Pauses;
+        std::int64_t SettledPauseAdjustment = 0;
+        std::int64_t TotalPauseAdjustment = 0;
+        bool bInSpeech = false;
+        std::atomic<std::uint64_t> SpeechSampleCount{0};
+        std::atomic<std::size_t> SpeechStartPosition{0};
+
+        // Render thread only.
+        FPacketLossConcealer Concealer;
+        std::size_t ConcealRemaining = 0;
+        std::size_t LastSeenWritePosition = 0;
+        bool bPlaying = false;
+        bool bStarved = false;
+
+        std::atomic<std::uint64_t> ConcealedSampleCount{0};
+        std::atomic<std::uint64_t> DiscardedSampleCount{0};
+        std::atomic<std::uint32_t> UnderrunCount{0};
+    };
+}
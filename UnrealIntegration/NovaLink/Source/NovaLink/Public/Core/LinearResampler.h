@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+namespace NovaLink::Dsp
+{
+    /**
+     * Streaming linear-interpolation sample-rate converter for mono audio.
+     * Keeps one sample of history between calls, so chunk boundaries are seamless.
+     */
+    class FLinearResampler
+    {
+    public:
+        void SetRates(int InputRate, int OutputRate)
+        {
+            Step = (InputRate > 0 && OutputRate > 0) ? static_cast<double>(InputRate) / OutputRate : 1.0;
+            Reset();
+        }
+
+        void Reset()
+        {
+            Position = 0.0;
+            Previous = 0.0f;
+        }
+
+        bool IsPassthrough() const
+        {
+            return Step == 1.0;
+        }
+
+        double GetStep() const
+        {
+            return Step;
+        }
+
+        /** Upper bound on the output produced for NumInput input samples. */
+        std::size_t MaxOutputFor(std::size_t NumInput) const
+        {
+            return static_cast<std::size_t>(std::ceil(static_cast<double>(NumInput) / Step)) + 1;
+        }
+
+        /** Converts NumInput samples into Out (sized with MaxOutputFor) and returns the output count. */
+        std::size_t Process(const float* In, std::size_t NumInput, float* Out, std::size_t MaxOutput)
+        {
+            if (NumInput == 0)
+            {
+                return 0;
+            }
+            if (IsPassthrough())
+            {
+                const std::size_t Num = NumInput < MaxOutput ? NumInput : MaxOutput;
+                for (std::size_t Index = 0; Index < Num; ++Index)
+                {
+                    Out[Index] = In[Index];
+                }
+                Previous = In[NumInput - 1];
+                return Num;
+            }
+
+            // Position is measured from Previous (index 0); In[i] sits at index i + 1.
+            std::size_t Produced = 0;
+            while (Position < static_cast<double>(NumInput) && Produced < MaxOutput)
+            {
+                const std::size_t Index = static_cast<std::size_t>(Position);
+                const float Fraction = static_cast<float>(Position - static_cast<double>(Index));
+                const float A = Index == 0 ? Previous : In[Index - 1];
+                const float B = In[Index];
+                Out[Produced++] = A + (B - A) * Fraction;
+                Position += Step;
+            }
+            Position -= static_cast<double>(NumInput);
+            if (Position < 0.0)
+            {
+                Position = 0.0;
+            }
+            Previous = In[NumInput - 1];
+            return Produced;
+        }
+
+    private:
+        double Step = 1.0;
+        double Position = 0.0;
+        float Previous = 0.0f;
+    };
+}
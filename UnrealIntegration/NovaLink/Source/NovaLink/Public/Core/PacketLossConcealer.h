@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace NovaLink::Dsp
+{
+    struct FConcealerSettings
+    {
+        int SampleRate = 48000;
+
+        /** Pitch search range; bounds the one-off autocorrelation cost per gap. */
+        float MinPitchHz = 60.0f;
+        float MaxPitchHz = 400.0f;
+
+        /** Concealment plays the last pitch period at full level for HoldMs, then fades out over FadeMs. */
+        float HoldMs = 10.0f;
+        float FadeMs = 50.0f;
+
+        /** Blend from concealment back into real audio. */
+        float CrossfadeMs = 5.0f;
+
+        /** Amplitude of the noise left once the extension has faded; 0 gives digital silence. */
+        float ComfortNoiseLevel = 0.0f;
+    };
+
+    /**
+     * Fills gaps in a mono stream. Short gaps get a pitch-synchronous waveform extension, which loops
+     * the last pitch period found by autocorrelation. Longer gaps decay to comfort noise, and real
+     * audio fades back in.
+     *
+     * Memory is allocated in Configure(). Work per sample is constant, plus one bounded pitch search
+     * at the start of each gap, so the cost per voice is fixed. Not thread-safe; drive it from the
+     * render thread.
+     */
+    class FPacketLossConcealer
+    {
+    public:
+        void Configure(const FConcealerSettings& InSettings)
+        {
+            Settings = InSettings;
+            const float Rate = static_cast<float>(std::max(1, Settings.SampleRate));
+            MinLag = std::max<std::size_t>(2, static_cast<std::size_t>(Rate / Settings.MaxPitchHz));
+            MaxLag = std::max(MinLag + 1, static_cast<std::size_t>(Rate / Settings.MinPitchHz));
+            Window = std::max<std::size_t>(MinLag, MaxLag / 2);
+            History.assign(Window + MaxLag, 0.0f);
+            HoldSamples = static_cast<std::size_t>(Settings.HoldMs * 0.001f * Rate);
+            FadeSamples = std::max<std::size_t>(1, static_cast<std::size_t>(Settings.FadeMs * 0.001f * Rate));
+            CrossfadeSamples = static_cast<std::size_t>(Settings.CrossfadeMs * 0.001f * Rate);
+            Reset();
+        }
+
+        void Reset()
+        {
+            std::fill(History.begin(), History.end(), 0.0f);
+            HistoryFill = 0;
+            Period = 0;
+            Phase = 0;
+            ConcealedSamples = 0;
+            bConcealing = false;
+        }
+
+        bool IsConcealing() const { return bConcealing; }
+
+        /** True once a gap has lasted long enough for the extension to fade out completely. */
+        bool HasFadedOut() const { return bConcealing && ConcealedSamples >= HoldSamples + FadeSamples; }
+
+        std::size_t GetPitchPeriod() const { return Period; }
+
+        /** Passes real audio through: crossfades out of a running concealment and records history. */
+        void OnRealAudio(float* Samples, std::size_t Num)
+        {
+            if (Num == 0)
+            {
+                return;
+            }
+            if (bConcealing)
+            {
+                const std::size_t Fade = std::min(Num, CrossfadeSamples);
+                for (std::size_t Index = 0; Index < Fade; ++Index)
+                {
+                    const float Weight = static_cast<float>(Index + 1) / static_cast<float>(Fade + 1);
+                    Samples[Index] = NextConcealedSample() * (1.0f - Weight) + Samples[Index] * Weight;
+                }
+                bConcealing = false;
+                ConcealedSamples = 0;
+            }
+            PushHistory(Samples, Num);
+        }
+
+        /** Writes Num concealment samples for missing audio. */
+        void Conceal(float* Out, std::size_t Num)
+        {
+            if (!bConcealing)
+            {
+                bConcealing = true;
+                ConcealedSamples = 0;
+                Phase = 0;
+                Period = HistoryFill >= History.size() ? EstimatePeriod() : 0;
+            }
+            for (std::size_t Index = 0; Index < Num; ++Index)
+            {
+                Out[Index] = NextConcealedSample();
+            }
+        }
+
+    private:
+        void PushHistory(const float* Samples, std::size_t Num)
+        {
+            const std::size_t Size = History.size();
+            if (Num >= Size)
+            {
+                std::copy(Samples + (Num - Size), Samples + Num, History.begin());
+            }
+            else
+            {
+                std::copy(History.begin() + Num, History.end(), History.begin());
+                std::copy(Samples, Samples + Num, History.end() - Num);
+            }
+            HistoryFill = std::min(Size, HistoryFill + Num);
+        }
+
+        std::size_t EstimatePeriod() const
+        {
+            const float* Recent = History.data() + (History.size() - Window);
+            double RecentEnergy = 0.0;
+            for (std::size_t Index = 0; Index < Window; ++Index)
+            {
+                RecentEnergy += static_cast<double>(Recent[Index]) * Recent[Index];
+            }
+            if (RecentEnergy <= 1e-9)
+            {
+                return 0;
+            }
+
+            auto Score = [this, Recent, RecentEnergy](std::size_t Lag)
+            {
+                const float* Past = Recent - Lag;
+                double Cross = 0.0;
+                double PastEnergy = 0.0;
+                for (std::size_t Index = 0; Index < Window; ++Index)
+                {
+                    Cross += static_cast<double>(Recent[Index]) * Past[Index];
+                    PastEnergy += static_cast<double>(Past[Index]) * Past[Index];
+                }
+                return PastEnergy > 1e-9 ? Cross / std::sqrt(RecentEnergy * PastEnergy) : -1.0;
+            };
+
+            // Coarse search on even lags, then refine around the best one. Multiples of the true period
+            // score alike; looping several periods is harmless and sounds less buzzy.
+            std::size_t BestLag = MinLag;
+            double BestScore = -2.0;
+            for (std::size_t Lag = MinLag; Lag <= MaxLag; Lag += 2)
+            {
+                const double Value = Score(Lag);
+                if (Value > BestScore)
+                {
+                    BestScore = Value;
+                    BestLag = Lag;
+                }
+            }
+            for (std::size_t Lag = BestLag > MinLag ? BestLag - 1 : BestLag; Lag <= std::min(MaxLag, BestLag + 1); ++Lag)
+            {
+                const double Value = Score(Lag);
+                if (Value > BestScore)
+                {
+                    BestScore = Value;
+                    BestLag = Lag;
+                }
+            }
+            return BestLag;
+        }
+
+        float NextConcealedSample()
+        {
+            float Sample = 0.0f;
+            if (Period > 0 && ConcealedSamples < HoldSamples + FadeSamples)
+            {
+                float Gain = 1.0f;
+                if (ConcealedSamples >= HoldSamples)
+                {
+                    Gain = 1.0f - static_cast<float>(ConcealedSamples - HoldSamples) / static_cast<float>(FadeSamples);
+                }
+                Sample = History[History.size() - Period + Phase] * Gain;
+                Phase = Phase + 1 == Period ? 0 : Phase + 1;
+            }
+            if (Settings.ComfortNoiseLevel > 0.0f)
+            {
+                NoiseState = NoiseState * 1664525u + 1013904223u;
+                const float Noise = static_cast<float>(NoiseState >> 8) * (2.0f / 16777216.0f) - 1.0f;
+                Sample += Noise * Settings.ComfortNoiseLevel;
+            }
+            ++ConcealedSamples;
+            return Sample;
+        }
+
+        FConcealerSettings Settings;
+        std::vector<float> History;
+        std::size_t HistoryFill = 0;
+        std::size_t MinLag = 2;
+        std::size_t MaxLag = 3;
+        std::size_t Window = 2;
+        std::size_t HoldSamples = 0;
+        std::size_t FadeSamples = 1;
+        std::size_t CrossfadeSamples = 0;
+        std::size_t Period = 0;
+        std::size_t Phase = 0;
+        std::size_t ConcealedSamples = 0;
+        std::uint32_t NoiseState = 22222u;
+        bool bConcealing = false;
+    };
+}
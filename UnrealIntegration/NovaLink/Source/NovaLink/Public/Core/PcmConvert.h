@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace NovaLink::Dsp
+{
+    /** Decodes little-endian PCM16 bytes into floats in [-1, 1). Returns the sample count (NumBytes / 2). */
+    inline std::size_t ConvertPcm16ToFloat(const std::uint8_t* Bytes, std::size_t NumBytes, float* Out)
+    {
+        const std::size_t NumSamples = NumBytes / 2;
+        for (std::size_t Index = 0; Index < NumSamples; ++Index)
+        {
+            const std::int16_t Sample = static_cast<std::int16_t>(
+                static_cast<std::uint16_t>(Bytes[2 * Index]) | (static_cast<std::uint16_t>(Bytes[2 * Index + 1]) << 8));
+            Out[Index] = static_cast<float>(Sample) * (1.0f / 32768.0f);
+        }
+        return NumSamples;
+    }
+
+    /** Expands one G.711 mu-law byte to a 16-bit sample. */
+    inline std::int16_t DecodeMuLaw(std::uint8_t Byte)
+    {
+        const std::uint8_t Value = static_cast<std::uint8_t>(~Byte);
+        const int Magnitude = ((((Value & 0x0F) << 3) + 0x84) << ((Value >> 4) & 0x07)) - 0x84;
+        return static_cast<std::int16_t>((Value & 0x80) ? -Magnitude : Magnitude);
+    }
+
+    /** Decodes mu-law bytes into floats in [-1, 1). Returns the sample count (NumBytes). */
+    inline std::size_t ConvertMuLawToFloat(const std::uint8_t* Bytes, std::size_t NumBytes, float* Out)
+    {
+        for (std::size_t Index = 0; Index < NumBytes; ++Index)
+        {
+            Out[Index] = static_cast<float>(DecodeMuLaw(Bytes[Index])) * (1.0f / 32768.0f);
+        }
+        return NumBytes;
+    }
+
+    /** Decodes mu-law bytes into little-endian PCM16; Out must hold 2 * NumBytes bytes. */
+    inline void ConvertMuLawToPcm16(const std::uint8_t* Bytes, std::size_t NumBytes, std::uint8_t* Out)
+    {
+        for (std::size_t Index = 0; Index < NumBytes; ++Index)
+        {
+            const std::uint16_t Sample = static_cast<std::uint16_t>(DecodeMuLaw(Bytes[Index]));
+            Out[2 * Index] = static_cast<std::uint8_t>(Sample);
+            Out[2 * Index + 1] = static_cast<std::uint8_t>(Sample >> 8);
+        }
+    }
+}
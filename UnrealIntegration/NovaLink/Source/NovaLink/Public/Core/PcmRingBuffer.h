@@ -0,0 +1,120 @@
+#pragma once
+
+// Engine-independent DSP building blocks shared by the plugin and the
+// standalone tools. Only the C++ standard library may be used in Core/.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace NovaLink::Dsp
+{
+    /**
+     * Lock-free single-producer/single-consumer ring of float samples.
+     * Storage is allocated once in Allocate(); Write/Read never allocate. Reset() must only be
+     * called while neither side is running.
+     */
+    class FPcmRingBuffer
+    {
+    public:
+        explicit FPcmRingBuffer(std::size_t MinCapacity = 0)
+        {
+            Allocate(MinCapacity);
+        }
+
+        /** Resizes storage to the next power of two >= MinCapacity and empties the buffer. */
+        void Allocate(std::size_t MinCapacity)
+        {
+            std::size_t NewCapacity = 1;
+            while (NewCapacity < MinCapacity)
+            {
+                NewCapacity <<= 1;
+            }
+            Samples.assign(NewCapacity, 0.0f);
+            Mask = NewCapacity - 1;
+            Reset();
+        }
+
+        void Reset()
+        {
+            ReadIndex.store(0, std::memory_order_relaxed);
+            WriteIndex.store(0, std::memory_order_relaxed);
+        }
+
+        std::size_t Capacity() const
+        {
+            return Samples.size();
+        }
+
+        std::size_t NumAvailable() const
+        {
+            return WriteIndex.load(std::memory_order_acquire) - ReadIndex.load(std::memory_order_acquire);
+        }
+
+        std::size_t NumFree() const
+        {
+            return Capacity() - NumAvailable();
+        }
+
+        /** Total samples ever read; a monotonically increasing stream position. */
+        std::size_t GetReadPosition() const
+        {
+            return ReadIndex.load(std::memory_order_acquire);
+        }
+
+        /** Total samples ever written. */
+        std::size_t GetWritePosition() const
+        {
+            return WriteIndex.load(std::memory_order_acquire);
+        }
+
+        /** Producer side. Returns the number of samples written; the rest did not fit. */
+        std::size_t Write(const float* In, std::size_t Num)
+        {
+            const std::size_t Write = WriteIndex.load(std::memory_order_relaxed);
+            const std::size_t Read = ReadIndex.load(std::memory_order_acquire);
+            Num = std::min(Num, Capacity() - (Write - Read));
+
+            const std::size_t Start = Write & Mask;
+            const std::size_t First = std::min(Num, Capacity() - Start);
+            std::copy(In, In + First, Samples.data() + Start);
+            std::copy(In + First, In + Num, Samples.data());
+
+            WriteIndex.store(Write + Num, std::memory_order_release);
+            return Num;
+        }
+
+        /** Consumer side. Returns the number of samples read. */
+        std::size_t Read(float* Out, std::size_t Num)
+        {
+            const std::size_t Read = ReadIndex.load(std::memory_order_relaxed);
+            const std::size_t Write = WriteIndex.load(std::memory_order_acquire);
+            Num = std::min(Num, Write - Read);
+
+            const std::size_t Start = Read & Mask;
+            const std::size_t First = std::min(Num, Capacity() - Start);
+            std::copy(Samples.data() + Start, Samples.data() + Start + First, Out);
+            std::copy(Samples.data(), Samples.data() + (Num - First), Out + First);
+
+            ReadIndex.store(Read + Num, std::memory_order_release);
+            return Num;
+        }
+
+        /** Consumer side. Drops up to Num of the oldest samples. */
+        std::size_t Discard(std::size_t Num)
+        {
+            const std::size_t Read = ReadIndex.load(std::memory_order_relaxed);
+            const std::size_t Write = WriteIndex.load(std::memory_order_acquire);
+            Num = std::min(Num, Write - Read);
+            ReadIndex.store(Read + Num, std::memory_order_release);
+            return Num;
+        }
+
+    private:
+        std::vector<float> Samples;
+        std::size_t Mask = 0;
+        std::atomic<std::size_t> ReadIndex{0};
+        std::atomic<std::size_t> WriteIndex{0};
+    };
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace NovaLink::Dsp
+{
+    /** Fixed-capacity lock-free single-producer/single-consumer queue for small event structs. */
+    template <typename T, std::size_t Capacity>
+    class TSpscQueue
+    {
+        static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        bool Push(const T& Item)
+        {
+            const std::size_t Write = WriteIndex.load(std::memory_order_relaxed);
+            if (Write - ReadIndex.load(std::memory_order_acquire) == Capacity)
+            {
+                return false;
+            }
+            Items[Write & (Capacity - 1)] = Item;
+            WriteIndex.store(Write + 1, std::memory_order_release);
+            return true;
+        }
+
+        /** Returns the oldest item without removing it, or nullptr when empty. */
+        const T* Peek() const
+        {
+            const std::size_t Read = ReadIndex.load(std::memory_order_relaxed);
+            if (Read == WriteIndex.load(std::memory_order_acquire))
+            {
+                return nullptr;
+            }
+            return &Items[Read & (Capacity - 1)];
+        }
+
+        void Pop()
+        {
+            const std::size_t Read = ReadIndex.load(std::memory_order_relaxed);
+            if (Read != WriteIndex.load(std::memory_order_acquire))
+            {
+                ReadIndex.store(Read + 1, std::memory_order_release);
+            }
+        }
+
+        /** Only safe while neither side is running. */
+        void Reset()
+        {
+            ReadIndex.store(0, std::memory_order_relaxed);
+            WriteIndex.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        std::array<T, Capacity> Items{};
+        std::atomic<std::size_t> ReadIndex{0};
+        std::atomic<std::size_t> WriteIndex{0};
+    };
+}
@@ -1,10 +1,9 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "NovaLinkChannel.h"
 #include "EmotionReceiver.generated.h"
 
-class IWebSocket;
-
 USTRUCT(BlueprintType)
 struct NOVALINK_API FNovaLinkEmotionData
 {
@@ -24,6 +23,18 @@ struct NOVALINK_API FNovaLinkEmotionData
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FNovaLinkEmotionUpdate, const FNovaLinkEmotionData&, EmotionData);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FNovaLinkEmotionConnectionStateChanged, bool, bIsConnected);
 
+/** Decode policy of the emotion channel: a JSON object of emotion name to weight (numbers or numeric strings). */
+struct NOVALINK_API FNovaLinkEmotionDecodePolicy
+{
+    static constexpr bool bBinaryMessages = false;
+
+    bool Decode(const FString& Message, FNovaLinkEmotionData& Out);
+    void Reset() {}
+};
+
+class UEmotionReceiver;
+using FNovaLinkEmotionChannel = TNovaLinkChannel<FNovaLinkEmotionData, FNovaLinkEmotionDecodePolicy, FNovaLinkImmediateQueue, TNovaLinkOwnerDelivery<UEmotionReceiver>>;
+
 UCLASS(BlueprintType)
 class NOVALINK_API UEmotionReceiver : public UObject
 {
@@ -36,6 +47,10 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Emotion")
     FString WebSocketUrl;
 
+    /** Agent whose emotion stream to follow; sent as the agent_id query parameter. Empty follows the server default agent. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Emotion")
+    FString AgentId;
+
     /** Invoked whenever a JSON emotion payload arrives. */
     UPROPERTY(BlueprintAssignable, Category = "NovaLink|Emotion")
     FNovaLinkEmotionUpdate OnEmotionUpdate;
@@ -57,15 +72,10 @@ public:
     bool IsConnected() const;
 
 private:
-    void HandleConnected();
-    void HandleConnectionError(const FString& Error);
-    void HandleClosed(int32 StatusCode, const FString& Reason, bool bWasClean);
-    void HandleMessage(const FString& Message);
-
-    void ResetWebSocket();
+    friend struct TNovaLinkOwnerDelivery<UEmotionReceiver>;
 
-    static bool TryParseEmotionMessage(const FString& Message, TMap<FString, float>& OutValues);
+    void DeliverPayload(const FNovaLinkEmotionData& EmotionData);
+    void HandleConnectionChanged(bool bConnected);
 
-    TSharedPtr<IWebSocket> WebSocket;
-    bool bIsConnected;
+    FNovaLinkEmotionChannel Channel{TEXT("EmotionReceiver"), this};
 };
@@ -0,0 +1,245 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IWebSocket.h"
+#include "Modules/ModuleManager.h"
+#include "NovaLinkFrameBudgetSubsystem.h"
+#include "WebSocketsModule.h"
+
+/**
+ * Delivers every decoded payload straight away, on the thread that received it (the game thread
+ * for UE websockets). A queue policy provides
+ *     void Push(PayloadType&& Payload, DeliveryPolicy& Delivery);
+ *     void Reset();
+ * and may hold payloads back, coalesce or drop them before calling Delivery.Deliver.
+ */
+struct FNovaLinkImmediateQueue
+{
+    template <typename PayloadType, typename DeliveryPolicy>
+    FORCEINLINE void Push(PayloadType&& Payload, DeliveryPolicy& Delivery)
+    {
+        Delivery.Deliver(Payload);
+    }
+
+    void Reset() {}
+};
+
+/**
+ * Hands payloads and connection changes to the UObject that owns the channel through
+ *     void DeliverPayload(const PayloadType& Payload);
+ *     void HandleConnectionChanged(bool bConnected);
+ * Owners keep these private and befriend this policy.
+ */
+template <typename OwnerType>
+struct TNovaLinkOwnerDelivery
+{
+    explicit TNovaLinkOwnerDelivery(OwnerType* InOwner)
+        : Owner(InOwner)
+    {
+    }
+
+    template <typename PayloadType>
+    FORCEINLINE void Deliver(const PayloadType& Payload)
+    {
+        Owner->DeliverPayload(Payload);
+    }
+
+    void ConnectionChanged(bool bConnected)
+    {
+        Owner->HandleConnectionChanged(bConnected);
+    }
+
+    OwnerType* Owner;
+};
+
+/**
+ * One NovaLink websocket stream: connection lifecycle, message reassembly and the receive path
+ * shared by every stream type. Stream types differ only in their policies, chosen at compile time,
+ * so each gets its own inlined receive path without virtual calls:
+ *
+ * - DecodePolicy turns one websocket message into a PayloadType. It declares
+ *   `static constexpr bool bBinaryMessages`, provides `bool Decode(const uint8*, int32, PayloadType&)`
+ *   for binary streams or `bool Decode(const FString&, PayloadType&)` for text streams, and
+ *   `void Reset()`, called whenever a connection opens. Messages it rejects are dropped.
+ * - QueuePolicy decides when decoded payloads are delivered (see FNovaLinkImmediateQueue).
+ * - DeliveryPolicy hands payloads and connection state to their consumer (see TNovaLinkOwnerDelivery).
+ *
+ * Channels live inside thin UObject wrappers (UAudioReceiver, UEmotionReceiver, UControlReceiver)
+ * that keep the Blueprint-facing properties and delegates.
+ */
+template <typename PayloadType, typename DecodePolicy, typename QueuePolicy, typename DeliveryPolicy>
+class TNovaLinkChannel
+{
+public:
+    template <typename... DeliveryArgs>
+    explicit TNovaLinkChannel(const TCHAR* InName, DeliveryArgs&&... Args)
+        : Name(InName)
+        , Delivery(Forward<DeliveryArgs>(Args)...)
+    {
+    }
+
+    ~TNovaLinkChannel()
+    {
+        Unbind();
+    }
+
+    TNovaLinkChannel(const TNovaLinkChannel&) = delete;
+    TNovaLinkChannel& operator=(const TNovaLinkChannel&) = delete;
+
+    /** Closes any open connection and connects to Url. */
+    void Start(const FString& Url)
+    {
+        if (Url.IsEmpty())
+        {
+            UE_LOG(LogTemp, Warning, TEXT("NovaLink %s requires a websocket URL."), Name);
+            return;
+        }
+
+        Stop();
+
+        FWebSocketsModule* Module = FModuleManager::GetModulePtr<FWebSocketsModule>("WebSockets");
+        if (!Module)
+        {
+            Module = &FModuleManager::LoadModuleChecked<FWebSocketsModule>("WebSockets");
+        }
+
+        WebSocket = Module->CreateWebSocket(Url);
+
+        WebSocket->OnConnected().AddRaw(this, &TNovaLinkChannel::HandleConnected);
+        WebSocket->OnConnectionError().AddRaw(this, &TNovaLinkChannel::HandleConnectionError);
+        WebSocket->OnClosed().AddRaw(this, &TNovaLinkChannel::HandleClosed);
+        if constexpr (DecodePolicy::bBinaryMessages)
+        {
+            WebSocket->OnRawMessage().AddRaw(this, &TNovaLinkChannel::HandleRawMessage);
+        }
+        else
+        {
+            WebSocket->OnMessage().AddRaw(this, &TNovaLinkChannel::HandleTextMessage);
+        }
+
+        WebSocket->Connect();
+    }
+
+    /** Closes the connection without notifying the delivery policy. */
+    void Stop()
+    {
+        Unbind();
+        if (WebSocket.IsValid() && WebSocket->IsConnected())
+        {
+            WebSocket->Close(1000, FString::Printf(TEXT("%s Stop"), Name));
+        }
+        Reset();
+    }
+
+    bool IsConnected() const { return bIsConnected; }
+
+    /** Sends a text message; false (with a warning) when not connected. */
+    bool Send(const FString& Message)
+    {
+        if (!WebSocket.IsValid() || !bIsConnected)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("NovaLink %s is not connected; dropping message."), Name);
+            return false;
+        }
+        WebSocket->Send(Message);
+        return true;
+    }
+
+    DecodePolicy& GetDecoder() { return Decoder; }
+    const DecodePolicy& GetDecoder() const { return Decoder; }
+    QueuePolicy& GetQueue() { return Queue; }
+    DeliveryPolicy& GetDelivery() { return Delivery; }
+
+private:
+    void Unbind()
+    {
+        if (WebSocket.IsValid())
+        {
+            WebSocket->OnConnected().RemoveAll(this);
+            WebSocket->OnConnectionError().RemoveAll(this);
+            WebSocket->OnClosed().RemoveAll(this);
+            WebSocket->OnRawMessage().RemoveAll(this);
+            WebSocket->OnMessage().RemoveAll(this);
+        }
+    }
+
+    void Reset()
+    {
+        Unbind();
+        WebSocket.Reset();
+        bIsConnected = false;
+        PartialMessage.Reset();
+        Queue.Reset();
+    }
+
+    void HandleConnected()
+    {
+        bIsConnected = true;
+        PartialMessage.Reset();
+        Decoder.Reset();
+        Delivery.ConnectionChanged(true);
+    }
+
+    void HandleConnectionError(const FString& Error)
+    {
+        UE_LOG(LogTemp, Error, TEXT("NovaLink %s connection error: %s"), Name, *Error);
+        Reset();
+        Delivery.ConnectionChanged(false);
+    }
+
+    void HandleClosed(int32 StatusCode, const FString& Reason, bool bWasClean)
+    {
+        Reset();
+        Delivery.ConnectionChanged(false);
+    }
+
+    void HandleRawMessage(const void* Data, SIZE_T Size, SIZE_T BytesRemaining)
+    {
+        if (!Data || Size == 0)
+        {
+            return;
+        }
+
+        const uint8* ByteData = static_cast<const uint8*>(Data);
+        if (BytesRemaining > 0 || PartialMessage.Num() > 0)
+        {
+            // Reassemble websocket messages delivered in several fragments.
+            PartialMessage.Append(ByteData, static_cast<int32>(Size));
+            if (BytesRemaining > 0)
+            {
+                return;
+            }
+            Receive(PartialMessage.GetData(), PartialMessage.Num());
+            // Keep the allocation for the next fragmented message.
+            PartialMessage.Reset();
+            return;
+        }
+
+        Receive(ByteData, static_cast<int32>(Size));
+    }
+
+    void HandleTextMessage(const FString& Message)
+    {
+        Receive(Message);
+    }
+
+    template <typename... MessageArgs>
+    FORCEINLINE void Receive(const MessageArgs&... Message)
+    {
+        FNovaLinkFrameCostScope CostScope;
+        PayloadType Payload;
+        if (Decoder.Decode(Message..., Payload))
+        {
+            Queue.Push(MoveTemp(Payload), Delivery);
+        }
+    }
+
+    const TCHAR* Name;
+    TSharedPtr<IWebSocket> WebSocket;
+    bool bIsConnected = false;
+    TArray<uint8> PartialMessage;
+
+    DecodePolicy Decoder;
+    QueuePolicy Queue;
+    DeliveryPolicy Delivery;
+};
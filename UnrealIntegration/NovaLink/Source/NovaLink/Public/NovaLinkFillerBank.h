@@ -0,0 +1,40 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "NovaLinkFillerBank.generated.h"
+
+class USoundBase;
+
+USTRUCT(BlueprintType)
+struct NOVALINK_API FNovaLinkFillerClips
+{
+    GENERATED_BODY()
+
+    /** Short prebaked sounds (breaths, "hmm", "let me see") for one emotion. */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NovaLink|Filler")
+    TArray<TObjectPtr<USoundBase>> Clips;
+};
+
+/**
+ * Local filler sounds played while the server produces a reply, keyed by the emotion names the
+ * server uses (e.g. "happy", "thinking"). Keep clips short and trailing off, as they are faded
+ * out once the real voice arrives.
+ */
+UCLASS(BlueprintType)
+class NOVALINK_API UNovaLinkFillerBank : public UPrimaryDataAsset
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NovaLink|Filler")
+    TMap<FString, FNovaLinkFillerClips> ClipsByEmotion;
+
+    /** Emotion used when the requested one has no clips. */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NovaLink|Filler")
+    FString FallbackEmotion = TEXT("neutral");
+
+    /** Picks a clip for Emotion, avoiding Previous when there is a choice. Null if the bank has none. */
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Filler")
+    USoundBase* PickClip(const FString& Emotion, const USoundBase* Previous = nullptr) const;
+};
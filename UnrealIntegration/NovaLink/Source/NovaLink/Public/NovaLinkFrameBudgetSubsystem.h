@@ -0,0 +1,114 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "NovaLinkFrameBudgetSubsystem.generated.h"
+
+/** Optional NovaLink work the frame-budget governor may run less often. Audio playback is never shed. */
+UENUM(BlueprintType)
+enum class ENovaLinkOptionalWork : uint8
+{
+    /** Viseme evaluation in the lip sync subsystem. */
+    VisemeAnalysis,
+    /** Emotion weight smoothing in animation Blueprints fed by OnEmotionUpdate. */
+    EmotionSmoothing,
+    /** On-screen and logged NovaLink statistics. */
+    DebugTelemetry
+};
+
+/**
+ * Game-thread time guard for NovaLink. Code that runs on the game thread wraps its work in an
+ * FNovaLinkFrameCostScope; at the end of every frame the summed cost is compared to FrameBudgetMs.
+ *
+ * After FramesToShed consecutive frames over budget the shed level rises by one: optional work
+ * (ENovaLinkOptionalWork) then runs every second frame, and at the highest level every fourth frame
+ * with telemetry off. Once the smoothed cost has stayed below RestoreRatio * FrameBudgetMs for
+ * FramesToRestore frames the level drops again. Voice rendering, jitter buffering and receive
+ * paths are only measured, never throttled.
+ */
+UCLASS(Config = Game)
+class NOVALINK_API UNovaLinkFrameBudgetSubsystem : public UEngineSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static constexpr int32 MaxShedLevel = 2;
+
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Budget")
+    bool bEnabled = true;
+
+    /** Game-thread milliseconds NovaLink may use per frame before optional work is shed. */
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Budget", meta = (ClampMin = "0.01"))
+    float FrameBudgetMs = 0.5f;
+
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Budget", meta = (ClampMin = "1"))
+    int32 FramesToShed = 3;
+
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Budget", meta = (ClampMin = "1"))
+    int32 FramesToRestore = 60;
+
+    /** Headroom needed before restoring work, as a fraction of the budget; keeps levels from flapping. */
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Budget", meta = (ClampMin = "0.1", ClampMax = "1.0"))
+    float RestoreRatio = 0.6f;
+
+    /** Show the measured cost and shed level on screen (itself DebugTelemetry work). */
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Budget")
+    bool bShowDebugStats = false;
+
+    /** Whether Work should run this frame at the current shed level. */
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Budget")
+    bool ShouldRunOptionalWork(ENovaLinkOptionalWork Work) const;
+
+    /** Frames between runs of Work at the current level; zero means it is off. */
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Budget")
+    int32 GetOptionalWorkInterval(ENovaLinkOptionalWork Work) const;
+
+    /** 0 runs everything; MaxShedLevel sheds the most. */
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Budget")
+    int32 GetShedLevel() const { return ShedLevel; }
+
+    /** Smoothed NovaLink game-thread cost per frame. */
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Budget")
+    float GetAverageFrameCostMs() const { return AverageCostMs; }
+
+    /** The engine's governor, or null before the engine is up. */
+    static UNovaLinkFrameBudgetSubsystem* Get();
+
+    /** Shorthand for Get()->ShouldRunOptionalWork(Work) that runs everything without a governor. */
+    static bool ShouldRun(ENovaLinkOptionalWork Work);
+
+    /** Adds game-thread time spent on NovaLink to the current frame; FNovaLinkFrameCostScope calls it. */
+    static void AddFrameCost(uint64 Cycles);
+
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+
+private:
+    void HandleEndFrame();
+    void SetShedLevel(int32 NewLevel);
+
+    FDelegateHandle EndFrameHandle;
+    int32 ShedLevel = 0;
+    int32 FramesOverBudget = 0;
+    int32 FramesWithHeadroom = 0;
+    float AverageCostMs = 0.0f;
+
+    static uint64 PendingCycles;
+};
+
+/** Measures the enclosing game-thread scope as NovaLink frame cost. Nested scopes count once. */
+class NOVALINK_API FNovaLinkFrameCostScope
+{
+public:
+    FNovaLinkFrameCostScope();
+    ~FNovaLinkFrameCostScope();
+
+    FNovaLinkFrameCostScope(const FNovaLinkFrameCostScope&) = delete;
+    FNovaLinkFrameCostScope& operator=(const FNovaLinkFrameCostScope&) = delete;
+
+private:
+    uint64 StartCycles = 0;
+    bool bOutermost = false;
+
+    static int32 Depth;
+};
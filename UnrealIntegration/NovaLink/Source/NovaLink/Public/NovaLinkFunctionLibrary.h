@@ -4,6 +4,7 @@
 #include "NovaLinkFunctionLibrary.generated.h"
 
 class UAudioReceiver;
+class UControlReceiver;
 class UEmotionReceiver;
 
 UCLASS()
@@ -20,11 +21,19 @@ public:
     UFUNCTION(BlueprintCallable, Category = "NovaLink", meta = (WorldContext = "WorldContextObject"))
     static UEmotionReceiver* CreateEmotionReceiver(UObject* WorldContextObject);
 
+    /** Creates a new Control Receiver object for server status and control messages. */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink", meta = (WorldContext = "WorldContextObject"))
+    static UControlReceiver* CreateControlReceiver(UObject* WorldContextObject);
+
     /** Convenience Blueprint node for testing audio connections. */
     UFUNCTION(BlueprintCallable, Category = "NovaLink", meta = (WorldContext = "WorldContextObject"))
-    static void ConnectAudio(UObject* WorldContextObject, UAudioReceiver*& OutReceiver, const FString& Url = TEXT("ws://localhost:5000/ws/audio"));
+    static void ConnectAudio(UObject* WorldContextObject, UAudioReceiver*& OutReceiver, const FString& Url = TEXT("ws://localhost:5000/ws/audio"), const FString& AgentId = TEXT(""));
 
     /** Convenience Blueprint node for testing emotion connections. */
     UFUNCTION(BlueprintCallable, Category = "NovaLink", meta = (WorldContext = "WorldContextObject"))
-    static void ConnectEmotion(UObject* WorldContextObject, UEmotionReceiver*& OutReceiver, const FString& Url = TEXT("ws://localhost:5000/ws/emotion"));
+    static void ConnectEmotion(UObject* WorldContextObject, UEmotionReceiver*& OutReceiver, const FString& Url = TEXT("ws://localhost:5000/ws/emotion"), const FString& AgentId = TEXT(""));
+
+    /** Convenience Blueprint node for connecting to the server control channel. */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink", meta = (WorldContext = "WorldContextObject"))
+    static void ConnectControl(UObject* WorldContextObject, UControlReceiver*& OutReceiver, const FString& Url = TEXT("ws://localhost:5000/ws/control"));
 };
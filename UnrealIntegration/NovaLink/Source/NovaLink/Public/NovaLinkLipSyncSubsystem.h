@@ -0,0 +1,100 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/Coarticulation.h"
+#include "NovaLinkVoicePoolSubsystem.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NovaLinkLipSyncSubsystem.generated.h"
+
+/** Blueprint mirror of NovaLink::Dsp::EViseme. */
+UENUM(BlueprintType)
+enum class ENovaLinkViseme : uint8
+{
+    Sil,
+    PP,
+    FF,
+    TH,
+    DD,
+    KK,
+    CH,
+    SS,
+    NN,
+    RR,
+    AA,
+    E,
+    IH,
+    OH,
+    OU
+};
+
+/** One phoneme of an utterance, timed from the start of that utterance's audio. */
+USTRUCT(BlueprintType)
+struct NOVALINK_API FNovaLinkPhonemeTiming
+{
+    GENERATED_BODY()
+
+    /** ARPAbet symbol, e.g. "AA1" or "P"; unknown symbols count as silence. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|LipSync")
+    FString Phoneme;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|LipSync")
+    float StartSeconds = 0.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|LipSync")
+    float EndSeconds = 0.0f;
+};
+
+/**
+ * Text-aligned lip sync for pooled voices. Phoneme timings queued per voice become viseme curves
+ * through a dominance-function coarticulation model, so lip closures are hit exactly while vowels
+ * and rounding blend into their neighbours.
+ *
+ * Once per frame every active voice is evaluated in one pass at its playback position (the samples
+ * its slot has handed to the mixer), which costs far less than classifying visemes from audio.
+ */
+UCLASS()
+class NOVALINK_API UNovaLinkLipSyncSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    /** Audio output delay subtracted from the playback position, so mouths match what is heard. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|LipSync")
+    float OutputLatencyMs = 20.0f;
+
+    /**
+     * Adds an utterance's phonemes to Voice's track. StreamOffsetSeconds places the utterance on the
+     * voice's stream; a negative value means "where the next received audio lands", which is correct
+     * when phonemes are queued before the utterance's first chunk arrives.
+     */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|LipSync")
+    void QueuePhonemes(const FNovaLinkVoiceHandle& Voice, const TArray<FNovaLinkPhonemeTiming>& Phonemes, float StreamOffsetSeconds = -1.0f);
+
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|LipSync")
+    void ClearPhonemes(const FNovaLinkVoiceHandle& Voice);
+
+    /** Current weights indexed by ENovaLinkViseme; they sum to one. Empty for unknown voices. */
+    UFUNCTION(BlueprintPure, Category = "NovaLink|LipSync")
+    TArray<float> GetVisemeWeights(const FNovaLinkVoiceHandle& Voice) const;
+
+    UFUNCTION(BlueprintPure, Category = "NovaLink|LipSync")
+    float GetVisemeWeight(const FNovaLinkVoiceHandle& Voice, ENovaLinkViseme Viseme) const;
+
+    /** Native access to the NumVisemes weights of Voice; null for unknown voices. */
+    const float* FindVisemeWeights(const FNovaLinkVoiceHandle& Voice) const;
+
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+private:
+    UNovaLinkVoicePoolSubsystem* GetPool() const;
+    bool EnsureTrack(const FNovaLinkVoiceHandle& Voice);
+
+    NovaLink::Dsp::FCoarticulationEngine Engine;
+
+    /** Parallel to pool slots: lease generation each track belongs to (INDEX_NONE when unused). */
+    TArray<int32> TrackGenerations;
+    TArray<float> TrackTimes;
+    TArray<float> Weights;
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SynthComponent.h"
+#include "NovaLinkVoicePoolSubsystem.h"
+
+#include <atomic>
+
+#include "NovaLinkVoiceComponent.generated.h"
+
+class FNovaLinkVoiceSlot;
+class UAudioComponent;
+class UNovaLinkFillerBank;
+class USoundBase;
+class USoundWave;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FNovaLinkFillerLatencyMeasured, float, TimeToFillerMs, float, TimeToVoiceMs);
+
+/**
+ * Plays a pooled NovaLink voice through the audio mixer. Attach it to the NPC, then AttachVoice()
+ * with the handle from UNovaLinkVoicePoolSubsystem::AcquireVoice.
+ *
+ * Rendering pulls from the slot's jitter buffer on the audio render thread, so lost frames and
+ * late audio are concealed there instead of clicking. Releasing the handle detaches the component
+ * (DetachVoice()) before the pool rewinds the slot.
+ *
+ * BeginFiller() masks server latency: it plays a local clip from FillerBank right away and
+ * crossfades into the voice when its first chunk arrives.
+ */
+UCLASS(ClassGroup = (NovaLink), meta = (BlueprintSpawnableComponent))
+class NOVALINK_API UNovaLinkVoiceComponent : public USynthComponent
+{
+    GENERATED_BODY()
+
+public:
+    UNovaLinkVoiceComponent(const FObjectInitializer& ObjectInitializer);
+
+    /** Clips BeginFiller chooses from. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Filler")
+    TObjectPtr<UNovaLinkFillerBank> FillerBank;
+
+    /** Overlap between the fading filler and the voice fading in. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NovaLink|Filler", meta = (ClampMin = "0"))
+    float FillerCrossfadeMs = 120.0f;
+
+    /** Fires once the voice takes over from a filler, with both latencies measured from BeginFiller. */
+    UPROPERTY(BlueprintAssignable, Category = "NovaLink|Filler")
+    FNovaLinkFillerLatencyMeasured OnFillerLatencyMeasured;
+
+    /** Starts rendering the leased voice. Returns false for a stale handle. */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|Voice")
+    bool AttachVoice(const FNovaLinkVoiceHandle& Handle);
+
+    /** Stops rendering; the component outputs silence until another voice is attached. */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|Voice")
+    void DetachVoice();
+
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Voice")
+    FNovaLinkVoiceHandle GetAttachedVoice() const { return AttachedHandle; }
+
+    /**
+     * Plays a filler for Emotion; call it as the turn is submitted. Returns false if the bank has no
+     * clip or the voice is already speaking.
+     */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|Filler")
+    bool BeginFiller(const FString& Emotion);
+
+    /** Fades out a playing filler, e.g. when the turn failed. */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|Filler")
+    void CancelFiller();
+
+    /** Milliseconds from the last BeginFiller until the mixer started playing the filler; negative if none yet. */
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Filler")
+    float GetLastTimeToFillerMs() const { return LastTimeToFillerMs; }
+
+    /** Milliseconds from the last BeginFiller until the voice's first chunk arrived; negative if none yet. */
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Filler")
+    float GetLastTimeToVoiceMs() const { return LastTimeToVoiceMs; }
+
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+    virtual bool Init(int32& SampleRate) override;
+    virtual int32 OnGenerateAudio(float* OutAudio, int32 NumSamples) override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+    UAudioComponent* GetOrCreateFillerAudio();
+    void HandleFillerPlayback(const UAudioComponent* Component, const USoundWave* Wave, const float Percent);
+    void ApplyVoiceFadeIn(float* OutAudio, int32 NumSamples);
+    bool IsSpeechPlaying() const;
+
+    FNovaLinkVoiceHandle AttachedHandle;
+
+    /** Guards Slot between the game thread (attach/detach) and the render callback. */
+    FCriticalSection SlotLock;
+    FNovaLinkVoiceSlot* Slot = nullptr;
+
+    UPROPERTY(Transient)
+    TObjectPtr<UAudioComponent> FillerAudio;
+
+    UPROPERTY(Transient)
+    TObjectPtr<USoundBase> LastFillerClip;
+
+    double FillerRequestTime = 0.0;
+    uint64 SamplesAtFillerRequest = 0;
+    bool bAwaitingVoice = false;
+    bool bFillerAudible = false;
+    float LastTimeToFillerMs = -1.0f;
+    float LastTimeToVoiceMs = -1.0f;
+
+    /** Set on the game thread when a filler starts; the render thread then fades the next voice in. */
+    std::atomic<bool> bFadeInNextVoice{false};
+    std::atomic<int32> FadeInLength{0};
+    /** Buffer position when the filler started; speech written from here on gets the fade-in. */
+    std::atomic<uint64> FadeInAfterSample{0};
+    int32 RenderSampleRate = 48000;
+    int32 FadeInPosition = 0;
+    bool bFadingIn = false;
+};
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AudioReceiver.h"
+#include "Containers/Ticker.h"
+#include "NovaLinkVoiceSlot.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "NovaLinkVoicePoolSubsystem.generated.h"
+
+class UControlReceiver;
+class UNovaLinkVoiceComponent;
+
+/** Lease on a pooled voice slot. Becomes stale once the slot is released. */
+USTRUCT(BlueprintType)
+struct NOVALINK_API FNovaLinkVoiceHandle
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Voice")
+    int32 SlotIndex = INDEX_NONE;
+
+    UPROPERTY(BlueprintReadOnly, Category = "NovaLink|Voice")
+    int32 Generation = 0;
+
+    bool IsSet() const { return SlotIndex != INDEX_NONE; }
+};
+
+/**
+ * Pool of pre-initialised voice slots for spawning and despawning NPCs without allocation.
+ *
+ * Each slot owns an audio receiver (the agent's channel subscription), a ring buffer, a resampler
+ * and a level analyzer, all created when the pool is prewarmed. AcquireVoice leases a slot for an
+ * agent and ReleaseVoice returns it. With bKeepConnectionsWarm, released slots stay subscribed, so an
+ * agent that respawns gets its old slot back without reconnecting.
+ */
+UCLASS(Config = Game)
+class NOVALINK_API UNovaLinkVoicePoolSubsystem : public UGameInstanceSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    /** Slots created when the game instance starts. */
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Voice")
+    int32 InitialPoolSize = 8;
+
+    /** Create extra slots when the pool runs dry instead of failing the lease. */
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Voice")
+    bool bAllowGrowth = true;
+
+    /** Keep released slots connected so the same agent can re-lease them without a reconnect. */
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Voice")
+    bool bKeepConnectionsWarm = true;
+
+    /** Audio endpoint used when AcquireVoice gets no URL. */
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Voice")
+    FString DefaultAudioUrl = TEXT("ws://localhost:5000/ws/audio");
+
+    /** Frame duration pooled receivers negotiate; slots always request framed audio. */
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Voice")
+    int32 FrameMs = 20;
+
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Voice")
+    int32 MaxLatencyMs = 30;
+
+    /** Expected server sample rate; frame headers override it per slot. */
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Voice")
+    int32 SourceSampleRate = 24000;
+
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Voice")
+    int32 OutputSampleRate = 48000;
+
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Voice")
+    float BufferSeconds = 2.0f;
+
+    /** Audio held back before a voice starts (or restarts after an underrun) to ride out network jitter. */
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Voice")
+    float JitterBufferMs = 60.0f;
+
+    /** Lost frames up to this long are concealed by extending the voice; longer gaps play as silence. */
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Voice")
+    float MaxConcealMs = 500.0f;
+
+    /**
+     * Ask the server to replace silent frames with compact silence markers (dtx=1). Pauses then cost
+     * almost no bandwidth, and the jitter buffer uses them to shed or rebuild its latency cushion.
+     */
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Voice")
+    bool bSilenceSuppression = true;
+
+    /** Amplitude of the noise that fills pauses and faded-out concealment; 0 plays digital silence. */
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Voice", meta = (ClampMin = "0.0", ClampMax = "0.1"))
+    float ComfortNoiseLevel = 0.0f;
+
+    /** Let the server adapt each voice's codec and sample rate to the link once a feedback channel is set. */
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Voice")
+    bool bAdaptiveBitrate = true;
+
+    /** How often link feedback and RTT pings go out over the feedback channel. */
+    UPROPERTY(Config, EditAnywhere, Category = "NovaLink|Voice", meta = (ClampMin = "0.1"))
+    float FeedbackIntervalSeconds = 1.0f;
+
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+
+    /** Ensures at least NumSlots slots exist. */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|Voice")
+    void Prewarm(int32 NumSlots);
+
+    /** Leases a slot streaming AgentId's audio. Returns an unset handle if the pool is exhausted. */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|Voice")
+    FNovaLinkVoiceHandle AcquireVoice(const FString& AgentId, const FString& Url = TEXT(""));
+
+    /** Returns the slot to the pool and clears Handle. Voice components still rendering it are detached first. */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|Voice")
+    void ReleaseVoice(UPARAM(ref) FNovaLinkVoiceHandle& Handle);
+
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Voice")
+    bool IsVoiceValid(const FNovaLinkVoiceHandle& Handle) const;
+
+    /** Receiver of a leased slot, e.g. to watch its connection state. Do not stop or rebind it. */
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Voice")
+    UAudioReceiver* GetVoiceReceiver(const FNovaLinkVoiceHandle& Handle) const;
+
+    /** Smoothed level of the voice's audio, handy for simple jaw or VU animation. */
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Voice")
+    float GetVoiceEnvelope(const FNovaLinkVoiceHandle& Handle) const;
+
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Voice")
+    float GetVoiceBufferedSeconds(const FNovaLinkVoiceHandle& Handle) const;
+
+    /** Seconds of lost or late audio the voice has concealed since it was acquired. */
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Voice")
+    float GetVoiceConcealedSeconds(const FNovaLinkVoiceHandle& Handle) const;
+
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Voice")
+    int32 GetNumActiveVoices() const;
+
+    UFUNCTION(BlueprintPure, Category = "NovaLink|Voice")
+    int32 GetNumFreeVoices() const { return FreeSlots.Num(); }
+
+    /**
+     * Control connection that reports receive rate, jitter buffer depth, underruns, losses and RTT for
+     * the pooled voices. Voices connected afterwards stream with adaptive bitrate.
+     */
+    UFUNCTION(BlueprintCallable, Category = "NovaLink|Voice")
+    void SetFeedbackChannel(UControlReceiver* Control);
+
+    /** Native access for the playback path; null for stale handles. */
+    FNovaLinkVoiceSlot* FindSlot(const FNovaLinkVoiceHandle& Handle) const;
+
+    /** Tracks a component rendering Handle's slot, so ReleaseVoice can detach it before rewinding the slot. */
+    void AddVoiceComponent(const FNovaLinkVoiceHandle& Handle, UNovaLinkVoiceComponent* Component);
+    void RemoveVoiceComponent(const FNovaLinkVoiceHandle& Handle, UNovaLinkVoiceComponent* Component);
+
+private:
+    int32 CreateSlot();
+    int32 TakeFreeSlot(const FString& AgentId, const FString& Url);
+    void HandleSlotAudio(const FNovaLinkAudioFrameInfo& Info, const uint8* Payload, int32 Size, int32 SlotIndex);
+    bool TickFeedback(float DeltaTime);
+
+    /** Counters last sampled from one slot, so feedback totals survive reconnects and releases. */
+    struct FFeedbackSample
+    {
+        uint64 BytesReceived = 0;
+        uint32 Underruns = 0;
+        int32 LostFrames = 0;
+    };
+
+    TArray<TUniquePtr<FNovaLinkVoiceSlot>> Slots;
+
+    /** Receivers parallel to Slots; kept here so GC never collects a pooled subscription. */
+    UPROPERTY(Transient)
+    TArray<TObjectPtr<UAudioReceiver>> Receivers;
+
+    TArray<int32> FreeSlots;
+
+    /** Voice components attached to each slot index; they render it on the audio thread. */
+    TMultiMap<int32, TWeakObjectPtr<UNovaLinkVoiceComponent>> VoiceComponents;
+
+    UPROPERTY(Transient)
+    TObjectPtr<UControlReceiver> FeedbackChannel;
+
+    FTSTicker::FDelegateHandle FeedbackTicker;
+    TArray<FFeedbackSample> FeedbackSamples;
+    double LastFeedbackTime = 0.0;
+    int32 TotalUnderruns = 0;
+    int32 TotalLostFrames = 0;
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/EnvelopeAnalyzer.h"
+#include "Core/FrameHeader.h"
+#include "Core/JitterBuffer.h"
+#include "Core/LinearResampler.h"
+
+/** Buffer sizes and rates every pooled voice slot is initialised with. */
+struct FNovaLinkVoiceSlotSettings
+{
+    /** Sample rate of the PCM16 stream sent by the server. */
+    int32 SourceSampleRate = 24000;
+
+    /** Sample rate the slot resamples to; match the audio mixer. */
+    int32 OutputSampleRate = 48000;
+
+    /** Seconds of resampled audio the ring buffer can hold. */
+    float BufferSeconds = 2.0f;
+
+    /** Largest websocket chunk, in source samples, the scratch buffers are sized for up front. */
+    int32 MaxChunkSamples = 8192;
+
+    /** Audio buffered before playback (re)starts; absorbs network jitter. */
+    float TargetLatencyMs = 60.0f;
+
+    /** Buffered audio beyond this is dropped back to the target, so clock drift cannot pile up delay. */
+    float MaxLatencyMs = 400.0f;
+
+    /** Longest run of lost frames that is concealed; longer gaps are treated as silence. */
+    float MaxConcealMs = 500.0f;
+
+    NovaLink::Dsp::FConcealerSettings Concealment;
+};
+
+/**
+ * Per-agent playback state leased from UNovaLinkVoicePoolSubsystem: jitter buffer, resampler,
+ * packet loss concealer and level analyzer. Everything is allocated in Initialize(); Reset() only
+ * rewinds state, so leasing a slot again costs no allocations.
+ *
+ * PushPcm16/PushFrame/PushSilence/MarkLost are the producer side (game thread, where websocket
+ * messages arrive) and RenderAudio/ReadAudio the single consumer (the audio render thread).
+ */
+class NOVALINK_API FNovaLinkVoiceSlot
+{
+public:
+    void Initialize(const FNovaLinkVoiceSlotSettings& InSettings);
+
+    /** Rewinds buffers and analyzers for the next lease. Call only while nothing renders the slot. */
+    void Reset();
+
+    /** Decodes, resamples and buffers a little-endian PCM16 chunk. Returns the output samples dropped on overflow. */
+    int32 PushPcm16(const uint8* Data, int32 NumBytes);
+
+    /** Like PushPcm16 for a frame payload in any codec the frame header can announce. */
+    int32 PushFrame(NovaLink::Dsp::EFrameCodec Codec, const uint8* Data, int32 NumBytes);
+
+    /** Buffers a silence marker (EFrameCodec::Silence) of NumSourceSamples; the jitter buffer may stretch or shorten it. */
+    void PushSilence(int32 NumSourceSamples);
+
+    /** Records NumSourceSamples of missing audio at the current stream position, to be concealed on playback. */
+    void MarkLost(int32 NumSourceSamples);
+
+    /** Follows a change of the server's sample rate (announced in frame headers). */
+    void SetSourceSampleRate(int32 SampleRate);
+
+    int32 GetSourceSampleRate() const { return Settings.SourceSampleRate; }
+
+    /**
+     * Fills all NumSamples of Out for playback: buffered audio, concealment for lost frames and
+     * underruns, or silence while (re)buffering. Returns how many samples were real audio.
+     */
+    int32 RenderAudio(float* Out, int32 NumSamples);
+
+    /** Pops up to NumSamples resampled samples into Out without concealment; returns how many were available. */
+    int32 ReadAudio(float* Out, int32 NumSamples);
+
+    /** Smoothed output level of the most recent audio, in [0, 1]. */
+    float GetEnvelope() const { return Analyzer.GetEnvelope(); }
+
+    /** Seconds of audio buffered for playback. */
+    float GetBufferedSeconds() const;
+
+    /** Seconds of audio synthesised by concealment since the lease began. */
+    float GetConcealedSeconds() const;
+
+    /** Times playback ran dry mid-speech and recovered before the concealment faded out. */
+    uint32 GetUnderrunCount() const { return Buffer.GetUnderrunCount(); }
+
+    int32 GetOutputSampleRate() const { return Settings.OutputSampleRate; }
+
+    /** Output samples buffered since the lease began; grows as soon as a chunk arrives. */
+    uint64 GetSamplesReceived() const { return Buffer.GetWritePosition(); }
+
+    /** Output samples handed to playback since the lease began: the stream's playback clock. */
+    uint64 GetSamplesPlayed() const { return Buffer.GetReadPosition(); }
+
+    /** Output samples of speech buffered since the lease began; silence markers do not count. */
+    uint64 GetSpeechSamplesReceived() const { return Buffer.GetSpeechSamples(); }
+
+    /** Position, on the GetSamplesPlayed() clock, where the latest run of speech begins. Safe on the render thread. */
+    uint64 GetSpeechStartPosition() const { return Buffer.GetSpeechStartPosition(); }
+
+    /**
+     * GetSamplesReceived()/GetSamplesPlayed() with every pause at the length the server sent, so times
+     * in the server's audio (phoneme timings) stay aligned although the jitter buffer stretches and
+     * trims pauses. Game thread only; GetStreamSamplesPlayed() must be sampled as playback advances.
+     */
+    uint64 GetStreamSamplesReceived() const { return Buffer.GetStreamWritePosition(); }
+    uint64 GetStreamSamplesPlayed() { return Buffer.ToStreamPosition(Buffer.GetReadPosition()); }
+
+    /** Agent the slot is, or was last, leased to. */
+    FString AgentId;
+
+    /** Server URL the slot's receiver was last connected to. */
+    FString Url;
+
+    /** Incremented on every release so stale handles stop resolving. */
+    int32 Generation = 0;
+
+    bool bInUse = false;
+
+private:
+    void GrowScratch(int32 NumSourceSamples);
+
+    FNovaLinkVoiceSlotSettings Settings;
+    NovaLink::Dsp::FJitterBuffer Buffer;
+    NovaLink::Dsp::FLinearResampler Resampler;
+    NovaLink::Dsp::FEnvelopeAnalyzer Analyzer;
+    TArray<float> DecodeScratch;
+    TArray<float> ResampleScratch;
+};
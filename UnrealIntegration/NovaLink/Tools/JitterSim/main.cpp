@@ -0,0 +1,453 @@
+// Offline jitter-buffer policy sweep over recorded audio arrival traces.
+//
+// Replays a trace written by UAudioReceiver::StopArrivalTrace() through the plugin's own
+// FJitterBuffer and FLinearResampler (Source/NovaLink/Public/Core), silence markers included, for
+// every combination of TargetLatencyMs and MaxLatencyMs, in parallel, and prints one CSV row per
+// policy. See README.md.
+
+#include "Core/FrameHeader.h"
+#include "Core/JitterBuffer.h"
+#include "Core/LinearResampler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using NovaLink::Dsp::EFrameCodec;
+    using NovaLink::Dsp::FJitterBuffer;
+    using NovaLink::Dsp::FJitterBufferSettings;
+    using NovaLink::Dsp::FLinearResampler;
+
+    struct FTraceFrame
+    {
+        double ArrivalMs = 0.0;
+        std::uint32_t Sequence = 0;
+        int SampleRate = 0;
+        int SampleCount = 0;
+        /** EFrameCodec id; 2 marks a silence marker (DTX). Traces without the column are all audio. */
+        int Codec = 0;
+    };
+
+    struct FOptions
+    {
+        std::string TracePath;
+        std::string OutPath;
+        int OutputRate = 48000;
+        int BlockSamples = 480;
+        double DriftPpm = 0.0;
+        float MaxConcealMs = 500.0f;
+        std::vector<float> Targets = {20, 40, 60, 80, 100, 150, 200};
+        std::vector<float> MaxLatencies = {150, 200, 300, 400, 600, 800};
+        unsigned Threads = 0;
+    };
+
+    struct FPolicyResult
+    {
+        float TargetLatencyMs = 0.0f;
+        float MaxLatencyMs = 0.0f;
+        double MeanLatencyMs = 0.0;
+        double P95LatencyMs = 0.0;
+        double PeakLatencyMs = 0.0;
+        std::uint32_t Underruns = 0;
+        double ConcealedMs = 0.0;
+        double DiscardedMs = 0.0;
+        bool bPareto = false;
+    };
+
+    void PrintUsage()
+    {
+        std::cerr
+            << "usage: jitter_sim TRACE.csv [options]\n"
+               "  --targets LIST        TargetLatencyMs values, 'a,b,c' or 'start:stop:step'\n"
+               "  --max-latency LIST    MaxLatencyMs values, same syntax\n"
+               "  --output-rate HZ      render sample rate (48000)\n"
+               "  --block SAMPLES       render block size (480)\n"
+               "  --drift-ppm PPM       render clock error against the server clock; positive plays slower (0)\n"
+               "  --conceal-ms MS       MaxConcealMs (500)\n"
+               "  --threads N           worker threads (all cores)\n"
+               "  --out FILE            write the CSV to FILE instead of stdout\n";
+    }
+
+    bool ParseList(const std::string& Text, std::vector<float>& Out)
+    {
+        Out.clear();
+        float Start = 0.0f;
+        float Stop = 0.0f;
+        float Step = 0.0f;
+        char Colon1 = 0;
+        char Colon2 = 0;
+        std::istringstream Range(Text);
+        if (Text.find(':') != std::string::npos)
+        {
+            if (!(Range >> Start >> Colon1 >> Stop >> Colon2 >> Step) || Colon1 != ':' || Colon2 != ':' || Step <= 0.0f)
+            {
+                return false;
+            }
+            for (float Value = Start; Value <= Stop + Step * 0.001f; Value += Step)
+            {
+                Out.push_back(Value);
+            }
+            return !Out.empty();
+        }
+
+        std::istringstream Items(Text);
+        std::string Item;
+        while (std::getline(Items, Item, ','))
+        {
+            char* End = nullptr;
+            const float Value = std::strtof(Item.c_str(), &End);
+            if (End == Item.c_str())
+            {
+                return false;
+            }
+            Out.push_back(Value);
+        }
+        return !Out.empty();
+    }
+
+    bool ParseArgs(int Argc, char** Argv, FOptions& Options)
+    {
+        for (int Index = 1; Index < Argc; ++Index)
+        {
+            const std::string Arg = Argv[Index];
+            const bool bHasValue = Index + 1 < Argc;
+            if (Arg.rfind("--", 0) != 0)
+            {
+                Options.TracePath = Arg;
+                continue;
+            }
+            if (!bHasValue)
+            {
+                std::cerr << "missing value for " << Arg << "\n";
+                return false;
+            }
+            const std::string Value = Argv[++Index];
+            bool bValid = true;
+            if (Arg == "--targets")
+            {
+                bValid = ParseList(Value, Options.Targets);
+            }
+            else if (Arg == "--max-latency")
+            {
+                bValid = ParseList(Value, Options.MaxLatencies);
+            }
+            else if (Arg == "--output-rate")
+            {
+                Options.OutputRate = std::atoi(Value.c_str());
+                bValid = Options.OutputRate > 0;
+            }
+            else if (Arg == "--block")
+            {
+                Options.BlockSamples = std::atoi(Value.c_str());
+                bValid = Options.BlockSamples > 0;
+            }
+            else if (Arg == "--drift-ppm")
+            {
+                Options.DriftPpm = std::atof(Value.c_str());
+            }
+            else if (Arg == "--conceal-ms")
+            {
+                Options.MaxConcealMs = static_cast<float>(std::atof(Value.c_str()));
+            }
+            else if (Arg == "--threads")
+            {
+                Options.Threads = static_cast<unsigned>(std::max(1, std::atoi(Value.c_str())));
+            }
+            else if (Arg == "--out")
+            {
+                Options.OutPath = Value;
+            }
+            else
+            {
+                std::cerr << "unknown option " << Arg << "\n";
+                return false;
+            }
+            if (!bValid)
+            {
+                std::cerr << "invalid value for " << Arg << ": " << Value << "\n";
+                return false;
+            }
+        }
+        return !Options.TracePath.empty();
+    }
+
+    /** Reads arrival_ms,sequence,sample_rate,sample_count[,codec] rows; the header line is optional. */
+    bool LoadTrace(const std::string& Path, std::vector<FTraceFrame>& Frames)
+    {
+        std::ifstream File(Path);
+        if (!File)
+        {
+            std::cerr << "cannot open " << Path << "\n";
+            return false;
+        }
+        std::string Line;
+        int LineNumber = 0;
+        while (std::getline(File, Line))
+        {
+            ++LineNumber;
+            if (Line.empty() || Line[0] == '#' || (LineNumber == 1 && Line.find("arrival_ms") != std::string::npos))
+            {
+                continue;
+            }
+            FTraceFrame Frame;
+            unsigned long Sequence = 0;
+            const int NumFields = std::sscanf(
+                Line.c_str(), "%lf,%lu,%d,%d,%d", &Frame.ArrivalMs, &Sequence, &Frame.SampleRate, &Frame.SampleCount, &Frame.Codec);
+            if (NumFields < 4 || Frame.SampleRate <= 0 || Frame.SampleCount <= 0)
+            {
+                std::cerr << Path << ":" << LineNumber << ": malformed row\n";
+                return false;
+            }
+            Frame.Sequence = static_cast<std::uint32_t>(Sequence);
+            Frames.push_back(Frame);
+        }
+        std::stable_sort(Frames.begin(), Frames.end(),
+            [](const FTraceFrame& A, const FTraceFrame& B) { return A.ArrivalMs < B.ArrivalMs; });
+        if (Frames.empty())
+        {
+            std::cerr << Path << ": no frames\n";
+            return false;
+        }
+        return true;
+    }
+
+    /** Speech-like test signal (two partials under a syllable-rate envelope) so concealment has a pitch to repeat. */
+    float SourceSample(double Seconds)
+    {
+        constexpr double TwoPi = 6.283185307179586;
+        const double Envelope = 0.55 + 0.45 * std::sin(TwoPi * 4.0 * Seconds);
+        return static_cast<float>(Envelope * (0.25 * std::sin(TwoPi * 140.0 * Seconds) + 0.1 * std::sin(TwoPi * 420.0 * Seconds)));
+    }
+
+    FPolicyResult Simulate(const std::vector<FTraceFrame>& Frames, const FOptions& Options, float TargetLatencyMs, float MaxLatencyMs)
+    {
+        FJitterBufferSettings Settings;
+        Settings.SampleRate = Options.OutputRate;
+        Settings.TargetLatencyMs = TargetLatencyMs;
+        Settings.MaxLatencyMs = MaxLatencyMs;
+        Settings.MaxConcealMs = Options.MaxConcealMs;
+        FJitterBuffer Buffer;
+        Buffer.Configure(Settings);
+
+        FLinearResampler Resampler;
+        int SourceRate = 0;
+        double SourceSeconds = 0.0;
+
+        struct FPendingFrame
+        {
+            std::size_t EndPosition;
+            double ArrivalMs;
+        };
+        std::vector<FPendingFrame> Pending;
+        std::size_t PendingHead = 0;
+        std::vector<double> Latencies;
+        Latencies.reserve(Frames.size());
+
+        std::vector<float> Source;
+        std::vector<float> Resampled;
+        std::vector<float> Block(static_cast<std::size_t>(Options.BlockSamples));
+
+        // Same sequence bookkeeping as FNovaLinkAudioDecodePolicy::Decode.
+        bool bHasSequence = false;
+        std::uint32_t ExpectedSequence = 0;
+
+        const double BlockMs = 1000.0 * Options.BlockSamples / Options.OutputRate * (1.0 + Options.DriftPpm * 1e-6);
+        const double EndMs = Frames.back().ArrivalMs + Settings.CapacitySeconds * 1000.0 + Options.MaxConcealMs;
+        std::size_t NextFrame = 0;
+
+        for (std::uint64_t BlockIndex = 0;; ++BlockIndex)
+        {
+            const double NowMs = static_cast<double>(BlockIndex) * BlockMs;
+            for (; NextFrame < Frames.size() && Frames[NextFrame].ArrivalMs <= NowMs; ++NextFrame)
+            {
+                const FTraceFrame& Frame = Frames[NextFrame];
+                if (Frame.SampleRate != SourceRate)
+                {
+                    SourceRate = Frame.SampleRate;
+                    Resampler.SetRates(SourceRate, Options.OutputRate);
+                }
+                if (bHasSequence && Frame.Sequence != ExpectedSequence)
+                {
+                    const std::uint32_t Gap = Frame.Sequence - ExpectedSequence;
+                    if (Gap < 0x80000000u)
+                    {
+                        const std::size_t LostSource = static_cast<std::size_t>(Gap) * Frame.SampleCount;
+                        Buffer.MarkLost(LostSource * Options.OutputRate / SourceRate);
+                        SourceSeconds += static_cast<double>(LostSource) / SourceRate;
+                    }
+                }
+                ExpectedSequence = Frame.Sequence + 1;
+                bHasSequence = true;
+
+                if (Frame.Codec == static_cast<int>(EFrameCodec::Silence))
+                {
+                    // As FNovaLinkVoiceSlot::PushSilence: the buffer may stretch or trim the pause.
+                    Resampler.Reset();
+                    Buffer.WriteSilence(static_cast<std::size_t>(Frame.SampleCount) * Options.OutputRate / SourceRate);
+                    SourceSeconds += static_cast<double>(Frame.SampleCount) / SourceRate;
+                    continue;
+                }
+
+                Source.resize(static_cast<std::size_t>(Frame.SampleCount));
+                for (std::size_t Index = 0; Index < Source.size(); ++Index)
+                {
+                    Source[Index] = SourceSample(SourceSeconds + static_cast<double>(Index) / SourceRate);
+                }
+                SourceSeconds += static_cast<double>(Frame.SampleCount) / SourceRate;
+
+                Resampled.resize(Resampler.MaxOutputFor(Source.size()));
+                const std::size_t NumOut = Resampler.Process(Source.data(), Source.size(), Resampled.data(), Resampled.size());
+                Buffer.Write(Resampled.data(), NumOut);
+                Pending.push_back({Buffer.GetWritePosition(), Frame.ArrivalMs});
+            }
+
+            // A drift trim happens at the start of Render and drops [ReadBefore, ReadBefore + Discarded).
+            const std::size_t ReadBefore = Buffer.GetReadPosition();
+            const std::uint64_t DiscardedBefore = Buffer.GetDiscardedSamples();
+            Buffer.Render(Block.data(), Block.size());
+            const std::size_t DiscardEnd = ReadBefore + static_cast<std::size_t>(Buffer.GetDiscardedSamples() - DiscardedBefore);
+            const std::size_t ReadAfter = Buffer.GetReadPosition();
+            for (; PendingHead < Pending.size() && Pending[PendingHead].EndPosition <= ReadAfter; ++PendingHead)
+            {
+                if (Pending[PendingHead].EndPosition > DiscardEnd)
+                {
+                    // The frame's last sample left the buffer during this block.
+                    Latencies.push_back(NowMs - Pending[PendingHead].ArrivalMs);
+                }
+            }
+
+            const bool bDrained = NextFrame == Frames.size() && Buffer.NumBuffered() == 0;
+            if (bDrained || NowMs > EndMs)
+            {
+                break;
+            }
+        }
+
+        FPolicyResult Result;
+        Result.TargetLatencyMs = TargetLatencyMs;
+        Result.MaxLatencyMs = MaxLatencyMs;
+        Result.Underruns = Buffer.GetUnderrunCount();
+        Result.ConcealedMs = 1000.0 * Buffer.GetConcealedSamples() / Options.OutputRate;
+        Result.DiscardedMs = 1000.0 * Buffer.GetDiscardedSamples() / Options.OutputRate;
+        if (!Latencies.empty())
+        {
+            double Sum = 0.0;
+            for (const double Latency : Latencies)
+            {
+                Sum += Latency;
+            }
+            Result.MeanLatencyMs = Sum / Latencies.size();
+            const std::size_t P95 = std::min(Latencies.size() - 1, static_cast<std::size_t>(std::ceil(Latencies.size() * 0.95)) - 1);
+            std::nth_element(Latencies.begin(), Latencies.begin() + P95, Latencies.end());
+            Result.P95LatencyMs = Latencies[P95];
+            Result.PeakLatencyMs = *std::max_element(Latencies.begin() + P95, Latencies.end());
+        }
+        return Result;
+    }
+
+    /** Flags policies no other policy beats on both p95 latency and concealed audio. */
+    void MarkParetoFront(std::vector<FPolicyResult>& Results)
+    {
+        for (FPolicyResult& Candidate : Results)
+        {
+            Candidate.bPareto = std::none_of(Results.begin(), Results.end(), [&Candidate](const FPolicyResult& Other) {
+                const bool bNoWorse = Other.P95LatencyMs <= Candidate.P95LatencyMs && Other.ConcealedMs <= Candidate.ConcealedMs;
+                const bool bBetter = Other.P95LatencyMs < Candidate.P95LatencyMs || Other.ConcealedMs < Candidate.ConcealedMs;
+                return bNoWorse && bBetter;
+            });
+        }
+    }
+
+    void WriteCsv(std::ostream& Out, const std::vector<FPolicyResult>& Results)
+    {
+        Out << "target_latency_ms,max_latency_ms,mean_latency_ms,p95_latency_ms,peak_latency_ms,underruns,concealed_ms,discarded_ms,pareto\n";
+        char Row[256];
+        for (const FPolicyResult& Result : Results)
+        {
+            std::snprintf(Row, sizeof(Row), "%g,%g,%.2f,%.2f,%.2f,%u,%.1f,%.1f,%d\n", Result.TargetLatencyMs, Result.MaxLatencyMs,
+                Result.MeanLatencyMs, Result.P95LatencyMs, Result.PeakLatencyMs, Result.Underruns, Result.ConcealedMs,
+                Result.DiscardedMs, Result.bPareto ? 1 : 0);
+            Out << Row;
+        }
+    }
+}
+
+int main(int Argc, char** Argv)
+{
+    FOptions Options;
+    if (!ParseArgs(Argc, Argv, Options))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    std::vector<FTraceFrame> Frames;
+    if (!LoadTrace(Options.TracePath, Frames))
+    {
+        return 1;
+    }
+
+    // A maximum at or below the target would trim on every block.
+    std::vector<FPolicyResult> Results;
+    for (const float Target : Options.Targets)
+    {
+        for (const float MaxLatency : Options.MaxLatencies)
+        {
+            if (MaxLatency > Target)
+            {
+                Results.push_back({Target, MaxLatency});
+            }
+        }
+    }
+    if (Results.empty())
+    {
+        std::cerr << "no policy has MaxLatencyMs above TargetLatencyMs\n";
+        return 2;
+    }
+
+    const unsigned NumThreads = std::min<unsigned>(
+        Options.Threads ? Options.Threads : std::max(1u, std::thread::hardware_concurrency()), static_cast<unsigned>(Results.size()));
+    std::atomic<std::size_t> NextPolicy{0};
+    std::vector<std::thread> Workers;
+    for (unsigned Worker = 0; Worker < NumThreads; ++Worker)
+    {
+        Workers.emplace_back([&] {
+            for (std::size_t Index = NextPolicy++; Index < Results.size(); Index = NextPolicy++)
+            {
+                Results[Index] = Simulate(Frames, Options, Results[Index].TargetLatencyMs, Results[Index].MaxLatencyMs);
+            }
+        });
+    }
+    for (std::thread& Worker : Workers)
+    {
+        Worker.join();
+    }
+    MarkParetoFront(Results);
+
+    std::cerr << Frames.size() << " frames over " << (Frames.back().ArrivalMs - Frames.front().ArrivalMs) / 1000.0 << " s, "
+              << Results.size() << " policies on " << NumThreads << " threads\n";
+    if (Options.OutPath.empty())
+    {
+        WriteCsv(std::cout, Results);
+        return 0;
+    }
+    std::ofstream Out(Options.OutPath);
+    WriteCsv(Out, Results);
+    if (!Out)
+    {
+        std::cerr << "cannot write " << Options.OutPath << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,178 @@
+"""Admission control for turns: bounded concurrency with queue-time estimates."""
+from __future__ import annotations
+
+import asyncio
+import heapq
+import itertools
+import logging
+import time
+from collections import deque
+from contextlib import asynccontextmanager
+from dataclasses import dataclass, field
+from typing import AsyncIterator, Callable, Deque, Dict, Optional, Set
+
+logger = logging.getLogger(__name__)
+
+
+@dataclass
+class AdmissionConfig:
+    """How many turns run at once and how long a new one may be asked to wait."""
+
+    enabled: bool = True
+    # Turns running LLM + TTS at the same time; the rest wait in arrival order.
+    max_concurrent_turns: int = 2
+    # Admitted turns waiting for a slot beyond which new turns are rejected.
+    max_queue: int = 8
+    # Turns whose estimated start is further away than this are rejected.
+    max_wait_s: float = 10.0
+    # Smoothing of the measured turn duration (weight of the newest turn).
+    ewma_alpha: float = 0.3
+    # Turn duration assumed until the first turns have been measured.
+    initial_turn_s: float = 3.0
+
+
+@dataclass
+class AdmissionTicket:
+    """An admitted turn that has not finished yet."""
+
+    id: int
+    admitted_at: float
+
+
+@dataclass
+class AdmissionDecision:
+    admitted: bool
+    # Seconds until the turn is expected to start running.
+    estimated_start_s: float
+    # Admitted turns that were waiting for a slot when this one arrived.
+    queue_position: int
+    # Smoothed duration of recent turns, the basis of the estimate.
+    turn_s: float
+    reason: Optional[str] = None
+    ticket: Optional[AdmissionTicket] = field(default=None, repr=False)
+
+    def to_message(self) -> Dict[str, object]:
+        """Fields of the ``admission`` control message."""
+        message: Dict[str, object] = {
+            "admitted": self.admitted,
+            "estimated_start_ms": int(round(self.estimated_start_s * 1000.0)),
+            "queue_position": self.queue_position,
+            "turn_ms": int(round(self.turn_s * 1000.0)),
+        }
+        if self.reason:
+            message["reason"] = self.reason
+        return message
+
+
+class AdmissionController:
+    """Tracks inference capacity and decides up front whether a turn can be served in time.
+
+    At most ``max_concurrent_turns`` turns run at once; admitted turns wait
+    for a slot in arrival order. The duration of finished turns feeds an
+    exponentially weighted moving average, and :meth:`try_admit` replays the
+    running and queued turns against it to estimate when a new turn would
+    start. Turns that would wait longer than ``max_wait_s``, or find the
+    queue full, are rejected at once so the client can fall back instead of
+    waiting in silence.
+
+    Not thread-safe: use it from the orchestrator loop only.
+    """
+
+    def __init__(self, config: Optional[AdmissionConfig] = None, clock: Callable[[], float] = time.monotonic) -> None:
+        self.config = config or AdmissionConfig()
+        self._clock = clock
+        self._turn_s = max(0.0, self.config.initial_turn_s)
+        self._ids = itertools.count()
+        self._queued: Set[int] = set()
+        self._running: Dict[int, float] = {}
+        self._waiting: Deque[int] = deque()
+        self._changed: Optional[asyncio.Condition] = None
+        self._loop: Optional[asyncio.AbstractEventLoop] = None
+
+    @property
+    def capacity(self) -> int:
+        return max(1, self.config.max_concurrent_turns) if self.config.enabled else 1 << 30
+
+    @property
+    def turn_seconds(self) -> float:
+        """Smoothed duration of recent turns."""
+        return self._turn_s
+
+    @property
+    def running(self) -> int:
+        return len(self._running)
+
+    @property
+    def queued(self) -> int:
+        return len(self._queued)
+
+    def estimate_start(self) -> float:
+        """Seconds until a turn admitted now would start running."""
+        now = self._clock()
+        free_at = [max(0.0, self._turn_s - (now - started)) for started in self._running.values()]
+        free_at += [0.0] * max(0, self.capacity - len(free_at))
+        heapq.heapify(free_at)
+        # Every queued turn takes the next slot to free up and holds it for one average turn.
+        for _ in range(len(self._queued)):
+            heapq.heappush(free_at, heapq.heappop(free_at) + self._turn_s)
+        return free_at[0]
+
+    def try_admit(self) -> AdmissionDecision:
+        """Admits a turn if it can start within ``max_wait_s``; the ticket goes to :meth:`turn`."""
+        estimate = self.estimate_start()
+        position = len(self._queued)
+        reason = None
+        if self.config.enabled and estimate > 0.0:
+            if position >= self.config.max_queue:
+                reason = "queue full"
+            elif estimate > self.config.max_wait_s:
+                reason = "busy"
+        if reason is not None:
+            logger.info("Rejected turn (%s): %s queued, start in %.1fs", reason, position, estimate)
+            return AdmissionDecision(False, estimate, position, self._turn_s, reason)
+        return AdmissionDecision(True, estimate, position, self._turn_s, ticket=self.admit())
+
+    def admit(self) -> AdmissionTicket:
+        """Admits a turn unconditionally (local callers that cannot fall back)."""
+        ticket = AdmissionTicket(next(self._ids), self._clock())
+        self._queued.add(ticket.id)
+        return ticket
+
+    def withdraw(self, ticket: AdmissionTicket) -> None:
+        """Forgets an admitted turn that will never run; no-op once it has started."""
+        self._queued.discard(ticket.id)
+
+    @asynccontextmanager
+    async def turn(self, ticket: AdmissionTicket) -> AsyncIterator[None]:
+        """Waits for a free slot, then holds it while the turn runs."""
+        loop = asyncio.get_running_loop()
+        if self._loop is not loop:
+            # Conditions bind to the loop that first waits on them.
+            self._changed = asyncio.Condition()
+            self._loop = loop
+        async with self._changed:
+            self._waiting.append(ticket.id)
+            try:
+                await self._changed.wait_for(
+                    lambda: self._waiting[0] == ticket.id and len(self._running) < self.capacity
+                )
+            finally:
+                self._waiting.remove(ticket.id)
+                self._queued.discard(ticket.id)
+                self._changed.notify_all()
+            started = self._clock()
+            self._running[ticket.id] = started
+        completed = False
+        try:
+            yield
+            completed = True
+        finally:
+            del self._running[ticket.id]
+            if completed:
+                self._record(self._clock() - started)
+            async with self._changed:
+                self._changed.notify_all()
+
+    def _record(self, seconds: float) -> None:
+        alpha = min(1.0, max(0.0, self.config.ewma_alpha))
+        self._turn_s += alpha * (seconds - self._turn_s)
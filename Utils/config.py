@@ -7,6 +7,10 @@ from pathlib import Path
 from LLM.engine import LLMConfig
 from Server.streaming import StreamConfig
 from TTS.kani_engine import KaniTTSConfig
+from Utils.admission import AdmissionConfig
+from Utils.cpu import CPUConfig
+from Utils.determinism import DeterminismConfig
+from Utils.history import HistoryConfig
 from Utils.orchestrator import OrchestratorConfig
 
 
@@ -19,5 +23,19 @@ def load_orchestrator_config(config_path: Path) -> OrchestratorConfig:
     model_dir = Path(tts_section.pop("model_dir"))
     tts_cfg = KaniTTSConfig(model_dir=model_dir, **tts_section)
     stream_cfg = StreamConfig(**data.get("stream", {}))
+    history_cfg = HistoryConfig(**data.get("history", {}))
+    cpu_cfg = CPUConfig(**data.get("cpu", {}))
+    determinism_cfg = DeterminismConfig(**data.get("determinism", {}))
+    admission_cfg = AdmissionConfig(**data.get("admission", {}))
 
-    return OrchestratorConfig(llm=llm_cfg, tts=tts_cfg, stream=stream_cfg)
+    return OrchestratorConfig(
+        llm=llm_cfg,
+        tts=tts_cfg,
+        stream=stream_cfg,
+        history=history_cfg,
+        cpu=cpu_cfg,
+        determinism=determinism_cfg,
+        admission=admission_cfg,
+        agent_voices=dict(data.get("agent_voices", {})),
+        session_idle_s=data.get("session_idle_s", OrchestratorConfig.session_idle_s),
+    )
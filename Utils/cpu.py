@@ -0,0 +1,47 @@
+"""Thread and core settings for CPU-only inference."""
+from __future__ import annotations
+
+import logging
+import os
+from dataclasses import dataclass
+from typing import List, Optional
+
+import torch
+
+logger = logging.getLogger(__name__)
+
+
+@dataclass
+class CPUConfig:
+    """How torch uses the host CPU when models run without a GPU."""
+
+    # Intra-op threads per matmul; ``None`` keeps torch's default (all cores).
+    threads: Optional[int] = None
+    # Threads for running independent ops concurrently.
+    interop_threads: Optional[int] = None
+    # Restrict the process to these logical cores (Linux only). Pinning to
+    # physical cores of one socket avoids SMT siblings fighting over caches.
+    pin_cores: Optional[List[int]] = None
+
+
+def configure_cpu_inference(config: CPUConfig) -> None:
+    """Applies ``config`` to the current process. Safe to call repeatedly."""
+    if config.pin_cores:
+        if hasattr(os, "sched_setaffinity"):
+            os.sched_setaffinity(0, set(config.pin_cores))
+            logger.info("Pinned inference to cores %s", sorted(config.pin_cores))
+        else:
+            logger.warning("Core pinning is not supported on this platform; ignoring pin_cores")
+
+    threads = config.threads
+    if threads is None and config.pin_cores:
+        threads = len(config.pin_cores)
+    if threads:
+        torch.set_num_threads(threads)
+    if config.interop_threads:
+        try:
+            torch.set_num_interop_threads(config.interop_threads)
+        except RuntimeError:
+            # Only settable before the first inter-op parallel work starts.
+            logger.warning("Inter-op threads already initialised; keeping %s", torch.get_num_interop_threads())
+    logger.info("Torch CPU threads: intra-op %s, inter-op %s", torch.get_num_threads(), torch.get_num_interop_threads())
@@ -0,0 +1,61 @@
+"""Deterministic mode for reproducible latency and throughput runs.
+
+With ``determinism.enabled`` the server:
+
+* seeds Python, NumPy and torch once at start-up and asks torch for
+  deterministic kernels;
+* decodes LLM replies greedily instead of sampling;
+* samples every TTS utterance from its own seed, derived from the base seed,
+  the voice and the text (see :func:`utterance_seed`). The audio of a
+  sentence therefore does not depend on what was spoken before it or on
+  which session spoke it;
+* decodes every TTS stream's codec on its own (``tts.decode_batch_wait_ms``
+  is ignored), so concurrent sessions cannot change each other's audio;
+* optionally answers from ``canned_replies`` (see :class:`LLM.canned.CannedLLMEngine`)
+  instead of running the LLM at all.
+
+The same script then yields identical text, emotions and PCM on every run.
+Frame boundaries of framed audio clients still depend on timing when
+``max_latency_ms`` flushes partial frames; the concatenated samples do not.
+"""
+from __future__ import annotations
+
+import logging
+import random
+import zlib
+from dataclasses import dataclass
+from typing import Optional
+
+import numpy as np
+import torch
+
+logger = logging.getLogger(__name__)
+
+
+@dataclass
+class DeterminismConfig:
+    enabled: bool = False
+    seed: int = 1234
+    # JSON file of replies that stands in for the LLM; ``None`` keeps the model.
+    canned_replies: Optional[str] = None
+
+
+def configure_determinism(config: DeterminismConfig) -> None:
+    """Seeds every RNG and selects deterministic torch kernels. No-op unless enabled."""
+    if not config.enabled:
+        return
+    random.seed(config.seed)
+    np.random.seed(config.seed % 2**32)
+    torch.manual_seed(config.seed)
+    # Kernels without a deterministic variant only warn; their output is rarely order dependent on CPU.
+    torch.use_deterministic_algorithms(True, warn_only=True)
+    if hasattr(torch.backends, "cudnn"):
+        torch.backends.cudnn.benchmark = False
+        torch.backends.cudnn.deterministic = True
+    logger.info("Deterministic mode enabled with seed %s", config.seed)
+
+
+def utterance_seed(seed: int, *parts: str) -> int:
+    """Stable 31-bit seed for ``parts`` (unlike ``hash()``, identical across processes)."""
+    digest = zlib.crc32("\x00".join(parts).encode("utf-8"), seed & 0xFFFFFFFF)
+    return digest & 0x7FFFFFFF
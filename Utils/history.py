@@ -0,0 +1,106 @@
+"""Token-bounded chat history with a rolling summary of older turns."""
+from __future__ import annotations
+
+import asyncio
+import logging
+from dataclasses import dataclass
+from typing import Awaitable, Callable, Dict, List, Optional, Tuple
+
+logger = logging.getLogger(__name__)
+
+Turn = Dict[str, str]
+TokenCounter = Callable[[str], int]
+Summarizer = Callable[[str, List[Turn]], Awaitable[str]]
+
+
+@dataclass
+class HistoryConfig:
+    """Limits for the history passed to the LLM on every turn."""
+
+    # Token budget for the summary plus the verbatim turns in the prompt.
+    max_history_tokens: int = 1024
+    # Newest turns that are never folded into the summary.
+    keep_recent_turns: int = 4
+    # Upper bound on the length of the generated summary.
+    summary_max_tokens: int = 160
+
+
+class ChatHistoryManager:
+    """Keeps recent turns verbatim and folds older ones into a summary.
+
+    Once the verbatim turns outgrow their share of ``max_history_tokens``,
+    :meth:`maybe_fold` starts a background task that summarises everything
+    except the newest ``keep_recent_turns`` turns. The summarizer usually runs
+    between turns. Until it finishes, :meth:`prompt_context` drops the oldest
+    verbatim turns, so the prompt never exceeds the budget however long the
+    session runs.
+    """
+
+    def __init__(self, config: Optional[HistoryConfig] = None, count_tokens: Optional[TokenCounter] = None) -> None:
+        self.config = config or HistoryConfig()
+        self._count_tokens = count_tokens or (lambda text: len(text) // 4 + 1)
+        self.summary = ""
+        self._summary_tokens = 0
+        self._turns: List[Turn] = []
+        self._turn_tokens: List[int] = []
+        self._fold_task: Optional[asyncio.Task] = None
+
+    @property
+    def turns(self) -> List[Turn]:
+        return list(self._turns)
+
+    def __len__(self) -> int:
+        return len(self._turns)
+
+    def append(self, user_message: str, assistant_reply: str) -> None:
+        self._turns.append({"user": user_message, "assistant": assistant_reply})
+        self._turn_tokens.append(self._count_tokens(user_message) + self._count_tokens(assistant_reply))
+
+    def prompt_context(self) -> Tuple[List[Turn], Optional[str]]:
+        """Returns ``(recent_turns, summary)`` that fit the token budget."""
+        budget = self.config.max_history_tokens - self._summary_tokens
+        selected = 0
+        used = 0
+        for tokens in reversed(self._turn_tokens):
+            if used + tokens > budget:
+                break
+            used += tokens
+            selected += 1
+        if selected < len(self._turns):
+            logger.debug("Trimming %s unsummarised turns from the prompt", len(self._turns) - selected)
+        recent = self._turns[len(self._turns) - selected:] if selected else []
+        return recent, self.summary or None
+
+    def needs_fold(self) -> bool:
+        if len(self._turns) <= self.config.keep_recent_turns:
+            return False
+        verbatim_budget = self.config.max_history_tokens - self.config.summary_max_tokens
+        return sum(self._turn_tokens) > verbatim_budget
+
+    def maybe_fold(self, summarize: Summarizer) -> Optional[asyncio.Task]:
+        """Starts a background fold if the verbatim turns exceed their budget."""
+        if self._fold_task is not None and not self._fold_task.done():
+            return self._fold_task
+        if not self.needs_fold():
+            return None
+        fold_count = len(self._turns) - self.config.keep_recent_turns
+        self._fold_task = asyncio.create_task(self._fold(summarize, fold_count))
+        return self._fold_task
+
+    async def wait_for_fold(self) -> None:
+        if self._fold_task is not None:
+            await asyncio.shield(self._fold_task)
+
+    async def _fold(self, summarize: Summarizer, fold_count: int) -> None:
+        folded = self._turns[:fold_count]
+        try:
+            summary = await summarize(self.summary, folded)
+        except Exception:
+            logger.exception("History summarisation failed; keeping verbatim turns")
+            return
+        # New turns are only ever appended, so the folded ones are still first.
+        del self._turns[:fold_count]
+        del self._turn_tokens[:fold_count]
+        self.summary = summary
+        self._summary_tokens = self._count_tokens(summary) if summary else 0
+        logger.debug("Folded %s turns into a %s-token summary", fold_count, self._summary_tokens)
@@ -0,0 +1,24 @@
+"""Checkpoint loading helpers shared by the LLM and TTS engines."""
+from __future__ import annotations
+
+from pathlib import Path
+from typing import Dict, Union
+
+
+def safetensors_kwargs(reference: Union[str, Path]) -> Dict[str, bool]:
+    """Return ``from_pretrained`` kwargs forcing memory-mapped safetensors.
+
+    Only local folders that actually ship ``*.safetensors`` files opt in;
+    Hugging Face repo ids and ``.bin`` checkpoints keep the library default.
+    """
+    directory = Path(str(reference)).expanduser()
+    if directory.is_dir() and any(directory.glob("*.safetensors")):
+        return {"use_safetensors": True}
+    return {}
+
+
+def quantize_dynamic_int8(model):
+    """Swap the ``nn.Linear`` layers of ``model`` for int8 CPU kernels in place."""
+    import torch
+
+    return torch.ao.quantization.quantize_dynamic(model, {torch.nn.Linear}, dtype=torch.qint8, inplace=True)
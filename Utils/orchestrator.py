@@ -2,14 +2,23 @@
 from __future__ import annotations
 
 import asyncio
+import copy
 import logging
-from dataclasses import dataclass, field
-from typing import Dict, List, Optional, Protocol
+import time
+from dataclasses import dataclass, field, replace
+from typing import Any, Dict, List, Optional, Protocol
 
+from LLM.canned import CannedLLMEngine
 from LLM.engine import LLMConfig, LLMEngine
 from Server.streaming import StreamConfig, StreamServer, StreamingServer
 from TTS.kani_engine import KaniTTSConfig, KaniTTSEngine
+from TTS.kani_tts.audio.pcm import release_pcm
+from Utils.admission import AdmissionConfig, AdmissionController, AdmissionTicket
+from Utils.cpu import CPUConfig, configure_cpu_inference
+from Utils.determinism import DeterminismConfig, configure_determinism, utterance_seed
 from Utils.emotions import EmotionMapper
+from Utils.history import ChatHistoryManager, HistoryConfig
+from Utils.sessions import ConversationSession, SessionManager
 
 logger = logging.getLogger(__name__)
 
@@ -19,6 +28,14 @@ class OrchestratorConfig:
     llm: LLMConfig
     tts: KaniTTSConfig
     stream: StreamConfig = field(default_factory=StreamConfig)
+    history: HistoryConfig = field(default_factory=HistoryConfig)
+    cpu: CPUConfig = field(default_factory=CPUConfig)
+    determinism: DeterminismConfig = field(default_factory=DeterminismConfig)
+    admission: AdmissionConfig = field(default_factory=AdmissionConfig)
+    # TTS voice per agent id; agents not listed speak in ``tts.voice``.
+    agent_voices: Dict[str, str] = field(default_factory=dict)
+    # Sessions without a turn for this long are dropped; ``None`` keeps them until ended.
+    session_idle_s: Optional[float] = 1800.0
 
 
 class OrchestratorEventSink(Protocol):
@@ -34,7 +51,16 @@ class TTSInitializationError(RuntimeError):
 
 
 class VoiceAgentOrchestrator:
-    """Glue object binding all sub systems together."""
+    """Glue object binding all sub systems together.
+
+    Each conversation is a :class:`ConversationSession` with its own chat
+    history, routed to one agent's audio/emotion streams. Turns in the same
+    session run in order, and turns in different sessions run concurrently,
+    up to the admission limit (see :mod:`Utils.admission`). Turns come from
+    :meth:`process_text` or from ``turn`` messages on the control channel;
+    the latter are answered at once with an ``admission`` message carrying
+    the estimated start, or a rejection when the server is saturated.
+    """
 
     def __init__(
         self,
@@ -42,15 +68,23 @@ class VoiceAgentOrchestrator:
         event_sink: Optional[OrchestratorEventSink] = None,
     ):
         self.config = config
-        self.llm = LLMEngine(config.llm)
-        self.tts = KaniTTSEngine(config.tts)
+        self._emotion_mapper = EmotionMapper()
+        self.llm = self._create_llm()
+        self.tts = self._create_tts()
         self.event_sink = event_sink
         self.stream_server = StreamServer(
             config.stream,
             on_audio_client_count_changed=self._handle_audio_client_count,
             on_emotion_client_count_changed=self._handle_emotion_client_count,
+            on_control_message=self._handle_control_message,
+            audio_sample_rate=config.tts.sample_rate,
         )
-        self._emotion_mapper = EmotionMapper()
+        self.sessions = SessionManager(
+            lambda: ChatHistoryManager(config.history, count_tokens=self.llm.count_tokens),
+            idle_timeout_s=config.session_idle_s,
+        )
+        self.admission = AdmissionController(config.admission)
+        self._loop: Optional[asyncio.AbstractEventLoop] = None
         self._streaming_server = StreamingServer(
             self.stream_server.app,
             config.stream.host,
@@ -58,19 +92,35 @@ class VoiceAgentOrchestrator:
         )
         self._started = False
 
+    def _create_llm(self):
+        determinism = self.config.determinism
+        if determinism.enabled and determinism.canned_replies:
+            return CannedLLMEngine(determinism.canned_replies)
+        llm_config = replace(self.config.llm, do_sample=False) if determinism.enabled else self.config.llm
+        return LLMEngine(llm_config, emotions=list(self._emotion_mapper.emotion_map))
+
+    def _create_tts(self) -> KaniTTSEngine:
+        tts_config = self.config.tts
+        if self.config.determinism.enabled and tts_config.decode_batch_wait_ms is not None:
+            # A batched codec pass mixes in whatever other streams are speaking; decode each stream alone.
+            tts_config = copy.copy(tts_config)
+            tts_config.decode_batch_wait_ms = None
+        return KaniTTSEngine(tts_config)
+
     async def start(self) -> None:
+        """Brings the stream server up, then loads and warms all models.
+
+        The server starts first so NovaLink clients can connect and follow
+        the ``loading`` → ``warming`` → ``ready`` status on the control
+        channel. The LLM and TTS models load concurrently on worker threads.
+        """
         if self._started:
             logger.debug("Orchestrator already started")
             return
         logger.info("Starting orchestrator")
-        self.llm.load()
-        try:
-            await self.tts.load()
-        except Exception as exc:
-            raise TTSInitializationError(str(exc)) from exc
-        self._server_task = asyncio.create_task(
-            serve(self.stream_server.app, self.config.stream.host, self.config.stream.port)
-        )
+        self._loop = asyncio.get_running_loop()
+        await asyncio.to_thread(self._streaming_server.start)
+        self._started = True
         logger.info(
             "Stream server running on ws://%s:%s%s",
             self.config.stream.host,
@@ -78,25 +128,114 @@ class VoiceAgentOrchestrator:
             self.config.stream.audio_endpoint,
         )
 
+        started = time.perf_counter()
+        configure_cpu_inference(self.config.cpu)
+        configure_determinism(self.config.determinism)
+        await self.stream_server.set_status("loading")
+        try:
+            await asyncio.gather(asyncio.to_thread(self.llm.load), self._load_tts())
+            logger.info("Models loaded in %.2fs", time.perf_counter() - started)
+            await self.stream_server.set_status("warming")
+            await self.tts.warm_up()
+        except Exception as exc:
+            await self.stream_server.set_status("error", detail=str(exc))
+            await asyncio.to_thread(self._streaming_server.stop)
+            self._started = False
+            raise
+        await self.stream_server.set_status("ready")
+        logger.info("Orchestrator ready in %.2fs", time.perf_counter() - started)
+
+    async def _load_tts(self) -> None:
+        try:
+            await self.tts.load()
+        except Exception as exc:
+            raise TTSInitializationError(str(exc)) from exc
+
     async def stop(self) -> None:
         if not self._started:
             return
+        await self.stream_server.set_status("offline")
+        # Closing the server drops the control sockets, so let the status go out first.
+        if not await self.stream_server.flush_control(timeout=1.0):
+            logger.warning("Offline status did not reach every control client before shutdown")
         await asyncio.to_thread(self._streaming_server.stop)
         self._started = False
         logger.info("Orchestrator stopped")
 
-    async def process_text(self, user_message: str, chat_history: Optional[List[Dict[str, str]]] = None) -> Dict[str, str]:
-        """Runs the LLM + TTS pipeline and streams the result."""
-        logger.debug("Processing user message: %s", user_message)
-        result = self.llm.generate(user_message, chat_history)
+    async def process_text(
+        self,
+        user_message: str,
+        chat_history: Optional[List[Dict[str, str]]] = None,
+        *,
+        session_id: Optional[str] = None,
+        agent_id: Optional[str] = None,
+        voice: Optional[str] = None,
+        ticket: Optional[AdmissionTicket] = None,
+    ) -> Dict[str, str]:
+        """Runs the LLM + TTS pipeline for one turn and streams the result.
+
+        ``chat_history`` overrides the session history when given. Otherwise
+        the session's token-bounded history (recent turns plus a rolling
+        summary) is used and extended with this turn. ``voice`` sticks to the
+        session; without one the agent's configured voice is used.
+        ``ticket`` comes from :meth:`AdmissionController.try_admit`; without
+        one the turn is admitted unconditionally.
+        """
+        session = self.sessions.get_or_create(session_id, agent_id, voice)
+        ticket = ticket or self.admission.admit()
+        try:
+            # Take the session lock first so a turn waiting on its session holds no inference slot.
+            async with session.lock:
+                async with self.admission.turn(ticket):
+                    return await self._run_turn(session, user_message, chat_history)
+        finally:
+            self.admission.withdraw(ticket)
+
+    async def _run_turn(
+        self,
+        session: ConversationSession,
+        user_message: str,
+        chat_history: Optional[List[Dict[str, str]]],
+    ) -> Dict[str, str]:
+        logger.debug("Processing message for session %s: %s", session.session_id, user_message)
+        if chat_history is not None:
+            history, summary = chat_history, None
+        else:
+            history, summary = session.history.prompt_context()
+        # generate() blocks on the model; keep the loop free for other sessions.
+        result = await asyncio.to_thread(self.llm.generate, user_message, history, summary)
         emotion_payload = self._emotion_mapper.to_payload(result["emotion"])
-        await self.stream_server.push_emotion(emotion_payload)
+        await self.stream_server.push_emotion(emotion_payload, agent_id=session.agent_id)
 
-        async for chunk in self.tts.synthesize_stream(result["text"]):
-            await self.stream_server.push_audio(chunk)
+        voice = self._voice_for(session)
+        tts_kwargs = {}
+        if self.config.determinism.enabled:
+            tts_kwargs["seed"] = utterance_seed(self.config.determinism.seed, voice or "", result["text"])
+        async for chunk in self.tts.synthesize_stream(result["text"], voice=voice, **tts_kwargs):
+            try:
+                await self.stream_server.push_audio(chunk, agent_id=session.agent_id)
+            finally:
+                release_pcm(chunk)
 
+        if chat_history is None:
+            session.record_turn(user_message, result["text"])
+            session.history.maybe_fold(self._summarize_history)
         return result
 
+    def _voice_for(self, session: ConversationSession) -> Optional[str]:
+        return session.voice or self.config.agent_voices.get(session.agent_id)
+
+    async def _summarize_history(self, previous_summary: str, turns: List[Dict[str, str]]) -> str:
+        return await asyncio.to_thread(
+            self.llm.summarize,
+            previous_summary,
+            turns,
+            max_new_tokens=self.config.history.summary_max_tokens,
+        )
+
+    def end_session(self, session_id: str) -> bool:
+        return self.sessions.end(session_id)
+
     async def __aenter__(self) -> "VoiceAgentOrchestrator":
         await self.start()
         return self
@@ -105,6 +244,57 @@ class VoiceAgentOrchestrator:
         await self.stop()
 
     # Internal callbacks -------------------------------------------------
+    def _handle_control_message(self, client_id: str, message: Dict[str, Any]) -> None:
+        """Called on the stream server thread; hops onto the orchestrator loop."""
+        if self._loop is None or self._loop.is_closed():
+            logger.warning("Dropping control message before start: %s", message)
+            return
+        asyncio.run_coroutine_threadsafe(self._dispatch_control_message(client_id, message), self._loop)
+
+    async def _dispatch_control_message(self, client_id: str, message: Dict[str, Any]) -> None:
+        message_type = message.get("type")
+        if message_type == "turn":
+            await self._handle_turn_message(client_id, message)
+        elif message_type == "end_session":
+            self.end_session(str(message.get("session_id") or ""))
+        else:
+            logger.debug("Unhandled control message from %s: %s", client_id, message)
+
+    async def _handle_turn_message(self, client_id: str, message: Dict[str, Any]) -> None:
+        text = str(message.get("text") or "").strip()
+        session_id = message.get("session_id") or client_id
+        agent_id = message.get("agent_id")
+        voice = message.get("voice")
+        session = self.sessions.get_or_create(session_id, agent_id, voice)
+        reply: Dict[str, Any] = {"type": "turn_result", "session_id": session_id, "agent_id": session.agent_id}
+        if message.get("turn_id") is not None:
+            reply["turn_id"] = message["turn_id"]
+        if not text:
+            reply["error"] = "empty turn"
+            await self.stream_server.send_control(client_id, reply)
+            return
+
+        decision = self.admission.try_admit()
+        admission: Dict[str, Any] = {"type": "admission", "session_id": session_id, "agent_id": session.agent_id}
+        if "turn_id" in reply:
+            admission["turn_id"] = reply["turn_id"]
+        admission.update(decision.to_message())
+        await self.stream_server.send_control(client_id, admission)
+        if not decision.admitted:
+            reply["error"] = f"rejected: {decision.reason}"
+            await self.stream_server.send_control(client_id, reply)
+            return
+        try:
+            result = await self.process_text(
+                text, session_id=session_id, agent_id=agent_id, voice=voice, ticket=decision.ticket
+            )
+        except Exception as exc:
+            logger.exception("Turn for session %s failed", session_id)
+            reply["error"] = str(exc)
+        else:
+            reply.update(result)
+        await self.stream_server.send_control(client_id, reply)
+
     def _handle_audio_client_count(self, count: int) -> None:
         logger.info("Audio client count changed: %s", count)
         if self.event_sink:
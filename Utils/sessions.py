@@ -0,0 +1,109 @@
+"""Conversation sessions tracked by the orchestrator."""
+from __future__ import annotations
+
+import asyncio
+import logging
+import time
+from dataclasses import dataclass, field
+from typing import Callable, Dict, Optional
+
+from Server.streaming import DEFAULT_AGENT_ID
+from Utils.history import ChatHistoryManager
+
+logger = logging.getLogger(__name__)
+
+DEFAULT_SESSION_ID = "default"
+
+
+@dataclass
+class ConversationSession:
+    """Chat history and routing for one conversation with one agent."""
+
+    session_id: str
+    agent_id: str = DEFAULT_AGENT_ID
+    # TTS voice for this session; ``None`` falls back to the agent's voice.
+    voice: Optional[str] = None
+    history: ChatHistoryManager = field(default_factory=ChatHistoryManager)
+    last_active: float = field(default_factory=time.monotonic)
+    # Turns within a session run in order; separate sessions run concurrently.
+    lock: asyncio.Lock = field(default_factory=asyncio.Lock, repr=False)
+
+    def record_turn(self, user_message: str, assistant_reply: str) -> None:
+        self.history.append(user_message, assistant_reply)
+        self.last_active = time.monotonic()
+
+
+class SessionManager:
+    """Creates, looks up and ends :class:`ConversationSession` objects.
+
+    Clients that vanish without ``end_session`` would otherwise keep their
+    history forever, so sessions idle for longer than ``idle_timeout_s`` are
+    dropped whenever a session is looked up. Sessions with a turn running
+    or waiting are never dropped.
+    """
+
+    def __init__(
+        self,
+        history_factory: Optional[Callable[[], ChatHistoryManager]] = None,
+        idle_timeout_s: Optional[float] = None,
+        clock: Callable[[], float] = time.monotonic,
+    ) -> None:
+        self._sessions: Dict[str, ConversationSession] = {}
+        self._history_factory = history_factory or ChatHistoryManager
+        self._idle_timeout_s = idle_timeout_s
+        self._clock = clock
+
+    def get_or_create(
+        self,
+        session_id: Optional[str] = None,
+        agent_id: Optional[str] = None,
+        voice: Optional[str] = None,
+    ) -> ConversationSession:
+        session_id = session_id or DEFAULT_SESSION_ID
+        now = self._clock()
+        self.expire_idle(now)
+        session = self._sessions.get(session_id)
+        if session is None:
+            session = ConversationSession(
+                session_id=session_id,
+                agent_id=agent_id or DEFAULT_AGENT_ID,
+                history=self._history_factory(),
+                last_active=now,
+            )
+            self._sessions[session_id] = session
+            logger.info("Created session %s for agent %s", session_id, session.agent_id)
+        elif agent_id and agent_id != session.agent_id:
+            logger.info("Session %s now routed to agent %s", session_id, agent_id)
+            session.agent_id = agent_id
+        if voice:
+            session.voice = voice
+        session.last_active = now
+        return session
+
+    def expire_idle(self, now: Optional[float] = None) -> int:
+        """Drops sessions idle for longer than ``idle_timeout_s``; returns how many."""
+        if self._idle_timeout_s is None:
+            return 0
+        cutoff = (self._clock() if now is None else now) - self._idle_timeout_s
+        expired = [
+            session_id
+            for session_id, session in self._sessions.items()
+            if session.last_active < cutoff and not session.lock.locked()
+        ]
+        for session_id in expired:
+            del self._sessions[session_id]
+        if expired:
+            logger.info("Expired %s idle session(s)", len(expired))
+        return len(expired)
+
+    def get(self, session_id: str) -> Optional[ConversationSession]:
+        return self._sessions.get(session_id)
+
+    def end(self, session_id: str) -> bool:
+        session = self._sessions.pop(session_id, None)
+        if session is not None:
+            logger.info("Ended session %s", session_id)
+        return session is not None
+
+    def __len__(self) -> int:
+        return len(self._sessions)
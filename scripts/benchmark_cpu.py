@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""Benchmark the CPU inference path for the LLM and Kani-TTS.
+
+Usage:
+    python scripts/benchmark_cpu.py --config config/cpu_config.json
+    python scripts/benchmark_cpu.py --config config/cpu_config.json --threads 8 --pin-cores 0-7
+
+Applies the ``cpu`` section of the config, loads both models exactly as the
+orchestrator would, then reports:
+
+* LLM decode throughput (tokens/s) and time to the full reply;
+* TTS time to first audio chunk and real-time factor (synthesis time divided
+  by audio duration; below 1.0 means the node keeps up with playback).
+
+``--skip-llm`` / ``--skip-tts`` benchmark one model on its own.
+"""
+
+from __future__ import annotations
+
+import argparse
+import asyncio
+import logging
+import sys
+import time
+from pathlib import Path
+from typing import List, Optional
+
+PROJECT_ROOT = Path(__file__).resolve().parents[1]
+if str(PROJECT_ROOT) not in sys.path:
+    sys.path.insert(0, str(PROJECT_ROOT))
+
+import torch
+
+from LLM.engine import LLMEngine
+from TTS.kani_engine import KaniTTSEngine
+from TTS.kani_tts.audio.pcm import release_pcm
+from Utils.config import load_orchestrator_config
+from Utils.cpu import configure_cpu_inference
+from Utils.emotions import EmotionMapper
+
+DEFAULT_CONFIG = Path("config/cpu_config.json")
+DEFAULT_PROMPT = "Hi Nova! Could you tell me something cheerful about your day?"
+DEFAULT_TEXT = "Hello there! It is lovely to see you again. How has your day been so far?"
+
+
+def _parse_cores(spec: Optional[str]) -> Optional[List[int]]:
+    if not spec:
+        return None
+    cores: List[int] = []
+    for part in spec.split(","):
+        if "-" in part:
+            first, last = part.split("-", 1)
+            cores.extend(range(int(first), int(last) + 1))
+        else:
+            cores.append(int(part))
+    return cores
+
+
+def _benchmark_llm(engine: LLMEngine, prompt: str, runs: int) -> None:
+    engine.load()
+    engine.generate(prompt)
+
+    new_tokens = 0
+    elapsed = 0.0
+    for _ in range(runs):
+        inputs = engine._encode(engine._build_chat_messages(prompt))
+        kwargs = engine._generation_kwargs(inputs)
+        start = time.perf_counter()
+        with torch.no_grad():
+            output = engine._model.generate(**kwargs)
+        elapsed += time.perf_counter() - start
+        new_tokens += int(output.shape[-1] - inputs["input_ids"].shape[-1])
+
+    print(
+        f"llm   {new_tokens / elapsed if elapsed else 0.0:8.2f} tok/s  "
+        f"({new_tokens / runs:.0f} tokens, {elapsed / runs:.2f}s per reply)"
+    )
+
+
+async def _benchmark_tts(engine: KaniTTSEngine, text: str, runs: int) -> None:
+    await engine.load()
+    await engine.warm_up()
+
+    sample_rate = engine.config.sample_rate
+    first_chunk = 0.0
+    audio_seconds = 0.0
+    elapsed = 0.0
+    for _ in range(runs):
+        start = time.perf_counter()
+        first: Optional[float] = None
+        async for chunk in engine.synthesize_stream(text):
+            if first is None:
+                first = time.perf_counter() - start
+            audio_seconds += len(chunk) / 2 / sample_rate
+            release_pcm(chunk)
+        elapsed += time.perf_counter() - start
+        first_chunk += first or 0.0
+
+    rtf = elapsed / audio_seconds if audio_seconds else float("inf")
+    print(
+        f"tts   first chunk {first_chunk / runs * 1000:7.1f} ms  "
+        f"RTF {rtf:.2f} ({audio_seconds / runs:.2f}s audio in {elapsed / runs:.2f}s)"
+    )
+
+
+def parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--config", type=Path, default=DEFAULT_CONFIG, help="Orchestrator configuration JSON")
+    parser.add_argument("--threads", type=int, help="Override cpu.threads")
+    parser.add_argument("--pin-cores", help="Override cpu.pin_cores, e.g. 0-7 or 0,2,4,6")
+    parser.add_argument("--prompt", default=DEFAULT_PROMPT, help="User message for the LLM run")
+    parser.add_argument("--text", default=DEFAULT_TEXT, help="Sentence for the TTS run")
+    parser.add_argument("--runs", type=int, default=3, help="Timed runs per model (after one warm-up)")
+    parser.add_argument("--skip-llm", action="store_true")
+    parser.add_argument("--skip-tts", action="store_true")
+    parser.add_argument(
+        "--log-level",
+        default="WARNING",
+        choices=["CRITICAL", "ERROR", "WARNING", "INFO", "DEBUG"],
+        help="Logging verbosity",
+    )
+    return parser.parse_args()
+
+
+def main() -> None:
+    args = parse_args()
+    logging.basicConfig(level=getattr(logging, args.log_level))
+
+    config = load_orchestrator_config(args.config)
+    if args.threads:
+        config.cpu.threads = args.threads
+    if args.pin_cores:
+        config.cpu.pin_cores = _parse_cores(args.pin_cores)
+    configure_cpu_inference(config.cpu)
+    print(
+        f"llm device={config.llm.device} quantization={config.llm.quantization}; "
+        f"tts device={config.tts.device} quantization={config.tts.quantization}; "
+        f"threads={torch.get_num_threads()}"
+    )
+
+    if not args.skip_llm:
+        _benchmark_llm(LLMEngine(config.llm, emotions=list(EmotionMapper().emotion_map)), args.prompt, args.runs)
+    if not args.skip_tts:
+        asyncio.run(_benchmark_tts(KaniTTSEngine(config.tts), args.text, args.runs))
+
+
+if __name__ == "__main__":
+    main()
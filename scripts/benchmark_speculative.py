@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+"""Benchmark speculative decoding in :class:`LLMEngine`.
+
+Usage:
+    python scripts/benchmark_speculative.py --tiny
+    python scripts/benchmark_speculative.py \
+        --model models/llm/Qwen3-4B-Instruct-2507 --draft models/llm/Qwen3-0.6B
+
+Runs the same greedy generation with and without the draft model and reports
+tokens/s for both plus the draft acceptance rate. ``--tiny`` swaps in small
+random checkpoints so the script finishes on a CPU-only CI runner; the
+acceptance rate is only meaningful with real checkpoints.
+"""
+
+from __future__ import annotations
+
+import argparse
+import logging
+import sys
+import time
+from dataclasses import dataclass
+from pathlib import Path
+
+PROJECT_ROOT = Path(__file__).resolve().parents[1]
+if str(PROJECT_ROOT) not in sys.path:
+    sys.path.insert(0, str(PROJECT_ROOT))
+
+import torch
+
+from LLM.engine import LLMConfig, LLMEngine
+
+TINY_MODEL = "hf-internal-testing/tiny-random-LlamaForCausalLM"
+DEFAULT_PROMPT = "Tell me a short story about a lighthouse keeper who befriends a seal."
+
+
+@dataclass
+class RunStats:
+    new_tokens: int
+    seconds: float
+    target_forwards: int
+    draft_forwards: int
+
+    @property
+    def tokens_per_second(self) -> float:
+        return self.new_tokens / self.seconds if self.seconds > 0 else 0.0
+
+    @property
+    def acceptance_rate(self) -> float:
+        # Every verification pass yields the accepted draft tokens plus one
+        # token sampled by the target model itself.
+        if self.draft_forwards == 0:
+            return 0.0
+        accepted = max(0, self.new_tokens - self.target_forwards)
+        return min(1.0, accepted / self.draft_forwards)
+
+
+class _ForwardCounter:
+    def __init__(self, model) -> None:
+        self.calls = 0
+        self._handle = model.register_forward_pre_hook(self._hook)
+
+    def _hook(self, *_args) -> None:
+        self.calls += 1
+
+    def remove(self) -> None:
+        self._handle.remove()
+
+
+def _run_once(engine: LLMEngine, prompt: str, *, speculative: bool) -> RunStats:
+    inputs = engine._tokenizer(prompt, return_tensors="pt").to(engine._model.device)
+    kwargs = engine._generation_kwargs(inputs)
+    kwargs.update(do_sample=False, temperature=None, top_p=None)
+    if not speculative:
+        kwargs.pop("assistant_model", None)
+
+    target_counter = _ForwardCounter(engine._model)
+    draft_counter = _ForwardCounter(engine._draft_model) if speculative else None
+    try:
+        start = time.perf_counter()
+        with torch.no_grad():
+            output = engine._model.generate(**kwargs)
+        elapsed = time.perf_counter() - start
+    finally:
+        target_counter.remove()
+        if draft_counter:
+            draft_counter.remove()
+
+    new_tokens = int(output.shape[-1] - inputs["input_ids"].shape[-1])
+    return RunStats(
+        new_tokens=new_tokens,
+        seconds=elapsed,
+        target_forwards=target_counter.calls,
+        draft_forwards=draft_counter.calls if draft_counter else 0,
+    )
+
+
+def _summarise(label: str, runs: list[RunStats]) -> RunStats:
+    total = RunStats(
+        new_tokens=sum(r.new_tokens for r in runs),
+        seconds=sum(r.seconds for r in runs),
+        target_forwards=sum(r.target_forwards for r in runs),
+        draft_forwards=sum(r.draft_forwards for r in runs),
+    )
+    line = f"{label:<12} {total.tokens_per_second:8.2f} tok/s  ({total.new_tokens} tokens in {total.seconds:.2f}s)"
+    if total.draft_forwards:
+        line += f"  acceptance {total.acceptance_rate:.1%}"
+    print(line)
+    return total
+
+
+def parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--model", help="Main model path or repo id")
+    parser.add_argument("--draft", help="Draft model path or repo id")
+    parser.add_argument("--tiny", action="store_true", help=f"Use {TINY_MODEL} for both models")
+    parser.add_argument("--prompt", default=DEFAULT_PROMPT, help="Prompt to generate from")
+    parser.add_argument("--max-new-tokens", type=int, default=64)
+    parser.add_argument("--num-assistant-tokens", type=int, default=5)
+    parser.add_argument("--runs", type=int, default=3, help="Timed runs per mode (after one warm-up)")
+    parser.add_argument(
+        "--device", default="cpu", help='Device both models load on: "cpu", "cuda" (all GPUs), "cuda:1", "mps", ...'
+    )
+    parser.add_argument(
+        "--log-level",
+        default="WARNING",
+        choices=["CRITICAL", "ERROR", "WARNING", "INFO", "DEBUG"],
+        help="Logging verbosity",
+    )
+    return parser.parse_args()
+
+
+def main() -> None:
+    args = parse_args()
+    logging.basicConfig(level=getattr(logging, args.log_level))
+
+    model = TINY_MODEL if args.tiny else args.model
+    draft = TINY_MODEL if args.tiny else args.draft
+    if not model or not draft:
+        print("Error: pass --model and --draft, or --tiny.", file=sys.stderr)
+        raise SystemExit(1)
+
+    engine = LLMEngine(
+        LLMConfig(
+            model_name_or_path=model,
+            device=args.device,
+            max_new_tokens=args.max_new_tokens,
+            draft_model_name_or_path=draft,
+            num_assistant_tokens=args.num_assistant_tokens,
+        )
+    )
+    engine.load()
+
+    for speculative in (False, True):
+        _run_once(engine, args.prompt, speculative=speculative)
+
+    baseline = _summarise("baseline", [_run_once(engine, args.prompt, speculative=False) for _ in range(args.runs)])
+    assisted = _summarise("speculative", [_run_once(engine, args.prompt, speculative=True) for _ in range(args.runs)])
+    if baseline.tokens_per_second > 0:
+        print(f"speedup      {assisted.tokens_per_second / baseline.tokens_per_second:.2f}x")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,426 @@
+#!/usr/bin/env python3
+"""Server-side performance regression suite with stand-in models.
+
+Usage:
+    python scripts/benchmark_suite.py                     # run and compare with the baselines
+    python scripts/benchmark_suite.py --update-baselines  # record new baselines on this machine
+    python scripts/benchmark_suite.py --json results.json
+
+Everything runs on the CPU without model weights. A stand-in TTS language
+model emits speech tokens at a fixed pace (``--token-ms``, waiting without
+the GIL like a GPU-bound model would), and a stand-in codec decodes them
+with a fixed amount of NumPy work per frame plus a fixed cost per call
+(``--decode-call-ms``, like a kernel launch). The real streaming code runs
+around them:
+``KaniTTSEngine`` → ``KaniSynthesizer`` → ``StreamingAudioWriter`` →
+``PCMBufferPool`` → ``BroadcastQueue`` → orchestrator. The suite
+therefore measures pipeline overhead (hand-offs, polling, copies) rather
+than model speed. It reports:
+
+* ``tts_first_chunk_ms`` – text in to first PCM chunk out;
+* ``tts_rtf`` – synthesis time divided by audio duration;
+* ``decode_chunk_ms`` / ``decode_chunk_p95_ms`` – ``decode_audio_chunk`` calls
+  made by ``StreamingAudioWriter``;
+* ``tts_concurrent_rtf`` – the real-time factor of each of ``--streams``
+  utterances synthesised at the same time;
+* ``tts_shared_rtf`` / ``tts_cached_first_chunk_ms`` – ``--streams``
+  identical requests at once through the TTS result cache (one shared
+  generation), then the first chunk of a repeat served from the cache;
+* ``broadcast_deliveries_per_s`` – frames handed from the orchestrator loop
+  to ``--clients`` listeners on the server loop through ``BroadcastQueue``;
+* ``turn_first_audio_ms`` / ``turn_total_ms`` – ``process_text`` with canned
+  LLM replies, from the call to the first chunk at an audio listener and to
+  the end of the turn.
+
+Each metric is the median of ``--runs`` runs. It is compared with
+``scripts/benchmark_baselines.json``; a metric worse than its baseline by
+more than its tolerance fails the run (exit code 1). Baselines are
+machine-specific: record them on the CI runner with ``--update-baselines``.
+"""
+
+from __future__ import annotations
+
+import argparse
+import asyncio
+import concurrent.futures
+import contextlib
+import json
+import os
+import statistics
+import sys
+import tempfile
+import threading
+import time
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Any, Callable, Dict, List, Optional
+
+PROJECT_ROOT = Path(__file__).resolve().parents[1]
+if str(PROJECT_ROOT) not in sys.path:
+    sys.path.insert(0, str(PROJECT_ROOT))
+
+import numpy as np
+
+from LLM.engine import LLMConfig
+from Server.streaming import BroadcastQueue, payload_view, release_payload
+from TTS.kani_engine import KaniTTSConfig, KaniTTSEngine
+from TTS.kani_tts import config as kani_config
+from TTS.kani_tts.audio.pcm import PCMBufferPool, release_pcm
+from TTS.kani_tts.synthesizer import KaniSynthesizer
+from Utils.determinism import DeterminismConfig
+from Utils.orchestrator import OrchestratorConfig, VoiceAgentOrchestrator
+
+DEFAULT_BASELINES = Path(__file__).with_name("benchmark_baselines.json")
+DEFAULT_TEXT = "Hello there! It is lovely to see you again. How has your day been so far?"
+CANNED_REPLIES = PROJECT_ROOT / "config" / "canned_replies.json"
+
+CODEC_SAMPLE_RATE = 22050
+CODEC_FRAME_RATE = 12.5
+SAMPLES_PER_FRAME = int(CODEC_SAMPLE_RATE / CODEC_FRAME_RATE)
+# Roughly how fast the stand-in speaks: characters of text per second of audio.
+CHARS_PER_SECOND = 15.0
+
+
+# Stand-in models -----------------------------------------------------------
+class StandInCodec:
+    """Replaces ``LLMAudioPlayer``: a fixed cost per call plus a matmul cost per frame."""
+
+    start_of_speech = kani_config.START_OF_SPEECH
+    end_of_speech = kani_config.END_OF_SPEECH
+
+    def __init__(self, call_seconds: float, work_dim: int = 96) -> None:
+        self.call_seconds = call_seconds
+        rng = np.random.default_rng(0)
+        self._embedding = rng.standard_normal((kani_config.CODEBOOK_SIZE, work_dim)).astype(np.float32) * 0.05
+        self._synthesis = rng.standard_normal((work_dim, SAMPLES_PER_FRAME)).astype(np.float32) * 0.05
+        self._device = threading.Lock()
+        self.decode_seconds: List[float] = []
+
+    def decode_audio_chunk(self, audio_codes: np.ndarray) -> Optional[np.ndarray]:
+        if len(audio_codes) == 0:
+            return None
+        return self.decode_audio_batch([audio_codes])[0]
+
+    def decode_audio_batch(self, batch: List[np.ndarray]) -> List[Optional[np.ndarray]]:
+        started = time.perf_counter()
+        offsets = kani_config.AUDIO_TOKENS_START + kani_config.CODEBOOK_SIZE * np.arange(4)
+        results: List[Optional[np.ndarray]] = []
+        # One device: calls from concurrent streams run one after another.
+        with self._device:
+            time.sleep(self.call_seconds)
+            for audio_codes in batch:
+                codes = (np.asarray(audio_codes) - offsets) % kani_config.CODEBOOK_SIZE
+                hidden = self._embedding[codes].sum(axis=1)
+                results.append(np.tanh(hidden @ self._synthesis).reshape(-1) if len(codes) else None)
+            self.decode_seconds.append(time.perf_counter() - started)
+        return results
+
+
+class StandInGenerator:
+    """Replaces ``TTSGenerator``: streams 4 codes per frame, one every ``token_seconds``."""
+
+    def __init__(self, token_seconds: float, work_dim: int = 128) -> None:
+        rng = np.random.default_rng(1)
+        self.token_seconds = token_seconds
+        self._weights = rng.standard_normal((work_dim, work_dim)).astype(np.float32) / work_dim
+        self._state = np.ones((1, work_dim), dtype=np.float32)
+
+    def generate(self, prompt: str, audio_writer: Any, **_: Any) -> Dict[str, Any]:
+        num_frames = max(1, int(len(prompt) / CHARS_PER_SECOND * CODEC_FRAME_RATE))
+        state = self._state
+        # Handed over a frame at a time, as TokenIDStreamer does.
+        audio_writer.add_tokens([kani_config.START_OF_SPEECH])
+        for frame in range(num_frames):
+            tokens = []
+            for codebook in range(4):
+                time.sleep(self.token_seconds)
+                state = np.tanh(state @ self._weights)
+                code = (frame * 7919 + codebook) % kani_config.CODEBOOK_SIZE
+                tokens.append(kani_config.AUDIO_TOKENS_START + codebook * kani_config.CODEBOOK_SIZE + code)
+            audio_writer.add_tokens(tokens)
+        audio_writer.add_tokens([kani_config.END_OF_SPEECH])
+        return {"all_token_ids": [], "generated_text": prompt}
+
+
+def _stand_in_tts(chunk_size: int, token_ms: float, decode_call_ms: float) -> tuple[KaniTTSEngine, StandInCodec]:
+    codec = StandInCodec(decode_call_ms / 1000.0)
+    synth = KaniSynthesizer(sample_rate=CODEC_SAMPLE_RATE, chunk_size=chunk_size)
+    synth._generator = StandInGenerator(token_ms / 1000.0)  # type: ignore[assignment]
+    synth._player = codec  # type: ignore[assignment]
+    engine = KaniTTSEngine(KaniTTSConfig(model_dir=Path("."), sample_rate=CODEC_SAMPLE_RATE, chunk_size=chunk_size))
+    engine._synth = synth
+    return engine, codec
+
+
+# Benchmarks ----------------------------------------------------------------
+async def bench_tts(text: str, chunk_size: int, token_ms: float, decode_call_ms: float) -> Dict[str, float]:
+    engine, codec = _stand_in_tts(chunk_size, token_ms, decode_call_ms)
+    started = time.perf_counter()
+    first: Optional[float] = None
+    samples = 0
+    async for chunk in engine.synthesize_stream(text):
+        if first is None:
+            first = time.perf_counter() - started
+        samples += len(chunk) // 2
+        release_pcm(chunk)
+    elapsed = time.perf_counter() - started
+    decode_ms = sorted(seconds * 1000.0 for seconds in codec.decode_seconds)
+    return {
+        "tts_first_chunk_ms": (first or elapsed) * 1000.0,
+        "tts_rtf": elapsed / (samples / CODEC_SAMPLE_RATE) if samples else float("inf"),
+        "decode_chunk_ms": statistics.fmean(decode_ms) if decode_ms else 0.0,
+        "decode_chunk_p95_ms": decode_ms[int(0.95 * (len(decode_ms) - 1))] if decode_ms else 0.0,
+    }
+
+
+def bench_concurrent_tts(text: str, streams: int, chunk_size: int, token_ms: float, decode_call_ms: float) -> Dict[str, float]:
+    """Several utterances through one synthesiser at once, as with several agents speaking."""
+    engine, _ = _stand_in_tts(chunk_size, token_ms, decode_call_ms)
+    synth = engine._synth
+    assert synth is not None
+    rtfs: List[float] = []
+
+    def _speak() -> None:
+        started = time.perf_counter()
+        samples = 0
+        for frame in synth.stream(text, chunk_size=chunk_size):
+            samples += len(frame) // 2
+            frame.release()
+        rtfs.append((time.perf_counter() - started) / (samples / CODEC_SAMPLE_RATE))
+
+    with concurrent.futures.ThreadPoolExecutor(max_workers=streams) as pool:
+        for future in [pool.submit(_speak) for _ in range(streams)]:
+            future.result()
+    return {"tts_concurrent_rtf": statistics.fmean(rtfs)}
+
+
+async def bench_shared_tts(text: str, streams: int, chunk_size: int, token_ms: float, decode_call_ms: float) -> Dict[str, float]:
+    """Identical requests at once, as when several NPCs bark the same line, then a repeat."""
+    engine, _ = _stand_in_tts(chunk_size, token_ms, decode_call_ms)
+
+    async def _listen() -> tuple[float, float]:
+        started = time.perf_counter()
+        first: Optional[float] = None
+        samples = 0
+        async for chunk in engine.synthesize_stream(text):
+            if first is None:
+                first = time.perf_counter() - started
+            samples += len(chunk) // 2
+            release_pcm(chunk)
+        elapsed = time.perf_counter() - started
+        return first or elapsed, elapsed / (samples / CODEC_SAMPLE_RATE) if samples else float("inf")
+
+    shared = await asyncio.gather(*(_listen() for _ in range(streams)))
+    cached_first, _ = await _listen()
+    return {
+        "tts_shared_rtf": statistics.fmean(rtf for _, rtf in shared),
+        "tts_cached_first_chunk_ms": cached_first * 1000.0,
+    }
+
+
+def bench_broadcast(clients: int, frames: int, frame_ms: int = 20) -> Dict[str, float]:
+    """Fans pooled PCM frames out from one loop to ``clients`` listeners on another, as in production."""
+    broadcast = BroadcastQueue()
+    pool = PCMBufferPool()
+    server_loop = asyncio.new_event_loop()
+    server_thread = threading.Thread(target=server_loop.run_forever, daemon=True)
+    server_thread.start()
+    # Listener queues hold 4 payloads; the producer waits for each burst to drain so nothing is dropped.
+    burst = 4
+    state = {"received": 0, "target": 0, "done": None}
+    state_lock = threading.Lock()
+
+    async def _client(queue: asyncio.Queue) -> None:
+        sink = bytearray(8192)
+        while True:
+            payload = await queue.get()
+            view = payload_view(payload)
+            sink[: len(view)] = view  # stands in for the websocket write
+            release_payload(payload)
+            with state_lock:
+                state["received"] += 1
+                if state["received"] == state["target"]:
+                    state["done"].set_result(None)
+
+    async def _stop_clients(tasks: List[asyncio.Task]) -> None:
+        for task in tasks:
+            task.cancel()
+        await asyncio.gather(*tasks, return_exceptions=True)
+
+    async def _start_clients() -> List[asyncio.Task]:
+        tasks = []
+        for _ in range(clients):
+            queue = await broadcast.register()
+            tasks.append(asyncio.ensure_future(_client(queue)))
+        return tasks
+
+    audio = np.sin(np.arange(CODEC_SAMPLE_RATE * frame_ms // 1000, dtype=np.float32) * 0.05)
+
+    async def _produce() -> float:
+        started = time.perf_counter()
+        for first in range(0, frames, burst):
+            count = min(burst, frames - first)
+            done: concurrent.futures.Future = concurrent.futures.Future()
+            with state_lock:
+                state["target"] = state["received"] + count * clients
+                state["done"] = done
+            for _ in range(count):
+                frame = pool.convert(audio)
+                await broadcast.broadcast(frame)
+                frame.release()
+            await asyncio.wrap_future(done)
+        return time.perf_counter() - started
+
+    tasks: List[asyncio.Task] = []
+    try:
+        tasks = asyncio.run_coroutine_threadsafe(_start_clients(), server_loop).result(5)
+        elapsed = asyncio.run(_produce())
+    finally:
+        asyncio.run_coroutine_threadsafe(_stop_clients(tasks), server_loop).result(5)
+        server_loop.call_soon_threadsafe(server_loop.stop)
+        server_thread.join(5)
+        server_loop.close()
+    return {"broadcast_deliveries_per_s": frames * clients / elapsed}
+
+
+async def bench_turn(chunk_size: int, token_ms: float, decode_call_ms: float) -> Dict[str, float]:
+    engine, _ = _stand_in_tts(chunk_size, token_ms, decode_call_ms)
+    config = OrchestratorConfig(
+        llm=LLMConfig(model_name_or_path="canned"),
+        tts=engine.config,
+        determinism=DeterminismConfig(enabled=True, canned_replies=str(CANNED_REPLIES)),
+    )
+    orchestrator = VoiceAgentOrchestrator(config)
+    orchestrator.llm.load()
+    orchestrator.tts = engine
+    listener = await orchestrator.stream_server.audio_channel("bench").register()
+    first_audio: List[float] = []
+
+    async def _listen() -> None:
+        while True:
+            payload = await listener.get()
+            if not first_audio:
+                first_audio.append(time.perf_counter())
+            release_payload(payload)
+
+    listen_task = asyncio.ensure_future(_listen())
+    started = time.perf_counter()
+    await orchestrator.process_text("What do you sell?", session_id="bench", agent_id="bench")
+    total = time.perf_counter() - started
+    await asyncio.sleep(0)
+    listen_task.cancel()
+    with contextlib.suppress(asyncio.CancelledError):
+        await listen_task
+    return {
+        "turn_first_audio_ms": ((first_audio[0] if first_audio else time.perf_counter()) - started) * 1000.0,
+        "turn_total_ms": total * 1000.0,
+    }
+
+
+# Baselines -----------------------------------------------------------------
+@dataclass
+class Regression:
+    metric: str
+    value: float
+    baseline: float
+    limit: float
+
+
+def compare_to_baselines(results: Dict[str, float], baselines: Dict[str, Dict[str, Any]]) -> List[Regression]:
+    """Metrics worse than ``baseline * (1 ± tolerance)`` plus ``slack``, in the metric's direction."""
+    regressions = []
+    for metric, spec in baselines.items():
+        if metric not in results:
+            continue
+        value = results[metric]
+        baseline = float(spec["value"])
+        tolerance = float(spec.get("tolerance", 0.25))
+        slack = float(spec.get("slack", 0.0))
+        if spec.get("higher_is_better", False):
+            limit = baseline * (1.0 - tolerance) - slack
+            failed = value < limit
+        else:
+            limit = baseline * (1.0 + tolerance) + slack
+            failed = value > limit
+        if failed:
+            regressions.append(Regression(metric, value, baseline, limit))
+    return regressions
+
+
+def _default_spec(metric: str) -> Dict[str, Any]:
+    """Tolerances for a newly recorded metric; edit the baseline file to tighten them."""
+    if metric.endswith("_per_s"):
+        return {"higher_is_better": True, "tolerance": 0.4}
+    if metric.endswith("_ms"):
+        # Sub-millisecond timings jitter by more than any sensible ratio.
+        return {"higher_is_better": False, "tolerance": 0.3, "slack": 2.0}
+    return {"higher_is_better": False, "tolerance": 0.3, "slack": 0.01}
+
+
+def _median_runs(runs: int, bench: Callable[[], Dict[str, float]]) -> Dict[str, float]:
+    samples: Dict[str, List[float]] = {}
+    for _ in range(runs):
+        for metric, value in bench().items():
+            samples.setdefault(metric, []).append(value)
+    return {metric: statistics.median(values) for metric, values in samples.items()}
+
+
+def run_suite(args: argparse.Namespace) -> Dict[str, float]:
+    results: Dict[str, float] = {}
+    tts = (args.chunk_size, args.token_ms, args.decode_call_ms)
+    results.update(_median_runs(args.runs, lambda: asyncio.run(bench_tts(args.text, *tts))))
+    results.update(_median_runs(args.runs, lambda: bench_concurrent_tts(args.text, args.streams, *tts)))
+    results.update(_median_runs(args.runs, lambda: asyncio.run(bench_shared_tts(args.text, args.streams, *tts))))
+    results.update(_median_runs(args.runs, lambda: bench_broadcast(args.clients, args.frames)))
+    results.update(_median_runs(args.runs, lambda: asyncio.run(bench_turn(*tts))))
+    return results
+
+
+def parse_args(argv: Optional[List[str]] = None) -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--baselines", type=Path, default=DEFAULT_BASELINES, help="Baseline JSON to compare with")
+    parser.add_argument("--update-baselines", action="store_true", help="Store this run's results as the baselines")
+    parser.add_argument("--json", type=Path, help="Also write the results to this file")
+    parser.add_argument("--runs", type=int, default=5, help="Runs per benchmark; the median is reported")
+    parser.add_argument("--text", default=DEFAULT_TEXT, help="Sentence for the TTS benchmark")
+    parser.add_argument("--chunk-size", type=int, default=kani_config.CHUNK_SIZE, help="Decoder frames per chunk")
+    parser.add_argument("--token-ms", type=float, default=1.0, help="Stand-in TTS model time per speech token")
+    parser.add_argument("--decode-call-ms", type=float, default=2.0, help="Stand-in codec fixed cost per decode call")
+    parser.add_argument("--streams", type=int, default=8, help="Utterances synthesised at once for tts_concurrent_rtf and tts_shared_rtf")
+    parser.add_argument("--clients", type=int, default=16, help="Simulated websocket clients for the broadcast benchmark")
+    parser.add_argument("--frames", type=int, default=400, help="Frames broadcast per run")
+    return parser.parse_args(argv)
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    args = parse_args(argv)
+    results = run_suite(args)
+    for metric, value in results.items():
+        print(f"{metric:28s} {value:12.3f}")
+    if args.json:
+        args.json.write_text(json.dumps(results, indent=2) + "\n", encoding="utf-8")
+
+    stored = json.loads(args.baselines.read_text(encoding="utf-8")) if args.baselines.exists() else {}
+    if args.update_baselines:
+        for metric, value in results.items():
+            spec = stored.setdefault(metric, _default_spec(metric))
+            spec["value"] = round(value, 3)
+        with tempfile.NamedTemporaryFile("w", dir=args.baselines.parent, delete=False, encoding="utf-8") as handle:
+            handle.write(json.dumps(stored, indent=2) + "\n")
+        os.replace(handle.name, args.baselines)
+        print(f"Baselines written to {args.baselines}")
+        return 0
+
+    regressions = compare_to_baselines(results, stored)
+    for regression in regressions:
+        print(
+            f"REGRESSION {regression.metric}: {regression.value:.3f} "
+            f"(baseline {regression.baseline:.3f}, limit {regression.limit:.3f})"
+        )
+    if not stored:
+        print(f"No baselines at {args.baselines}; run with --update-baselines to record them.")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
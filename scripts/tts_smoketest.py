@@ -22,6 +22,7 @@ if str(PROJECT_ROOT) not in sys.path:
     sys.path.insert(0, str(PROJECT_ROOT))
 
 from TTS.kani_engine import KaniTTSEngine
+from TTS.kani_tts.audio.pcm import pcm_view, release_pcm
 from Utils.config import load_orchestrator_config
 
 DEFAULT_CONFIG = Path("config/default_config.json")
@@ -40,7 +41,8 @@ async def _synthesize(text: str, output_path: Path, config_path: Path) -> None:
 
     audio_frames = bytearray()
     async for chunk in engine.synthesize_stream(text):
-        audio_frames.extend(chunk)
+        audio_frames.extend(pcm_view(chunk))
+        release_pcm(chunk)
 
     if not audio_frames:
         raise AudioGenerationError(
@@ -0,0 +1,82 @@
+import sys
+from pathlib import Path
+
+import numpy as np
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
+
+from Server.adaptive_bitrate import (
+    DEFAULT_LADDER,
+    AdaptiveBitrateConfig,
+    AudioEncoder,
+    ClientFeedback,
+    CongestionController,
+    mulaw_encode,
+)
+from Server.packetizer import CODEC_MULAW, FRAME_HEADER, AudioPacketizer, PacketizerSettings
+
+
+def test_losses_step_down_and_quiet_links_probe_back_up():
+    controller = CongestionController(AdaptiveBitrateConfig(down_interval_s=1.0, probe_interval_s=4.0), now=0.0)
+
+    assert not controller.on_feedback(ClientFeedback(lost_frames=0, rtt_ms=40), now=1.0)
+    assert controller.on_feedback(ClientFeedback(lost_frames=3, rtt_ms=40), now=2.0)
+    assert controller.rung == DEFAULT_LADDER[1]
+    # Further loss within the down interval waits for the last step to take effect.
+    assert not controller.on_feedback(ClientFeedback(lost_frames=5, rtt_ms=40), now=2.5)
+
+    assert not controller.on_feedback(ClientFeedback(lost_frames=5, rtt_ms=40), now=5.0)
+    assert controller.on_feedback(ClientFeedback(lost_frames=5, rtt_ms=40), now=6.6)
+    assert controller.rung == DEFAULT_LADDER[0]
+
+
+def test_rising_rtt_counts_as_congestion_and_failed_probes_back_off():
+    controller = CongestionController(AdaptiveBitrateConfig(rtt_slack_ms=50, probe_interval_s=2.0), now=0.0)
+
+    controller.on_feedback(ClientFeedback(rtt_ms=30), now=1.0)
+    for second in range(2, 8):
+        controller.on_feedback(ClientFeedback(rtt_ms=400), now=float(second))
+    assert controller.index > 0
+
+    index = controller.index
+    controller.on_feedback(ClientFeedback(rtt_ms=30), now=20.0)  # smoothed RTT still high
+    for second in range(21, 60):
+        controller.on_feedback(ClientFeedback(rtt_ms=30), now=float(second))
+        if controller.index < index:
+            break
+    assert controller.index == index - 1
+    probe_time = float(second)
+    assert controller.on_feedback(ClientFeedback(underruns=1), now=probe_time + 1.5)
+
+    # The failed probe doubled the wait before the next one.
+    assert not controller.on_feedback(ClientFeedback(underruns=1), now=probe_time + 5.0)
+
+
+def test_encoder_resamples_across_chunks_and_encodes_mulaw():
+    encoder = AudioEncoder(24000)
+    encoder.configure(DEFAULT_LADDER[3])  # mu-law at 8 kHz
+    tone = (np.sin(np.arange(2400) * 2 * np.pi / 48) * 8000).astype("<i2")
+
+    encoded = b"".join(encoder.encode(tone[i : i + 333].tobytes()) for i in range(0, tone.size, 333))
+
+    assert abs(len(encoded) - 800) <= 1
+    assert mulaw_encode(np.array([0, 32767, -32768], dtype=np.int16)) == bytes([0xFF, 0x80, 0x00])
+
+
+def test_pcm16_at_the_source_rate_passes_through():
+    encoder = AudioEncoder(24000)
+    encoder.configure(DEFAULT_LADDER[0])
+    chunk = bytes(range(16))
+
+    assert bytes(encoder.encode(chunk)) == chunk
+
+
+def test_retune_flushes_the_old_format_before_switching():
+    packetizer = AudioPacketizer(PacketizerSettings(10, 10, True), 1000)
+    packetizer.push(bytes(6), now=0.0)
+
+    flushed = packetizer.retune(500, CODEC_MULAW, 20)
+    frames = packetizer.push(bytes(10), now=0.0)
+
+    assert FRAME_HEADER.unpack_from(flushed[0])[2:] == (0, 0, 1000, 3)
+    assert FRAME_HEADER.unpack_from(frames[0])[2:] == (CODEC_MULAW, 1, 500, 10)
@@ -0,0 +1,61 @@
+import asyncio
+import sys
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
+
+from Utils.admission import AdmissionConfig, AdmissionController
+
+
+class Clock:
+    def __init__(self):
+        self.now = 100.0
+
+    def __call__(self):
+        return self.now
+
+
+def test_estimates_follow_running_and_queued_turns_and_reject_long_waits():
+    clock = Clock()
+    controller = AdmissionController(
+        AdmissionConfig(max_concurrent_turns=2, max_queue=3, max_wait_s=5.0, initial_turn_s=2.0), clock=clock
+    )
+
+    async def _run():
+        first, second = controller.try_admit(), controller.try_admit()
+        assert first.estimated_start_s == second.estimated_start_s == 0.0
+        async with controller.turn(first.ticket), controller.turn(second.ticket):
+            clock.now += 0.5
+            waiting = [controller.try_admit() for _ in range(3)]
+            rejected = controller.try_admit()
+            clock.now += 1.0
+        return waiting, rejected
+
+    waiting, rejected = asyncio.run(_run())
+
+    # Slots free 1.5 s from now; the third queued turn waits one more average turn.
+    assert [decision.estimated_start_s for decision in waiting] == [1.5, 1.5, 3.5]
+    assert [decision.queue_position for decision in waiting] == [0, 1, 2]
+    assert not rejected.admitted and rejected.reason == "queue full"
+    assert rejected.ticket is None
+    # Both turns took 1.5 s: 2.0 -> 1.85 -> 1.745 with alpha 0.3.
+    assert abs(controller.turn_seconds - 1.745) < 1e-9
+
+
+def test_turns_beyond_capacity_wait_in_arrival_order():
+    controller = AdmissionController(AdmissionConfig(max_concurrent_turns=1))
+    order = []
+
+    async def _turn(name, ticket):
+        async with controller.turn(ticket):
+            order.append(name)
+            await asyncio.sleep(0)
+
+    async def _run():
+        tickets = [controller.try_admit().ticket for _ in range(3)]
+        await asyncio.gather(*(_turn(name, ticket) for name, ticket in zip("abc", tickets)))
+
+    asyncio.run(_run())
+
+    assert order == ["a", "b", "c"]
+    assert controller.running == controller.queued == 0
@@ -0,0 +1,28 @@
+import sys
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
+
+from scripts.benchmark_suite import bench_broadcast, compare_to_baselines
+
+
+def test_compare_flags_regressions_in_either_direction():
+    baselines = {
+        "latency_ms": {"value": 100.0, "higher_is_better": False, "tolerance": 0.25},
+        "throughput_per_s": {"value": 1000.0, "higher_is_better": True, "tolerance": 0.25},
+    }
+    assert compare_to_baselines({"latency_ms": 120.0, "throughput_per_s": 800.0}, baselines) == []
+
+    regressions = compare_to_baselines({"latency_ms": 130.0, "throughput_per_s": 700.0}, baselines)
+    assert sorted(regression.metric for regression in regressions) == ["latency_ms", "throughput_per_s"]
+
+
+def test_compare_applies_absolute_slack_and_ignores_unknown_metrics():
+    baselines = {"decode_ms": {"value": 0.5, "higher_is_better": False, "tolerance": 0.25, "slack": 2.0}}
+    assert compare_to_baselines({"decode_ms": 2.0, "new_metric_ms": 50.0}, baselines) == []
+    assert [r.metric for r in compare_to_baselines({"decode_ms": 3.0}, baselines)] == ["decode_ms"]
+
+
+def test_broadcast_benchmark_delivers_to_every_client():
+    results = bench_broadcast(clients=3, frames=12)
+    assert results["broadcast_deliveries_per_s"] > 0
@@ -0,0 +1,69 @@
+import sys
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
+
+from LLM.constrained import CLOSE, DONE, INITIAL_STATE, TEXT, EmotionReplyGrammar
+from LLM.engine import LLMEngine
+
+EOS = 0
+VOCAB = ["<eos>", '{"', "emotion", '":', ' "', "Happy", "Sad", "Ang", "ry", '",', "text",
+         "Hi", " there", '!"', "}", '"}', "Sure!", "\\n", "\n"]
+
+
+def _grammar():
+    return EmotionReplyGrammar(["Happy", "Sad", "Angry"], VOCAB, eos_token_ids=[EOS])
+
+
+def _ids(*pieces):
+    return [VOCAB.index(piece) for piece in pieces]
+
+
+def test_head_only_allows_the_json_prefix():
+    grammar = _grammar()
+
+    allowed = grammar.allowed_token_ids(INITIAL_STATE)
+
+    assert [VOCAB[token_id] for token_id in allowed] == ['{"']
+
+
+def test_emotion_is_restricted_to_known_labels():
+    grammar = _grammar()
+    state = grammar.advance_tokens(INITIAL_STATE, _ids('{"', "emotion", '":', ' "'))
+
+    allowed = {VOCAB[token_id] for token_id in grammar.allowed_token_ids(state)}
+
+    assert allowed == {"Happy", "Sad", "Ang"}
+
+
+def test_full_reply_walks_through_every_phase():
+    grammar = _grammar()
+    head = _ids('{"', "emotion", '":', ' "', "Ang", "ry", '",', ' "', "text", '":', ' "')
+
+    state = grammar.advance_tokens(INITIAL_STATE, head)
+    assert state[0] == TEXT
+    state = grammar.advance_tokens(state, _ids("Hi", " there", '!"'))
+    assert state[0] == CLOSE
+    assert {VOCAB[i] for i in grammar.allowed_token_ids(state)} == {"}", "\n"}
+    state = grammar.advance_tokens(state, _ids("}"))
+    assert state[0] == DONE
+    assert grammar.allowed_token_ids(state) == [EOS]
+    assert grammar.advance_tokens(state, [EOS]) == state
+
+
+def test_text_rejects_escapes_and_control_characters():
+    grammar = _grammar()
+
+    allowed = {VOCAB[token_id] for token_id in grammar.allowed_token_ids((TEXT, ""))}
+
+    assert {"Hi", '!"', '"}', "Sure!"} <= allowed
+    assert "\\n" not in allowed and "\n" not in allowed
+    assert "<eos>" not in allowed
+
+
+def test_truncated_reply_is_recovered():
+    engine = LLMEngine.__new__(LLMEngine)
+
+    result = engine._parse_json_output('{"emotion": "Happy", "text": "Hello the')
+
+    assert result == {"emotion": "Happy", "text": "Hello the"}
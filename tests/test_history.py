@@ -0,0 +1,70 @@
+import asyncio
+import sys
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
+
+from Utils.history import ChatHistoryManager, HistoryConfig
+
+
+def _words(text):
+    return len(text.split())
+
+
+def _manager(**overrides):
+    config = HistoryConfig(**{"max_history_tokens": 20, "keep_recent_turns": 2, "summary_max_tokens": 4, **overrides})
+    return ChatHistoryManager(config, count_tokens=_words)
+
+
+def test_prompt_context_keeps_newest_turns_within_budget():
+    history = _manager()
+    for index in range(6):
+        history.append(f"question {index} here", f"answer {index} here")
+
+    turns, summary = history.prompt_context()
+
+    assert summary is None
+    assert [turn["user"] for turn in turns] == ["question 3 here", "question 4 here", "question 5 here"]
+
+
+def test_fold_summarises_all_but_recent_turns_in_background():
+    history = _manager()
+    calls = []
+
+    async def summarize(previous, turns):
+        calls.append((previous, [turn["user"] for turn in turns]))
+        return "they talked"
+
+    async def _run():
+        for index in range(4):
+            history.append(f"question {index} here", f"answer {index} here")
+        task = history.maybe_fold(summarize)
+        # A turn recorded while the fold runs must survive it.
+        history.append("late question", "late answer")
+        assert history.maybe_fold(summarize) is task
+        await history.wait_for_fold()
+
+    asyncio.run(_run())
+
+    assert calls == [("", ["question 0 here", "question 1 here"])]
+    assert [turn["user"] for turn in history.turns] == ["question 2 here", "question 3 here", "late question"]
+    turns, summary = history.prompt_context()
+    assert summary == "they talked"
+    assert len(turns) == 3
+
+
+def test_failed_fold_keeps_verbatim_turns():
+    history = _manager()
+
+    async def summarize(previous, turns):
+        raise RuntimeError("model busy")
+
+    async def _run():
+        for index in range(4):
+            history.append(f"question {index} here", f"answer {index} here")
+        await history.maybe_fold(summarize)
+
+    asyncio.run(_run())
+
+    assert len(history) == 4
+    assert history.summary == ""
@@ -1,7 +1,11 @@
 import asyncio
 import sys
+import threading
+from collections import OrderedDict
+from concurrent.futures import ThreadPoolExecutor
 from pathlib import Path
 from types import SimpleNamespace
+from unittest.mock import MagicMock
 
 import numpy as np
 import pytest
@@ -9,6 +13,8 @@ import pytest
 sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
 
 from TTS.kani_engine import KaniTTSConfig, KaniTTSEngine
+from TTS.kani_tts.audio.pcm import PCMBufferPool, PCMFrame
+from TTS.kani_tts.generation.generator import TTSGenerator
 from TTS.kani_tts.synthesizer import KaniSynthesizer
 
 
@@ -19,11 +25,11 @@ class DummyGenerator:
     def generate(self, text, writer, **kwargs):
         self.captured["generate_text"] = text
         self.captured["generate_kwargs"] = kwargs
-        writer.audio_chunks.append(np.zeros(4, dtype=np.float32))
+        writer.on_chunk(np.zeros(4, dtype=np.float32))
 
 
 class DummyWriter:
-    def __init__(self, player, output_file, *, sample_rate, chunk_size, lookback_frames, captured):
+    def __init__(self, player, output_file, *, sample_rate, chunk_size, lookback_frames, on_chunk, captured):
         captured["writer_sample_rate"] = sample_rate
         captured["writer_chunk_size"] = chunk_size
         captured["writer_lookback"] = lookback_frames
@@ -32,7 +38,7 @@ class DummyWriter:
         self.sample_rate = sample_rate
         self.chunk_size = chunk_size
         self.lookback_frames = lookback_frames
-        self.audio_chunks = []
+        self.on_chunk = on_chunk
         self.started = False
         self.finalized = False
 
@@ -44,12 +50,13 @@ class DummyWriter:
 
 
 def test_engine_stream_forwards_configuration(monkeypatch, tmp_path):
-    config = KaniTTSConfig(model_dir=tmp_path, sample_rate=16000, chunk_size=512, temperature=0.7)
+    config = KaniTTSConfig(model_dir=tmp_path, voice="kari", sample_rate=16000, chunk_size=512, temperature=0.7)
     engine = KaniTTSEngine(config)
 
     class DummySynth:
-        def stream(self, *, text, sample_rate, temperature, chunk_size):
+        def stream(self, *, text, voice, sample_rate, temperature, chunk_size):
             assert text == "hello"
+            assert voice == "kari"
             assert sample_rate == 16000
             assert temperature == 0.7
             assert chunk_size == 512
@@ -77,12 +84,13 @@ def test_synthesizer_stream_accepts_overrides(monkeypatch):
 
     monkeypatch.setattr(
         "TTS.kani_tts.synthesizer.StreamingAudioWriter",
-        lambda player, output_file, *, sample_rate, chunk_size, lookback_frames: DummyWriter(
+        lambda player, output_file, *, sample_rate, chunk_size, lookback_frames, on_chunk: DummyWriter(
             player,
             output_file,
             sample_rate=sample_rate,
             chunk_size=chunk_size,
             lookback_frames=lookback_frames,
+            on_chunk=on_chunk,
             captured=captured,
         ),
     )
@@ -96,13 +104,269 @@ def test_synthesizer_stream_accepts_overrides(monkeypatch):
     )
 
     chunk = next(stream)
-    assert isinstance(chunk, bytes)
+    assert isinstance(chunk, PCMFrame)
+    assert bytes(chunk.view) == b"\x00" * 8
 
     with pytest.raises(StopIteration):
         next(stream)
 
     assert captured["generate_text"] == "hello"
     assert captured["generate_kwargs"]["temperature"] == 0.5
+    assert captured["generate_kwargs"]["voice"] == "kari"
     assert captured["writer_sample_rate"] == 16000
     assert captured["writer_chunk_size"] == 256
     assert captured["writer_lookback"] == 2
+
+
+def test_pcm_pool_converts_once_and_recycles_buffers():
+    pool = PCMBufferPool()
+    audio = np.array([-2.0, -1.0, 0.0, 0.5, 2.0], dtype=np.float32)
+
+    frame = pool.convert(audio)
+    assert frame.samples.tolist() == [-32767, -32767, 0, 16383, 32767]
+    assert len(frame) == 10
+    assert frame.view.nbytes == 10
+
+    buffer = frame.samples.base
+    frame.retain()
+    frame.release()
+    assert pool.acquire(5).samples.base is not buffer
+
+    frame.release()
+    assert pool.acquire(3).samples.base is buffer
+
+
+def test_batched_decoder_decodes_concurrent_chunks_in_one_pass():
+    from concurrent.futures import ThreadPoolExecutor
+
+    from TTS.kani_tts.audio.batching import BatchedCodecDecoder
+
+    class BatchPlayer:
+        start_of_speech = 7
+        batches = []
+
+        def decode_audio_batch(self, batch):
+            self.batches.append(len(batch))
+            return [np.full(len(codes), codes[0][0], dtype=np.float32) for codes in batch]
+
+    player = BatchPlayer()
+    decoder = BatchedCodecDecoder(player, max_wait_ms=1000.0, max_batch=8)
+    assert decoder.start_of_speech == 7
+
+    for _ in range(3):
+        decoder.open_stream()
+    with ThreadPoolExecutor(max_workers=3) as pool:
+        futures = [pool.submit(decoder.decode_audio_chunk, np.full((index + 1, 4), index)) for index in range(3)]
+        results = [future.result(timeout=5) for future in futures]
+
+    assert player.batches == [3]
+    assert [result.tolist() for result in results] == [[0.0], [1.0, 1.0], [2.0, 2.0, 2.0]]
+
+    # A stream on its own is decoded at once rather than after max_wait_ms.
+    for _ in range(2):
+        decoder.close_stream()
+    assert decoder.decode_audio_chunk(np.full((1, 4), 5)).tolist() == [5.0]
+    assert player.batches == [3, 1]
+
+
+def test_token_streamer_hands_over_frames_and_flushes_speech_markers():
+    from TTS.kani_tts import config as kani_config
+    from TTS.kani_tts.generation.generator import TokenIDStreamer
+
+    batches = []
+    streamer = TokenIDStreamer(batches.append)
+    streamer.put(np.array([[1, 2]]))
+    streamer.put(np.array([kani_config.START_OF_SPEECH]))
+    for token in range(10, 16):
+        streamer.put(np.array([token]))
+    streamer.end()
+
+    assert batches == [[1, 2, kani_config.START_OF_SPEECH], [10, 11, 12, 13], [14, 15]]
+
+
+def test_seeded_streams_skip_the_batched_decoder():
+    from TTS.kani_tts import config as kani_config
+
+    class PaddingPlayer:
+        start_of_speech = kani_config.START_OF_SPEECH
+        end_of_speech = kani_config.END_OF_SPEECH
+
+        def __init__(self):
+            self.batches = []
+
+        def decode_audio_chunk(self, codes):
+            return np.repeat(codes[:, 0].astype(np.float32), 2) / 100.0
+
+        def decode_audio_batch(self, batch):
+            self.batches.append(len(batch))
+            # Like the real codec, a padded pass differs slightly from decoding alone.
+            return [self.decode_audio_chunk(codes) + 0.01 for codes in batch]
+
+    class CodeGenerator:
+        def generate(self, text, writer, **kwargs):
+            writer.add_tokens([kani_config.START_OF_SPEECH])
+            for frame in range(6):
+                writer.add_tokens([len(text) + frame] * 4)
+            writer.add_tokens([kani_config.END_OF_SPEECH, kani_config.END_OF_SPEECH])
+
+    def _synth(decode_batch_wait_ms):
+        synth = KaniSynthesizer(chunk_size=4, lookback_frames=1, decode_batch_wait_ms=decode_batch_wait_ms)
+        synth._player = PaddingPlayer()
+        synth._generator = CodeGenerator()
+        synth.load = lambda: None
+        return synth
+
+    def _pcm(synth, text, seed):
+        return b"".join(bytes(chunk.view) for chunk in synth.stream(text, seed=seed))
+
+    alone = _pcm(_synth(None), "seeded", seed=3)
+
+    batched = _synth(50.0)
+    with ThreadPoolExecutor(max_workers=2) as pool:
+        seeded = pool.submit(_pcm, batched, "seeded", 3)
+        unseeded = pool.submit(_pcm, batched, "other", None)
+        assert seeded.result(timeout=5) == alone
+        unseeded.result(timeout=5)
+    assert batched._player.batches
+
+
+def test_writer_decodes_each_frame_once_with_lookback():
+    from TTS.kani_tts import config as kani_config
+    from TTS.kani_tts.audio.streaming import StreamingAudioWriter
+
+    class FramePlayer:
+        start_of_speech = kani_config.START_OF_SPEECH
+        end_of_speech = kani_config.END_OF_SPEECH
+
+        def decode_audio_chunk(self, codes):
+            # Two samples per frame carrying the frame number.
+            return np.repeat(codes[:, 0].astype(np.float32), 2)
+
+    delivered = []
+    writer = StreamingAudioWriter(FramePlayer(), None, chunk_size=3, lookback_frames=2, on_chunk=delivered.append)
+    writer.start()
+    writer.add_tokens([kani_config.START_OF_SPEECH])
+    for frame in range(8):
+        writer.add_tokens([frame] * 4)
+    writer.add_tokens([kani_config.END_OF_SPEECH, kani_config.END_OF_SPEECH])
+    full = writer.finalize()
+
+    assert [len(chunk) for chunk in delivered] == [6, 6, 4]
+    assert full.tolist() == np.repeat(np.arange(8, dtype=np.float32), 2).tolist()
+
+
+def test_engine_streams_sentences_concurrently_in_order(tmp_path):
+    config = KaniTTSConfig(model_dir=tmp_path, sample_rate=1000, parallel_sentences=3, sentence_join_ms=4.0)
+    engine = KaniTTSEngine(config)
+    pool = PCMBufferPool()
+    started = []
+
+    class SentenceSynth:
+        async def astream(self, *, text, voice, sample_rate, temperature, chunk_size, seed=None):
+            started.append(text)
+            # Later sentences finish first; the engine must still keep text order.
+            await asyncio.sleep(0.03 if text.startswith("First") else 0.0)
+            for value in (100, 200):
+                frame = pool.acquire(8)
+                frame.samples[:] = value if text.startswith("First") else -value
+                yield frame
+
+    engine._synth = SentenceSynth()
+
+    async def _collect():
+        return [chunk async for chunk in engine.synthesize_stream("First sentence goes here. Second sentence comes next.")]
+
+    chunks = asyncio.run(_collect())
+
+    assert started == ["First sentence goes here.", "Second sentence comes next."]
+    samples = [chunk.samples.tolist() for chunk in chunks]
+    assert samples[0] == [100] * 8 and samples[1] == [200] * 8
+    # A ramp from the last sample down to silence, then the faded-in second sentence.
+    assert samples[2] == [200, 150, 100, 50]
+    assert samples[3][:4] == [0, -25, -50, -75] and samples[3][4:] == [-100] * 4
+    assert samples[4] == [-200] * 8
+
+
+def test_engine_cache_shares_generations_in_flight_and_replays_repeats(tmp_path):
+    config = KaniTTSConfig(model_dir=tmp_path, sample_rate=1000, parallel_sentences=1)
+    engine = KaniTTSEngine(config)
+    pool = PCMBufferPool()
+    generated = []
+
+    class CountingSynth:
+        async def astream(self, *, text, voice, sample_rate, temperature, chunk_size, seed=None):
+            generated.append((text, seed))
+            for value in (1, 2, 3):
+                await asyncio.sleep(0.005)
+                frame = pool.acquire(4)
+                frame.samples[:] = value
+                yield frame
+
+    engine._synth = CountingSynth()
+
+    async def _collect(text, seed=None):
+        return [chunk.samples.tolist() for chunk in [c async for c in engine.synthesize_stream(text, seed=seed)]]
+
+    async def _run():
+        first, second = await asyncio.gather(_collect("Halt!"), _collect("Halt!"))
+        return first, second, await _collect("Halt!"), await _collect("Halt!", seed=5)
+
+    first, joined, replayed, reseeded = asyncio.run(_run())
+
+    assert first == joined == replayed == reseeded == [[1] * 4, [2] * 4, [3] * 4]
+    assert generated == [("Halt!", None), ("Halt!", 5)]
+    assert (engine.cache.misses, engine.cache.joins, engine.cache.hits) == (2, 1, 1)
+    assert engine.cache.size_bytes == 2 * 3 * 8
+
+
+class RecordingTokenizer:
+    def __init__(self):
+        self.calls = []
+
+    def __call__(self, text, **kwargs):
+        self.calls.append((text, kwargs))
+        return SimpleNamespace(input_ids=MagicMock(name="ids"))
+
+    def decode(self, token_ids, **kwargs):
+        return ""
+
+
+def _bare_generator(voice_prompt_format, max_voice_prefixes=16):
+    generator = TTSGenerator.__new__(TTSGenerator)
+    generator.voice_prompt_format = voice_prompt_format
+    generator.cache_voice_prefix = False
+    generator.max_voice_prefixes = max_voice_prefixes
+    generator._voice_prefixes = OrderedDict()
+    generator._voice_lock = threading.Lock()
+    generator.tokenizer = RecordingTokenizer()
+    generator.device = "cpu"
+    return generator
+
+
+def test_default_prompt_format_keeps_the_plain_prompt():
+    generator = _bare_generator("{text}")
+    generator.prepare_input("Hello there.", voice="kari")
+
+    assert generator.tokenizer.calls == [("Hello there.", {"return_tensors": "pt"})]
+    assert not generator._voice_prefixes
+
+
+def test_default_prompt_format_generates_without_a_voice_prefix():
+    generator = _bare_generator("{text}")
+    generator.cache_voice_prefix = True
+    generator.model = MagicMock()
+    writer = SimpleNamespace(add_tokens=lambda token_ids: None)
+
+    generator.generate("Hello there.", writer, voice="kari")
+
+    generator.model.assert_not_called()
+    assert "past_key_values" not in generator.model.generate.call_args.kwargs
+    assert not generator._voice_prefixes
+
+
+def test_voice_prefixes_keep_only_the_most_recently_used_voices():
+    generator = _bare_generator("{voice}: {text}", max_voice_prefixes=2)
+    for voice in ("kari", "leo", "kari", "nova"):
+        generator.voice_prefix(voice)
+
+    assert list(generator._voice_prefixes) == ["kari", "nova"]
@@ -0,0 +1,59 @@
+import sys
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
+
+from LLM.engine import LLMConfig, LLMEngine
+
+
+def test_generation_kwargs_without_draft_model():
+    engine = LLMEngine(LLMConfig(model_name_or_path="dummy", max_new_tokens=32))
+
+    kwargs = engine._generation_kwargs({"input_ids": [[1, 2, 3]]})
+
+    assert kwargs["input_ids"] == [[1, 2, 3]]
+    assert kwargs["max_new_tokens"] == 32
+    assert "assistant_model" not in kwargs
+    assert not engine.is_speculative
+
+
+def test_generation_kwargs_use_draft_model_when_loaded():
+    engine = LLMEngine(LLMConfig(model_name_or_path="dummy", draft_model_name_or_path="draft"))
+    draft = object()
+    engine._draft_model = draft
+
+    kwargs = engine._generation_kwargs({"input_ids": [[1]]}, streamer="streamer")
+
+    assert kwargs["assistant_model"] is draft
+    assert kwargs["streamer"] == "streamer"
+    assert engine.is_speculative
+
+
+def test_cpu_device_loads_float32_and_quantizes_int8(monkeypatch):
+    import LLM.engine as engine_module
+
+    calls = {}
+    model = type("Model", (), {"eval": lambda self: None})()
+
+    def fake_from_pretrained(path, **kwargs):
+        calls.update(kwargs)
+        return model
+
+    monkeypatch.setattr(engine_module.AutoModelForCausalLM, "from_pretrained", fake_from_pretrained)
+    monkeypatch.setattr(engine_module, "quantize_dynamic_int8", lambda m: ("quantized", m))
+    engine = LLMEngine(LLMConfig(model_name_or_path="dummy", device="cpu", quantization="int8"))
+
+    loaded = engine._load_causal_lm("dummy")
+
+    assert calls["device_map"] == {"": "cpu"}
+    assert calls["torch_dtype"] is engine_module.torch.float32
+    assert loaded == ("quantized", model)
+
+
+def test_greedy_decoding_drops_sampling_parameters():
+    engine = LLMEngine(LLMConfig(model_name_or_path="dummy", do_sample=False))
+
+    kwargs = engine._generation_kwargs({"input_ids": [[1]]})
+
+    assert kwargs["do_sample"] is False
+    assert kwargs["temperature"] is None and kwargs["top_p"] is None
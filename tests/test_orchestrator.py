@@ -0,0 +1,163 @@
+import asyncio
+import sys
+import threading
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
+
+from LLM.engine import LLMConfig
+from TTS.kani_engine import KaniTTSConfig
+from Utils.determinism import DeterminismConfig, utterance_seed
+from Utils.orchestrator import OrchestratorConfig, VoiceAgentOrchestrator
+
+
+class FakeLLM:
+    def __init__(self):
+        self.histories = []
+        self.barrier = threading.Barrier(2, timeout=2)
+
+    def generate(self, user_message, chat_history=None, summary=None):
+        self.histories.append(list(chat_history or []))
+        # Both sessions must be inside generate() at once to pass the barrier.
+        self.barrier.wait()
+        return {"emotion": "Happy", "text": f"re: {user_message}"}
+
+    def count_tokens(self, text):
+        return len(text.split())
+
+
+class FakeTTS:
+    def __init__(self):
+        self.voices = []
+
+    async def synthesize_stream(self, text, voice=None):
+        self.voices.append(voice)
+        yield text.encode("utf-8")
+
+
+def _orchestrator(tmp_path):
+    config = OrchestratorConfig(
+        llm=LLMConfig(model_name_or_path="dummy"),
+        tts=KaniTTSConfig(model_dir=tmp_path),
+    )
+    orchestrator = VoiceAgentOrchestrator(config)
+    orchestrator.llm = FakeLLM()
+    orchestrator.tts = FakeTTS()
+    return orchestrator
+
+
+def test_sessions_run_concurrently_and_route_to_their_agent(tmp_path):
+    orchestrator = _orchestrator(tmp_path)
+    server = orchestrator.stream_server
+
+    async def _run():
+        guard_audio = await server.audio_channel("guard").register()
+        merchant_audio = await server.audio_channel("merchant").register()
+        await asyncio.gather(
+            orchestrator.process_text("halt", session_id="a", agent_id="guard"),
+            orchestrator.process_text("wares", session_id="b", agent_id="merchant"),
+        )
+        return guard_audio.get_nowait(), merchant_audio.get_nowait(), merchant_audio.qsize()
+
+    guard_chunk, merchant_chunk, merchant_left = asyncio.run(_run())
+
+    assert guard_chunk == b"re: halt"
+    assert merchant_chunk == b"re: wares"
+    assert merchant_left == 0
+    assert orchestrator.sessions.get("a").history.turns == [{"user": "halt", "assistant": "re: halt"}]
+    assert orchestrator.sessions.get("b").agent_id == "merchant"
+
+
+def test_session_history_is_passed_to_following_turns(tmp_path):
+    orchestrator = _orchestrator(tmp_path)
+    orchestrator.llm.barrier = threading.Barrier(1)
+
+    async def _run():
+        await orchestrator.process_text("one", session_id="s")
+        await orchestrator.process_text("two", session_id="s")
+
+    asyncio.run(_run())
+
+    assert orchestrator.llm.histories == [[], [{"user": "one", "assistant": "re: one"}]]
+
+
+def test_voice_comes_from_session_then_agent(tmp_path):
+    orchestrator = _orchestrator(tmp_path)
+    orchestrator.config.agent_voices = {"guard": "leo"}
+    orchestrator.llm.barrier = threading.Barrier(1)
+
+    async def _run():
+        await orchestrator.process_text("halt", session_id="a", agent_id="guard")
+        await orchestrator.process_text("hi", session_id="b", agent_id="merchant")
+        await orchestrator.process_text("psst", session_id="a", voice="kari")
+        await orchestrator.process_text("again", session_id="a")
+
+    asyncio.run(_run())
+
+    assert orchestrator.tts.voices == ["leo", None, "kari", "kari"]
+
+
+def test_deterministic_mode_seeds_tts_per_utterance_and_uses_canned_replies(tmp_path):
+    replies = tmp_path / "replies.json"
+    replies.write_text('{"hi": {"emotion": "Happy", "text": "hello"}, "*": ["first", "second"]}', encoding="utf-8")
+    config = OrchestratorConfig(
+        llm=LLMConfig(model_name_or_path="dummy"),
+        tts=KaniTTSConfig(model_dir=tmp_path),
+        determinism=DeterminismConfig(enabled=True, seed=7, canned_replies=str(replies)),
+    )
+    orchestrator = VoiceAgentOrchestrator(config)
+    assert orchestrator.tts.config.decode_batch_wait_ms is None
+    assert config.tts.decode_batch_wait_ms == 5.0
+    seeds = []
+
+    class SeededTTS:
+        async def synthesize_stream(self, text, voice=None, seed=None):
+            seeds.append(seed)
+            yield text.encode("utf-8")
+
+    orchestrator.tts = SeededTTS()
+    orchestrator.llm.load()
+
+    async def _run():
+        first = await orchestrator.process_text("hi", session_id="a")
+        other = await orchestrator.process_text("anything else", session_id="b")
+        again = await orchestrator.process_text("hi", session_id="c")
+        return first, other, again
+
+    first, other, again = asyncio.run(_run())
+
+    assert first == again == {"emotion": "Happy", "text": "hello"}
+    assert other["text"] in {"first", "second"}
+    assert seeds[0] == seeds[2] == utterance_seed(7, "", "hello")
+    assert seeds[1] != seeds[0]
+
+
+def test_control_turns_get_an_admission_answer_or_a_rejection(tmp_path):
+    orchestrator = _orchestrator(tmp_path)
+    orchestrator.llm.barrier = threading.Barrier(1)
+    orchestrator.admission.config.max_concurrent_turns = 1
+    orchestrator.admission.config.max_wait_s = 1.0
+    sent = []
+
+    async def _send_control(client_id, payload):
+        sent.append(payload)
+        return True
+
+    orchestrator.stream_server.send_control = _send_control
+
+    async def _run():
+        busy = orchestrator.admission.admit()
+        async with orchestrator.admission.turn(busy):
+            await orchestrator._handle_turn_message("ue", {"type": "turn", "text": "hi", "turn_id": 1})
+        await orchestrator._handle_turn_message("ue", {"type": "turn", "text": "hi", "turn_id": 2})
+
+    asyncio.run(_run())
+
+    rejected, rejected_result, admitted, result = sent
+    assert rejected["type"] == "admission" and not rejected["admitted"]
+    assert rejected["reason"] == "busy" and 2900 < rejected["estimated_start_ms"] <= 3000
+    assert rejected_result == {
+        "type": "turn_result", "session_id": "ue", "agent_id": "default", "turn_id": 1, "error": "rejected: busy"
+    }
+    assert admitted["admitted"] and admitted["turn_id"] == 2 and admitted["estimated_start_ms"] == 0
+    assert result["text"] == "re: hi"
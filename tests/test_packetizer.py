@@ -0,0 +1,75 @@
+import sys
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
+
+from Server.packetizer import CODEC_PCM16, CODEC_SILENCE, FRAME_HEADER, FRAME_MAGIC, AudioPacketizer, PacketizerSettings
+
+SAMPLE_RATE = 1000  # 10 ms frames are 10 samples / 20 bytes
+
+
+def _packetizer(framed=False, frame_ms=10, max_latency_ms=15):
+    return AudioPacketizer(PacketizerSettings(frame_ms, max_latency_ms, framed), SAMPLE_RATE)
+
+
+def test_legacy_clients_do_not_negotiate():
+    assert PacketizerSettings.from_query({"agent_id": "guard"}) is None
+
+    settings = PacketizerSettings.from_query({"frame_ms": "1", "framing": "nv1"})
+
+    assert settings.frame_ms == 5
+    assert settings.max_latency_ms == 5
+    assert settings.framed
+
+
+def test_small_chunks_are_coalesced_and_large_ones_split():
+    packetizer = _packetizer()
+
+    assert packetizer.push(bytes(range(8)), now=0.0) == []
+    frames = packetizer.push(bytes(range(8, 60)), now=0.001)
+
+    assert [bytes(frame) for frame in frames] == [bytes(range(0, 20)), bytes(range(20, 40)), bytes(range(40, 60))]
+    assert packetizer.time_until_flush(0.002) is None
+
+
+def test_partial_frame_is_flushed_after_the_latency_cap():
+    packetizer = _packetizer()
+
+    packetizer.push(b"\x01\x00" * 3, now=1.0)
+
+    assert abs(packetizer.time_until_flush(1.005) - 0.010) < 1e-9
+    assert packetizer.time_until_flush(2.0) == 0.0
+    assert [bytes(frame) for frame in packetizer.flush()] == [b"\x01\x00" * 3]
+    assert packetizer.flush() == []
+
+
+def test_framed_packets_carry_sequence_and_sample_count():
+    packetizer = _packetizer(framed=True)
+
+    frames = packetizer.push(bytes(40), now=0.0) + packetizer.push(bytes(4), now=0.0) + packetizer.flush()
+
+    headers = [FRAME_HEADER.unpack_from(frame) for frame in frames]
+    assert [header[0] for header in headers] == [FRAME_MAGIC] * 3
+    assert [header[3] for header in headers] == [0, 1, 2]
+    assert [header[4] for header in headers] == [SAMPLE_RATE] * 3
+    assert [header[5] for header in headers] == [10, 10, 2]
+    assert len(frames[0]) == FRAME_HEADER.size + 20
+
+
+def test_dtx_sends_silent_runs_as_header_only_markers():
+    settings = PacketizerSettings.from_query({"frame_ms": "10", "dtx": "1"}, silence_threshold=4)
+    packetizer = AudioPacketizer(settings, SAMPLE_RATE)
+    quiet = b"\x03\x00\xfd\xff" * 5
+    speech = b"\x00\x10" * 10
+
+    frames = packetizer.push(quiet * 3 + speech + quiet, now=0.0)
+
+    headers = [FRAME_HEADER.unpack_from(frame) for frame in frames]
+    assert settings.framed
+    assert [(header[2], header[3], header[5]) for header in headers] == [
+        (CODEC_SILENCE, 0, 30),
+        (CODEC_PCM16, 1, 10),
+        (CODEC_SILENCE, 2, 10),
+    ]
+    assert [len(frame) for frame in frames] == [FRAME_HEADER.size, FRAME_HEADER.size + 20, FRAME_HEADER.size]
+    assert PacketizerSettings.from_query({"dtx": "1"}).silence_threshold is None
@@ -0,0 +1,48 @@
+import asyncio
+import sys
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
+
+from Utils.sessions import SessionManager
+
+
+class FakeClock:
+    def __init__(self):
+        self.now = 0.0
+
+    def __call__(self):
+        return self.now
+
+
+def test_idle_sessions_expire_unless_a_turn_holds_them():
+    clock = FakeClock()
+    sessions = SessionManager(idle_timeout_s=60.0, clock=clock)
+    sessions.get_or_create("quiet")
+    busy = sessions.get_or_create("busy")
+
+    async def _run():
+        async with busy.lock:
+            clock.now = 61.0
+            sessions.get_or_create("fresh")
+
+    asyncio.run(_run())
+
+    assert sessions.get("quiet") is None
+    assert sessions.get("busy") is busy
+    assert sessions.get("fresh") is not None
+
+    clock.now = 100.0
+    sessions.get_or_create("busy")
+    clock.now = 150.0
+    assert sessions.expire_idle() == 1
+    assert sessions.get("busy") is not None and sessions.get("fresh") is None
+
+
+def test_sessions_are_kept_without_an_idle_timeout():
+    clock = FakeClock()
+    sessions = SessionManager(clock=clock)
+    sessions.get_or_create("a")
+    clock.now = 1e9
+    assert sessions.expire_idle() == 0
+    assert len(sessions) == 1
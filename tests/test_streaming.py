@@ -0,0 +1,177 @@
+import asyncio
+import json
+import sys
+import threading
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[1]))
+
+from Server.streaming import BroadcastQueue, StreamConfig, StreamServer
+
+
+def test_broadcast_reaches_listener_on_another_loop():
+    broadcast = BroadcastQueue()
+    registered = threading.Event()
+    received = []
+
+    def _listener() -> None:
+        async def _run() -> None:
+            queue = await broadcast.register()
+            registered.set()
+            received.append(await asyncio.wait_for(queue.get(), timeout=2))
+
+        asyncio.run(_run())
+
+    thread = threading.Thread(target=_listener)
+    thread.start()
+    assert registered.wait(2)
+
+    asyncio.run(broadcast.broadcast(b"chunk"))
+    thread.join(2)
+
+    assert received == [b"chunk"]
+
+
+def test_flush_waits_for_listeners_on_another_loop_to_send():
+    broadcast = BroadcastQueue()
+    registered = threading.Event()
+    release = threading.Event()
+    sent = []
+
+    def _listener() -> None:
+        async def _run() -> None:
+            queue = await broadcast.register()
+            registered.set()
+            payload = await asyncio.wait_for(queue.get(), timeout=2)
+            await asyncio.to_thread(release.wait, 2)
+            sent.append(payload)
+            queue.task_done()
+
+        asyncio.run(_run())
+
+    thread = threading.Thread(target=_listener)
+    thread.start()
+    assert registered.wait(2)
+
+    async def _run():
+        await broadcast.broadcast(b"offline")
+        stalled = await broadcast.flush(timeout=0.05)
+        release.set()
+        return stalled, await broadcast.flush(timeout=2)
+
+    assert asyncio.run(_run()) == (False, True)
+    thread.join(2)
+    assert sent == [b"offline"]
+
+
+def test_broadcast_drops_when_listener_is_full():
+    broadcast = BroadcastQueue()
+
+    async def _run():
+        queue = await broadcast.register()
+        for index in range(queue.maxsize + 2):
+            await broadcast.broadcast(bytes([index]))
+        return queue.qsize()
+
+    assert asyncio.run(_run()) == 4
+
+
+class CountingFrame:
+    def __init__(self):
+        self.refs = 1
+        self.view = memoryview(b"pcm")
+
+    def retain(self):
+        self.refs += 1
+
+    def release(self):
+        self.refs -= 1
+
+
+def test_broadcast_retains_frames_per_listener_and_releases_dropped_ones():
+    broadcast = BroadcastQueue()
+
+    async def _run():
+        first = await broadcast.register()
+        second = await broadcast.register()
+        for _ in range(second.maxsize):
+            second.put_nowait(b"filler")
+        frame = CountingFrame()
+        await broadcast.broadcast(frame)
+        assert frame.refs == 2
+        BroadcastQueue.drain(first)
+        return frame
+
+    frame = asyncio.run(_run())
+    assert frame.refs == 1
+
+
+def test_set_status_is_broadcast_on_control_channel():
+    server = StreamServer(StreamConfig())
+
+    async def _run():
+        queue = await server.control_broadcast.register()
+        await server.set_status("ready")
+        return json.loads((await queue.get()).decode("utf-8"))
+
+    assert asyncio.run(_run()) == {"type": "status", "state": "ready"}
+    assert server.status["state"] == "ready"
+
+
+def test_unbounded_control_listener_keeps_replies_behind_status_traffic():
+    server = StreamServer(StreamConfig())
+
+    async def _run():
+        queue = await server.control_broadcast.register(maxsize=0)
+        server._control_clients["npc-host"] = queue
+        for _ in range(8):
+            await server.set_status("busy")
+        sent = await server.send_control("npc-host", {"type": "turn_result", "turn_id": 7})
+        messages = []
+        while not queue.empty():
+            messages.append(json.loads(queue.get_nowait().decode("utf-8")))
+        return sent, messages
+
+    sent, messages = asyncio.run(_run())
+    assert sent
+    assert len(messages) == 9
+    assert messages[-1] == {"type": "turn_result", "turn_id": 7}
+
+
+def test_feedback_adapts_the_link_and_pings_are_answered():
+    server = StreamServer(StreamConfig())
+
+    async def _run():
+        queue = await server.control_broadcast.register()
+        server._control_clients["npc-host"] = queue
+        controller = server._acquire_link("npc-host")
+        await server._dispatch_control_message("npc-host", json.dumps({"type": "ping", "t": 12.5}))
+        await server._dispatch_control_message("npc-host", json.dumps({"type": "feedback", "lost_frames": 0}))
+        controller._last_change -= 10
+        await server._dispatch_control_message("npc-host", json.dumps({"type": "feedback", "lost_frames": 4}))
+        messages = []
+        while not queue.empty():
+            messages.append(json.loads(queue.get_nowait().decode("utf-8")))
+        return messages
+
+    pong, bitrate = asyncio.run(_run())
+    assert pong == {"type": "pong", "t": 12.5}
+    assert bitrate["type"] == "bitrate" and bitrate["rung"] == "pcm16-16k"
+
+
+def test_frames_for_agents_without_clients_create_no_channel():
+    server = StreamServer(StreamConfig())
+
+    async def _run():
+        await server.push_audio(b"pcm", agent_id="ghost")
+        await server.push_emotion({"Happy": 1.0}, agent_id="ghost")
+        channel = server.audio_channel("guard")
+        queue = await channel.register()
+        await server.push_audio(b"pcm", agent_id="guard")
+        received = queue.get_nowait()
+        await channel.unregister(queue)
+        StreamServer._release_channel(server._audio_channels, "guard", channel)
+        return received
+
+    assert asyncio.run(_run()) == b"pcm"
+    assert server._audio_channels == {} and server._emotion_channels == {}